@@ -6,6 +6,7 @@
 
 #include <GLRF/Shader.hpp>
 #include <GLRF/Scene.hpp>
+#include <GLRF/StreamingBuffer.hpp>
 
 namespace GLRF {
     class Mouse;
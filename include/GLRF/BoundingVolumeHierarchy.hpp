@@ -0,0 +1,158 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include <GLRF/Bounds.hpp>
+#include <GLRF/Frustum.hpp>
+#include <GLRF/SpatialIndex.hpp>
+
+namespace GLRF {
+	class BoundingVolumeHierarchy;
+}
+
+/**
+ * @brief A spatial index that keeps the boxes in a dynamic tree, the default index of a Scene.
+ *
+ * Every inserted box is a leaf whose node index is its proxy.
+ * Leaves store their boxes enlarged by a margin, so small movements do not change the tree (see update).
+ * Leaves are inserted next to the sibling that increases the surface area of the tree the least (branch and bound),
+ * afterwards the boxes of all ancestors are refitted and each ancestor swaps a child with a grandchild if that
+ * reduces the surface area (tree rotations). build replaces the tree with a top-down binned SAH build.
+ * Queries do not modify the tree, so they can run on several threads at once.
+ */
+class GLRF::BoundingVolumeHierarchy : public SpatialIndex {
+public:
+	static constexpr int32_t NULL_NODE = -1;
+
+	/**
+	 * @brief Construct a new BoundingVolumeHierarchy object.
+	 *
+	 * @param margin the distance that the boxes of leaves are enlarged by in every direction
+	 */
+	BoundingVolumeHierarchy(float margin = 0.1f);
+	~BoundingVolumeHierarchy();
+
+	/**
+	 * @brief Inserts a box.
+	 *
+	 * @return int32_t the proxy of the new leaf
+	 */
+	int32_t insert(const BoundingBox & box);
+
+	void remove(int32_t proxy);
+
+	/**
+	 * @brief Moves a leaf to a new box, it is only inserted again if the box left the enlarged box of the leaf.
+	 *
+	 * @return true if the leaf was inserted again
+	 * @return false if the tree did not change
+	 */
+	bool update(int32_t proxy, const BoundingBox & box);
+
+	/**
+	 * @brief Replaces all leaves by the specified boxes and builds the tree top-down with the surface area heuristic.
+	 *
+	 * @param boxes the boxes of the new leaves
+	 * @param proxies receives the proxy of every box
+	 */
+	void build(const std::vector<BoundingBox> & boxes, std::vector<int32_t> * proxies);
+
+	void clear();
+
+	/**
+	 * @brief Returns the enlarged box of a leaf.
+	 *
+	 */
+	const BoundingBox & getBox(int32_t proxy) const;
+
+	size_t getProxyCount() const;
+
+	/**
+	 * @brief Returns the number of nodes on the longest path from the root to a leaf.
+	 *
+	 */
+	int getHeight() const;
+
+	/**
+	 * @brief Returns the sum of the surface areas of all inner nodes, which is proportional to the expected cost of a query.
+	 *
+	 */
+	float getCost() const;
+
+	/**
+	 * @brief Returns the upper bound of all proxies, e.g. to size arrays that are indexed by proxies.
+	 *
+	 */
+	size_t getProxyCapacity() const;
+
+	/**
+	 * @brief Appends the proxies of all leaves whose boxes intersect the frustum.
+	 *
+	 * Planes that fully contain a node are not tested again for its descendants,
+	 * nodes that are inside of all planes add their leaves without any test.
+	 */
+	void query(const Frustum & frustum, std::vector<int32_t> & proxies) const;
+
+	/**
+	 * @brief Appends the proxies of all leaves whose boxes intersect the sphere.
+	 *
+	 */
+	void query(const BoundingSphere & sphere, std::vector<int32_t> & proxies) const;
+
+	/**
+	 * @brief Appends the proxies of all leaves whose boxes intersect the box.
+	 *
+	 */
+	void query(const BoundingBox & box, std::vector<int32_t> & proxies) const;
+
+	/**
+	 * @brief Appends the proxies of all leaves whose boxes are hit by a ray, in no particular order.
+	 *
+	 * @param origin the origin of the ray
+	 * @param direction the direction of the ray, which does not need to be normalized
+	 * @param max_distance the length of the ray in multiples of the direction
+	 */
+	void raycast(const glm::vec3 & origin, const glm::vec3 & direction, float max_distance, std::vector<int32_t> & proxies) const;
+
+	/**
+	 * @brief Checks the links between all nodes and whether every inner node encloses its children.
+	 *
+	 */
+	bool validate() const;
+private:
+	struct Node {
+		BoundingBox box;
+		int32_t parent = NULL_NODE;
+		int32_t child1 = NULL_NODE;
+		int32_t child2 = NULL_NODE;
+		int32_t next = NULL_NODE;
+		bool allocated = false;
+
+		bool isLeaf() const { return this->child1 == NULL_NODE; }
+	};
+
+	std::vector<Node> nodes;
+	int32_t root = NULL_NODE;
+	int32_t free_list = NULL_NODE;
+	size_t leaf_count = 0;
+	float margin;
+
+	int32_t allocateNode();
+	void freeNode(int32_t index);
+	void insertLeaf(int32_t leaf);
+	void removeLeaf(int32_t leaf);
+	int32_t findBestSibling(const BoundingBox & box);
+	void refit(int32_t index);
+	void rotate(int32_t index);
+	void addLeaves(int32_t index, std::vector<int32_t> & proxies) const;
+	int32_t buildRange(std::vector<int32_t> & leaves, size_t begin, size_t end);
+	int getHeight(int32_t index) const;
+	bool validate(int32_t index) const;
+
+	static float area(const BoundingBox & box);
+	static BoundingBox merge(const BoundingBox & a, const BoundingBox & b);
+	static bool contains(const BoundingBox & outer, const BoundingBox & inner);
+	static bool overlaps(const BoundingBox & a, const BoundingBox & b);
+};
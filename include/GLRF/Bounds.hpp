@@ -0,0 +1,114 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+
+#include <glm/glm.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GLRF_SSE2
+#endif
+
+namespace GLRF {
+	struct BoundingBox;
+	struct BoundingSphere;
+	struct Bounds;
+	template <typename T, typename = void> struct HasPosition;
+
+	/**
+	 * @brief Computes the bounds of positions that are stored with a fixed stride (e.g. the position of a vertex format).
+	 *
+	 * The positions are reduced four at a time with SSE2 if available. The sphere is centered in the box,
+	 * which is not the smallest sphere but is found in a single additional pass.
+	 *
+	 * @param positions the first position
+	 * @param count the number of positions
+	 * @param stride the distance between two positions in bytes
+	 * @return Bounds the bounds, which are empty at the origin if there are no positions
+	 */
+	Bounds computeBounds(const glm::vec3 * positions, size_t count, size_t stride);
+
+	/**
+	 * @brief Computes the bounds of the 'position' members of vertices.
+	 *
+	 */
+	template <typename T>
+	Bounds computeBounds(const std::vector<T> & vertices);
+
+	/**
+	 * @brief Grows bounds until they enclose positions that are stored with a fixed stride, bounds that already enclose
+	 * all positions stay unchanged.
+	 *
+	 * The sphere grows towards every position outside of it, so it is larger than the sphere of computeBounds.
+	 *
+	 * @param bounds the bounds that will grow
+	 * @param positions the first position
+	 * @param count the number of positions
+	 * @param stride the distance between two positions in bytes
+	 */
+	void growBounds(Bounds * bounds, const glm::vec3 * positions, size_t count, size_t stride);
+}
+
+/**
+ * @brief An axis-aligned bounding box.
+ *
+ */
+struct GLRF::BoundingBox {
+	glm::vec3 min = glm::vec3(0.f);
+	glm::vec3 max = glm::vec3(0.f);
+
+	glm::vec3 getCenter() const { return 0.5f * (this->min + this->max); }
+	glm::vec3 getExtent() const { return 0.5f * (this->max - this->min); }
+
+	/**
+	 * @brief Returns the axis-aligned box that encloses this box after it was transformed.
+	 *
+	 */
+	BoundingBox transform(const glm::mat4 & matrix) const;
+};
+
+/**
+ * @brief A bounding sphere.
+ *
+ */
+struct GLRF::BoundingSphere {
+	glm::vec3 center = glm::vec3(0.f);
+	float radius = 0.f;
+
+	/**
+	 * @brief Returns a sphere that encloses this sphere after it was transformed, the radius grows with the largest scale.
+	 *
+	 */
+	BoundingSphere transform(const glm::mat4 & matrix) const;
+};
+
+/**
+ * @brief The bounds of a mesh in its local coordinate system.
+ *
+ */
+struct GLRF::Bounds {
+	BoundingBox box;
+	BoundingSphere sphere;
+
+	bool operator == (const Bounds & other) const
+	{
+		return this->box.min == other.box.min && this->box.max == other.box.max
+			&& this->sphere.center == other.sphere.center && this->sphere.radius == other.sphere.radius;
+	}
+	bool operator != (const Bounds & other) const { return !(*this == other); }
+};
+
+template <typename T, typename>
+struct GLRF::HasPosition : std::false_type {};
+
+template <typename T>
+struct GLRF::HasPosition<T, std::void_t<decltype(std::declval<T>().position)>>
+	: std::is_same<std::decay_t<decltype(std::declval<T>().position)>, glm::vec3> {};
+
+template <typename T>
+GLRF::Bounds GLRF::computeBounds(const std::vector<T> & vertices)
+{
+	static_assert(HasPosition<T>::value, "T must have a member 'glm::vec3 position'");
+	if (vertices.empty()) return Bounds();
+	return computeBounds(&vertices[0].position, vertices.size(), sizeof(T));
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+namespace GLRF {
+	struct BufferAllocatorStatistics;
+	class BufferAllocator;
+}
+
+/**
+ * @brief The state of the memory that a BufferAllocator manages (all sizes in units of the allocator).
+ *
+ */
+struct GLRF::BufferAllocatorStatistics {
+	uint64_t capacity = 0;
+	uint64_t used = 0;
+	uint64_t free = 0;
+	uint64_t largest_free_block = 0;
+	uint32_t allocation_count = 0;
+	uint32_t free_block_count = 0;
+
+	/**
+	 * @brief The share of free memory that is not part of the largest free block (0 = no fragmentation).
+	 *
+	 */
+	float fragmentation = 0.f;
+};
+
+/**
+ * @brief Manages ranges inside a large buffer with a two-level segregated fit (TLSF) allocator.
+ *
+ * The allocator only manages offsets and does not touch any memory, so it can suballocate GPU buffers.
+ * Sizes and offsets are given in arbitrary units (e.g. vertices or indices), so that offsets can be used
+ * as base vertex or first index directly. Allocation and deallocation take constant time,
+ * adjacent free ranges are merged immediately.
+ */
+class GLRF::BufferAllocator {
+public:
+	typedef uint32_t Handle;
+
+	static constexpr Handle INVALID_HANDLE = 0xFFFFFFFF;
+
+	/**
+	 * @brief A range that was moved by compact and must be copied inside the managed buffer.
+	 *
+	 */
+	struct Move {
+		uint64_t from;
+		uint64_t to;
+		uint64_t size;
+	};
+
+	/**
+	 * @brief Construct a new BufferAllocator object.
+	 *
+	 * @param capacity the number of units that can be allocated
+	 */
+	BufferAllocator(uint64_t capacity);
+	~BufferAllocator();
+
+	/**
+	 * @brief Allocates a range.
+	 *
+	 * @param size the number of units (greater than 0)
+	 * @return Handle the handle of the allocation or INVALID_HANDLE if no free range is large enough
+	 */
+	Handle allocate(uint64_t size);
+
+	/**
+	 * @brief Releases an allocation, the handle must not be used afterwards.
+	 *
+	 */
+	void free(Handle handle);
+
+	uint64_t getOffset(Handle handle);
+	uint64_t getSize(Handle handle);
+	uint64_t getCapacity();
+
+	/**
+	 * @brief Moves all allocations to the beginning of the buffer, so that all free units form a single range.
+	 *
+	 * @return std::vector<Move> the moves in ascending order, which never move a range to a higher offset
+	 *
+	 * Handles stay valid, their offsets change according to the moves.
+	 */
+	std::vector<Move> compact();
+
+	BufferAllocatorStatistics getStatistics();
+private:
+	static constexpr uint32_t SL_BITS = 4;
+	static constexpr uint32_t SL_COUNT = 1u << SL_BITS;
+	static constexpr uint32_t FL_COUNT = 64;
+	static constexpr uint32_t NO_BLOCK = 0xFFFFFFFF;
+
+	struct Block {
+		uint64_t offset;
+		uint64_t size;
+		uint32_t prev_physical;
+		uint32_t next_physical;
+		uint32_t prev_free;
+		uint32_t next_free;
+		bool free;
+	};
+
+	uint64_t capacity;
+	std::vector<Block> blocks;
+	std::vector<uint32_t> unused_blocks;
+	uint32_t first_block;
+	uint64_t fl_bitmap = 0;
+	uint32_t sl_bitmaps[FL_COUNT];
+	uint32_t free_heads[FL_COUNT][SL_COUNT];
+
+	static uint32_t floorLog2(uint64_t value);
+	static void mapping(uint64_t size, uint32_t * fl, uint32_t * sl);
+
+	uint32_t createBlock(uint64_t offset, uint64_t size);
+	void releaseBlock(uint32_t block);
+	void insertFree(uint32_t block);
+	void removeFree(uint32_t block);
+	uint32_t findFree(uint64_t size);
+	void mergeWithNext(uint32_t block);
+};
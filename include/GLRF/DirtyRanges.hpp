@@ -0,0 +1,62 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+namespace GLRF {
+	class DirtyRanges;
+}
+
+/**
+ * @brief A set of element ranges that were changed and must be uploaded again.
+ *
+ * Ranges are kept sorted and coalesced: overlapping and adjacent ranges (or ranges that are at most
+ * merge_distance elements apart) are merged, so that every range can be uploaded with a single call.
+ */
+class GLRF::DirtyRanges {
+public:
+	struct Range {
+		size_t first;
+		size_t count;
+	};
+
+	/**
+	 * @brief Construct a new DirtyRanges object.
+	 *
+	 * @param merge_distance the largest gap between two ranges that is uploaded along with them instead of splitting the upload
+	 */
+	DirtyRanges(size_t merge_distance = 0);
+	~DirtyRanges();
+
+	/**
+	 * @brief Marks a range of elements as changed.
+	 *
+	 * @param first the index of the first element
+	 * @param count the number of elements, empty ranges are ignored
+	 */
+	void mark(size_t first, size_t count);
+
+	void clear();
+	bool empty() const;
+
+	/**
+	 * @brief Returns the ranges in ascending order, which neither overlap nor touch each other.
+	 *
+	 */
+	const std::vector<Range>& getRanges() const;
+
+	/**
+	 * @brief Returns the index after the last marked element (0 if no range is marked).
+	 *
+	 */
+	size_t getEnd() const;
+
+	/**
+	 * @brief Returns the total number of marked elements.
+	 *
+	 */
+	size_t getCount() const;
+private:
+	size_t merge_distance;
+	std::vector<Range> ranges;
+};
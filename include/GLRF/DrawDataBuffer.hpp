@@ -0,0 +1,83 @@
+#pragma once
+#include <glad/glad.h>
+#include <vector>
+#include <algorithm>
+#include <memory>
+
+#include <GLRF/UniformBuffer.hpp>
+#include <GLRF/UniformBlocks.hpp>
+
+namespace GLRF {
+	class DrawDataBuffer;
+}
+
+/**
+ * @brief A ring buffer that holds the 'DrawData' uniform blocks of all draws of a frame.
+ * 
+ * The blocks of a frame are written linearly into a CPU-side staging area (which can be done in parallel,
+ * as every draw owns its own slot), uploaded with a single call and bound per draw with glBindBufferRange.
+ * The GPU buffer is split into one region per frame in flight, so that a frame never overwrites
+ * the region that a previous frame may still be reading.
+ */
+class GLRF::DrawDataBuffer {
+public:
+	/**
+	 * @brief Construct a new DrawDataBuffer object.
+	 * 
+	 * @param frames_in_flight the number of frames that use separate regions of the buffer
+	 * @param initial_capacity the number of draws per frame that fit into the buffer before it grows
+	 */
+	DrawDataBuffer(GLuint frames_in_flight = 3, size_t initial_capacity = 256);
+	~DrawDataBuffer();
+
+	DrawDataBuffer(const DrawDataBuffer&) = delete;
+	DrawDataBuffer& operator = (const DrawDataBuffer&) = delete;
+
+	/**
+	 * @brief Starts a new frame by switching to the next region and discarding all staged draws.
+	 * 
+	 */
+	void beginFrame();
+
+	/**
+	 * @brief Sets the number of draws of the current frame.
+	 * 
+	 * @param draw_count the number of draws
+	 * 
+	 * Previously staged draws are kept, new slots are uninitialized.
+	 */
+	void resize(size_t draw_count);
+
+	/**
+	 * @brief Returns the staged block of the specified draw.
+	 * 
+	 * @param draw_index the index of the draw inside the current frame
+	 * @return DrawUniformBlock& the block that will be uploaded for the draw
+	 */
+	DrawUniformBlock & at(size_t draw_index);
+
+	/**
+	 * @brief Uploads all staged blocks of the current frame with a single call.
+	 * 
+	 */
+	void upload();
+
+	/**
+	 * @brief Binds the block of the specified draw to the 'DrawData' binding point.
+	 * 
+	 * @param draw_index the index of the draw inside the current frame
+	 */
+	void bind(size_t draw_index);
+
+	size_t size();
+private:
+	GLuint frames_in_flight;
+	GLuint frame_index = 0;
+	size_t capacity;
+	size_t draw_count = 0;
+	GLsizeiptr stride;
+	std::vector<unsigned char> staging;
+	std::unique_ptr<UniformBuffer> buffer;
+
+	GLintptr getRegionOffset();
+};
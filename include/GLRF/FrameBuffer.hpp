@@ -5,6 +5,9 @@
 #include <iostream>
 #include <vector>
 
+#include <GLRF/GLStateCache.hpp>
+#include <GLRF/GLCapabilities.hpp>
+
 namespace GLRF {
     struct ScreenResolution;
     struct FrameBufferConfiguration;
@@ -53,4 +56,9 @@ private:
     std::vector<GLuint> texture_color_buffer_IDs;
     std::optional<GLuint> RBO = std::nullopt;
     std::string debug_name;
+
+    /**
+     * @brief Creates the framebuffer and its attachments without binding them (direct state access).
+     */
+    void createDirect(FrameBufferConfiguration & config, ScreenResolution & screen_res);
 };
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include <GLRF/Bounds.hpp>
+
+namespace GLRF {
+	class Frustum;
+}
+
+/**
+ * @brief The six planes of a view frustum, which test whether bounds are visible.
+ *
+ * The tests are conservative: bounds that intersect a plane are visible, even if they are outside of a corner.
+ */
+class GLRF::Frustum {
+public:
+	static constexpr size_t PLANE_COUNT = 6;
+
+	/**
+	 * @brief Construct a new Frustum object that contains everything.
+	 *
+	 */
+	Frustum();
+
+	/**
+	 * @brief Construct a new Frustum object from the planes of a clip space.
+	 *
+	 * @param view_projection the product of the projection and the view matrix (OpenGL clip space)
+	 */
+	Frustum(const glm::mat4 & view_projection);
+
+	/**
+	 * @brief Returns a plane as normalized normal (pointing inside) and distance, so that inside points have a positive dot product.
+	 *
+	 */
+	const glm::vec4 & getPlane(size_t index) const;
+
+	/**
+	 * @brief Computes the box around the eight corners of the frustum.
+	 *
+	 * @return true if the frustum is closed
+	 * @return false if it has no corners, e.g. because it contains everything or the far plane is at infinity
+	 */
+	bool getBounds(BoundingBox * box) const;
+
+	bool intersects(const BoundingSphere & sphere) const;
+
+	bool intersects(const BoundingBox & box) const;
+
+	/**
+	 * @brief Tests many spheres at once, four per iteration with SSE2 if available.
+	 *
+	 * @param spheres the spheres, each as center (xyz) and radius (w)
+	 * @param count the number of spheres
+	 * @param visible receives 1 for every visible sphere and 0 for all others
+	 */
+	void intersects(const glm::vec4 * spheres, size_t count, uint8_t * visible) const;
+private:
+	glm::vec4 planes[PLANE_COUNT];
+};
@@ -0,0 +1,84 @@
+#pragma once
+#include <glad/glad.h>
+#include <string>
+
+namespace GLRF {
+	class GLCapabilities;
+}
+
+/**
+ * @brief The features of the current OpenGL context that GLRF can make use of.
+ * 
+ * The context is queried once on first access, so the instance must not be requested before a context is current.
+ */
+class GLRF::GLCapabilities {
+public:
+	static GLCapabilities& getInstance() {
+		static GLCapabilities instance;
+		return instance;
+	}
+
+	~GLCapabilities();
+
+	/**
+	 * @brief The vendor, renderer and version strings of the driver.
+	 * 
+	 */
+	std::string vendor, renderer, version;
+
+	/**
+	 * @brief Whether program binaries can be retrieved and loaded (GL 4.1 or ARB_get_program_binary).
+	 * 
+	 */
+	bool program_binary = false;
+
+	/**
+	 * @brief Whether the driver compiles shaders on background threads and reports GL_COMPLETION_STATUS_KHR
+	 * (KHR_parallel_shader_compile or ARB_parallel_shader_compile).
+	 * 
+	 */
+	bool parallel_shader_compile = false;
+
+	/**
+	 * @brief Whether objects can be created and modified without binding them (GL 4.5 or ARB_direct_state_access).
+	 * 
+	 */
+	bool direct_state_access = false;
+
+	/**
+	 * @brief Whether instanced draws can start at an arbitrary instance (GL 4.2 or ARB_base_instance).
+	 * 
+	 */
+	bool base_instance = false;
+
+	/**
+	 * @brief Whether buffers can have immutable storage (GL 4.4 or ARB_buffer_storage).
+	 * 
+	 */
+	bool buffer_storage = false;
+
+	/**
+	 * @brief Whether many indexed draws can be issued from a buffer with a single call and read their values from
+	 * shader storage blocks (GL 4.3 or ARB_multi_draw_indirect with ARB_shader_storage_buffer_object).
+	 * 
+	 */
+	bool multi_draw_indirect = false;
+
+	/**
+	 * @brief Whether attribute formats can be specified separately from the vertex buffers they read
+	 * (GL 4.3 or ARB_vertex_attrib_binding).
+	 * 
+	 */
+	bool vertex_attrib_binding = false;
+
+	/**
+	 * @brief Whether occlusion queries can use the cheaper GL_ANY_SAMPLES_PASSED_CONSERVATIVE target
+	 * (GL 4.3 or ARB_ES3_compatibility).
+	 * 
+	 */
+	bool conservative_occlusion_query = false;
+private:
+	GLCapabilities();
+	GLCapabilities(const GLCapabilities&);
+	GLCapabilities& operator = (const GLCapabilities&);
+};
@@ -0,0 +1,150 @@
+#pragma once
+#include <glad/glad.h>
+#include <optional>
+#include <unordered_map>
+#include <cstdint>
+
+namespace GLRF {
+	struct GLStateCounters;
+	class GLStateCache;
+}
+
+/**
+ * @brief The number of state changes that were passed to OpenGL or dropped as redundant.
+ *
+ */
+struct GLRF::GLStateCounters {
+	uint64_t issued = 0;
+	uint64_t elided = 0;
+};
+
+/**
+ * @brief A shadow copy of the OpenGL state that all GLRF classes change the state through.
+ *
+ * Calls that would set a value that is already set are dropped, and the state is never queried from OpenGL.
+ * Every value starts as unknown, so the first call always reaches OpenGL.
+ * Code that changes the state without this cache must call invalidate afterwards.
+ *
+ * The element array buffer belongs to the bound vertex array, so binding it always reaches OpenGL.
+ */
+class GLRF::GLStateCache {
+public:
+	static GLStateCache& getInstance() {
+		static GLStateCache instance;
+		return instance;
+	}
+
+	~GLStateCache();
+
+	/**
+	 * @brief Starts a new frame by resetting the counters of the current frame.
+	 *
+	 */
+	void beginFrame();
+
+	/**
+	 * @brief Returns the counters of the current frame.
+	 *
+	 */
+	const GLStateCounters& getFrameCounters();
+
+	/**
+	 * @brief Returns the counters of the last completed frame.
+	 *
+	 */
+	const GLStateCounters& getLastFrameCounters();
+
+	/**
+	 * @brief Forgets all values, e.g. after the state was changed by external code.
+	 *
+	 */
+	void invalidate();
+
+	void useProgram(GLuint program);
+	void bindVertexArray(GLuint vertex_array);
+	void bindBuffer(GLenum target, GLuint buffer);
+	void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+	void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+	void activeTexture(GLenum texture_unit);
+
+	/**
+	 * @brief Binds a texture to the active texture unit.
+	 *
+	 */
+	void bindTexture(GLenum target, GLuint texture);
+
+	/**
+	 * @brief Binds a texture to the specified texture unit (e.g. GL_TEXTURE0 + 3).
+	 *
+	 */
+	void bindTexture(GLenum texture_unit, GLenum target, GLuint texture);
+	void bindSampler(GLuint unit, GLuint sampler);
+
+	/**
+	 * @brief Binds a framebuffer to GL_DRAW_FRAMEBUFFER, GL_READ_FRAMEBUFFER or both (GL_FRAMEBUFFER).
+	 *
+	 */
+	void bindFramebuffer(GLenum target, GLuint framebuffer);
+	void viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+	void pointSize(GLfloat size);
+	void lineWidth(GLfloat width);
+	void setEnabled(GLenum capability, bool enabled);
+	void blendFunc(GLenum source_factor, GLenum destination_factor);
+	void depthFunc(GLenum function);
+	void depthMask(GLboolean enabled);
+
+	/**
+	 * @brief Updates the state after objects were deleted, since OpenGL unbinds deleted objects.
+	 *
+	 * Identifiers of deleted objects are reused by OpenGL, so the cache must be notified before they are created again.
+	 */
+	void deletedProgram(GLuint program);
+	void deletedVertexArray(GLuint vertex_array);
+	void deletedBuffer(GLuint buffer);
+	void deletedTexture(GLuint texture);
+	void deletedSampler(GLuint sampler);
+	void deletedFramebuffer(GLuint framebuffer);
+private:
+	struct IndexedBufferBinding {
+		GLuint buffer;
+		GLintptr offset;
+		GLsizeiptr size;
+	};
+
+	struct Viewport {
+		GLint x, y;
+		GLsizei width, height;
+	};
+
+	GLStateCounters frame_counters;
+	GLStateCounters last_frame_counters;
+
+	std::optional<GLuint> program;
+	std::optional<GLuint> vertex_array;
+	std::unordered_map<GLenum, GLuint> buffers;
+	std::unordered_map<uint64_t, IndexedBufferBinding> indexed_buffers;
+	std::optional<GLenum> active_texture;
+	std::unordered_map<uint64_t, GLuint> textures;
+	std::unordered_map<GLuint, GLuint> samplers;
+	std::optional<GLuint> draw_framebuffer;
+	std::optional<GLuint> read_framebuffer;
+	std::optional<Viewport> current_viewport;
+	std::optional<GLfloat> point_size;
+	std::optional<GLfloat> line_width;
+	std::unordered_map<GLenum, bool> capabilities;
+	std::optional<std::pair<GLenum, GLenum>> blend_factors;
+	std::optional<GLenum> depth_function;
+	std::optional<GLboolean> depth_write;
+
+	GLStateCache();
+	GLStateCache(const GLStateCache&);
+	GLStateCache& operator = (const GLStateCache&);
+
+	/**
+	 * @brief Counts a state change and returns whether it must be issued.
+	 *
+	 */
+	bool change(bool redundant);
+
+	static uint64_t key(GLenum a, GLuint b);
+};
@@ -0,0 +1,547 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+#include <glad/glad.h>
+
+#include <GLRF/BufferAllocator.hpp>
+#include <GLRF/GLStateCache.hpp>
+#include <GLRF/GLCapabilities.hpp>
+#include <GLRF/InstanceBuffer.hpp>
+#include <GLRF/StreamingBuffer.hpp>
+
+namespace GLRF {
+	struct GeometryAllocation;
+	struct GeometryChunkStatistics;
+	template <typename T> class GeometryPool;
+}
+
+/**
+ * @brief The vertex and index ranges of a mesh inside a GeometryPool.
+ *
+ */
+struct GLRF::GeometryAllocation {
+	uint32_t chunk = 0;
+	BufferAllocator::Handle vertices = BufferAllocator::INVALID_HANDLE;
+	BufferAllocator::Handle indices = BufferAllocator::INVALID_HANDLE;
+
+	bool isValid() const { return this->vertices != BufferAllocator::INVALID_HANDLE; }
+	bool hasIndices() const { return this->indices != BufferAllocator::INVALID_HANDLE; }
+
+	bool operator == (const GeometryAllocation & other) const
+	{
+		return this->chunk == other.chunk && this->vertices == other.vertices && this->indices == other.indices;
+	}
+	bool operator != (const GeometryAllocation & other) const { return !(*this == other); }
+};
+
+/**
+ * @brief The memory usage of a single chunk of a GeometryPool (in vertices and indices).
+ *
+ */
+struct GLRF::GeometryChunkStatistics {
+	BufferAllocatorStatistics vertices;
+	BufferAllocatorStatistics indices;
+};
+
+/**
+ * @brief Holds the vertices and indices of all meshes of a vertex format in a few large buffers.
+ *
+ * The buffers are split into chunks, each of which has one vertex buffer and one index buffer with immutable storage.
+ * Meshes receive ranges inside these buffers (see BufferAllocator) and select them with the base vertex
+ * and the first index of their draws, so meshes of the same chunk share all GL objects.
+ * Indices stay relative to the first vertex of their mesh.
+ *
+ * The attribute layout is described once in a single vertex array per format with separate attribute formats
+ * (GL 4.3 or ARB_vertex_attrib_binding), switching chunks only rebinds the vertex and element buffer of this vertex array.
+ * Without separate attribute formats, every chunk has a vertex array of its own.
+ */
+template <typename T>
+class GLRF::GeometryPool {
+public:
+	/**
+	 * @brief The default number of vertices and indices that fit into a chunk.
+	 *
+	 */
+	static constexpr uint64_t DEFAULT_VERTEX_CAPACITY = 1 << 18;
+	static constexpr uint64_t DEFAULT_INDEX_CAPACITY = 1 << 20;
+
+	static GeometryPool& getInstance()
+	{
+		static GeometryPool instance;
+		return instance;
+	}
+
+	/**
+	 * @brief Sets the size of chunks that are created afterwards, meshes that are larger receive a chunk of their own.
+	 *
+	 */
+	void setChunkCapacity(uint64_t vertex_capacity, uint64_t index_capacity)
+	{
+		this->vertex_capacity = std::max(vertex_capacity, static_cast<uint64_t>(1));
+		this->index_capacity = std::max(index_capacity, static_cast<uint64_t>(1));
+	}
+
+	/**
+	 * @brief Allocates the ranges for a mesh, no index range is allocated if index_count is 0.
+	 *
+	 * @param vertex_count the number of vertices (greater than 0)
+	 * @param index_count the number of indices
+	 * @return GeometryAllocation the ranges of the mesh
+	 */
+	GeometryAllocation allocate(uint64_t vertex_count, uint64_t index_count)
+	{
+		GeometryAllocation allocation;
+		if (vertex_count == 0) return allocation;
+
+		for (uint32_t chunk = 0; chunk < this->chunks.size(); chunk++)
+		{
+			if (allocateInChunk(chunk, vertex_count, index_count, &allocation)) return allocation;
+		}
+
+		// free ranges may be too fragmented, so compact chunks that have enough space in total first
+		for (uint32_t chunk = 0; chunk < this->chunks.size(); chunk++)
+		{
+			BufferAllocatorStatistics vertex_statistics = this->chunks[chunk]->vertex_allocator.getStatistics();
+			BufferAllocatorStatistics index_statistics = this->chunks[chunk]->index_allocator.getStatistics();
+			if (vertex_statistics.free < vertex_count || index_statistics.free < index_count) continue;
+			compact(chunk);
+			if (allocateInChunk(chunk, vertex_count, index_count, &allocation)) return allocation;
+		}
+
+		createChunk(std::max(vertex_count, this->vertex_capacity), std::max(index_count, this->index_capacity));
+		allocateInChunk(static_cast<uint32_t>(this->chunks.size() - 1), vertex_count, index_count, &allocation);
+		return allocation;
+	}
+
+	/**
+	 * @brief Releases the ranges of a mesh.
+	 *
+	 */
+	void free(GeometryAllocation & allocation)
+	{
+		if (!allocation.isValid()) return;
+		Chunk & chunk = *this->chunks[allocation.chunk];
+		chunk.vertex_allocator.free(allocation.vertices);
+		if (allocation.hasIndices()) chunk.index_allocator.free(allocation.indices);
+		allocation = GeometryAllocation();
+	}
+
+	/**
+	 * @brief Writes vertices and indices into the ranges of a mesh, which must be large enough.
+	 *
+	 */
+	void upload(const GeometryAllocation & allocation, const T * vertices, uint64_t vertex_count,
+		const GLuint * indices, uint64_t index_count)
+	{
+		uploadVertices(allocation, 0, vertices, vertex_count);
+		uploadIndices(allocation, 0, indices, index_count);
+	}
+
+	/**
+	 * @brief Writes consecutive vertices into the range of a mesh.
+	 *
+	 * @param first_vertex the index of the first vertex inside the mesh
+	 */
+	void uploadVertices(const GeometryAllocation & allocation, uint64_t first_vertex, const T * vertices, uint64_t vertex_count)
+	{
+		if (!allocation.isValid() || vertex_count == 0) return;
+		Chunk & chunk = *this->chunks[allocation.chunk];
+		uint64_t offset = chunk.vertex_allocator.getOffset(allocation.vertices) + first_vertex;
+		uploadRange(chunk.VBO, sizeof(T) * offset, sizeof(T) * vertex_count, vertices);
+	}
+
+	/**
+	 * @brief Writes consecutive indices into the range of a mesh.
+	 *
+	 * @param first_index the position of the first index inside the mesh
+	 */
+	void uploadIndices(const GeometryAllocation & allocation, uint64_t first_index, const GLuint * indices, uint64_t index_count)
+	{
+		if (!allocation.hasIndices() || index_count == 0) return;
+		Chunk & chunk = *this->chunks[allocation.chunk];
+		uint64_t offset = chunk.index_allocator.getOffset(allocation.indices) + first_index;
+		uploadRange(chunk.EBO, sizeof(GLuint) * offset, sizeof(GLuint) * index_count, indices);
+	}
+
+	uint64_t getVertexCapacity(const GeometryAllocation & allocation)
+	{
+		return allocation.isValid() ? this->chunks[allocation.chunk]->vertex_allocator.getSize(allocation.vertices) : 0;
+	}
+
+	uint64_t getIndexCapacity(const GeometryAllocation & allocation)
+	{
+		return allocation.hasIndices() ? this->chunks[allocation.chunk]->index_allocator.getSize(allocation.indices) : 0;
+	}
+
+	/**
+	 * @brief Returns the base vertex of the draws of a mesh.
+	 *
+	 */
+	GLint getBaseVertex(const GeometryAllocation & allocation)
+	{
+		return static_cast<GLint>(this->chunks[allocation.chunk]->vertex_allocator.getOffset(allocation.vertices));
+	}
+
+	/**
+	 * @brief Returns the first index of the draws of a mesh.
+	 *
+	 */
+	GLuint getFirstIndex(const GeometryAllocation & allocation)
+	{
+		return static_cast<GLuint>(this->chunks[allocation.chunk]->index_allocator.getOffset(allocation.indices));
+	}
+
+	/**
+	 * @brief Returns the vertex buffer that the draws of a mesh read, draws of different buffers cannot be merged.
+	 *
+	 */
+	GLuint getVertexBuffer(const GeometryAllocation & allocation)
+	{
+		return this->chunks[allocation.chunk]->VBO;
+	}
+
+	/**
+	 * @brief Binds the vertex array that draws a mesh.
+	 *
+	 * The shared vertex array only switches its buffers if the previous mesh was in another chunk.
+	 */
+	void bindVertexArray(const GeometryAllocation & allocation)
+	{
+		Chunk & chunk = *this->chunks[allocation.chunk];
+		GLStateCache & state = GLStateCache::getInstance();
+		if (!usesSharedVertexArray()) {
+			state.bindVertexArray(chunk.VAO);
+			return;
+		}
+
+		if (this->shared_vertex_array == 0) createSharedVertexArray();
+		state.bindVertexArray(this->shared_vertex_array);
+		if (this->bound_chunk == allocation.chunk) return;
+		this->bound_chunk = allocation.chunk;
+
+		if (GLCapabilities::getInstance().direct_state_access) {
+			glVertexArrayVertexBuffer(this->shared_vertex_array, 0, chunk.VBO, 0, sizeof(T));
+			glVertexArrayElementBuffer(this->shared_vertex_array, chunk.EBO);
+		}
+		else {
+			glBindVertexBuffer(0, chunk.VBO, 0, sizeof(T));
+			state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, chunk.EBO);
+		}
+	}
+
+	/**
+	 * @brief Returns whether meshes can stream their data through the StreamingBuffer instead of the pool,
+	 * which requires persistent mapping and the shared vertex array.
+	 *
+	 */
+	static bool supportsStreaming()
+	{
+		return StreamingBuffer::isAvailable() && usesSharedVertexArray();
+	}
+
+	/**
+	 * @brief Binds the shared vertex array to read the vertices and indices of a mesh from the StreamingBuffer.
+	 *
+	 * @param buffer the buffer that holds the vertices and indices
+	 * @param vertex_offset the offset of the first vertex in bytes
+	 */
+	void bindStreamVertexArray(GLuint buffer, GLintptr vertex_offset)
+	{
+		if (this->shared_vertex_array == 0) createSharedVertexArray();
+		GLStateCache & state = GLStateCache::getInstance();
+		state.bindVertexArray(this->shared_vertex_array);
+		this->bound_chunk = NO_CHUNK;
+
+		if (GLCapabilities::getInstance().direct_state_access) {
+			glVertexArrayVertexBuffer(this->shared_vertex_array, 0, buffer, vertex_offset, sizeof(T));
+			glVertexArrayElementBuffer(this->shared_vertex_array, buffer);
+		}
+		else {
+			glBindVertexBuffer(0, buffer, vertex_offset, sizeof(T));
+			state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+		}
+	}
+
+	/**
+	 * @brief Lets the vertex array of a mesh read the per-instance attributes from the specified buffer.
+	 *
+	 * The attributes are only specified again after the buffer was replaced.
+	 */
+	void attachInstanceBuffer(const GeometryAllocation & allocation, InstanceBuffer * instances)
+	{
+		bool direct_state_access = GLCapabilities::getInstance().direct_state_access;
+		GLStateCache & state = GLStateCache::getInstance();
+
+		if (usesSharedVertexArray()) {
+			if (this->shared_vertex_array == 0) createSharedVertexArray();
+			if (this->instance_buffer == instances->getID() && this->instance_buffer_generation == instances->getGeneration()) return;
+			this->instance_buffer = instances->getID();
+			this->instance_buffer_generation = instances->getGeneration();
+
+			// the attribute formats are described once, replaced buffers are only bound again
+			if (direct_state_access) {
+				if (!this->instance_format_registered) T::registerInstanceFormat(this->shared_vertex_array, INSTANCE_BUFFER_BINDING);
+				glVertexArrayVertexBuffer(this->shared_vertex_array, INSTANCE_BUFFER_BINDING, instances->getID(), 0, sizeof(InstanceData));
+			}
+			else {
+				state.bindVertexArray(this->shared_vertex_array);
+				if (!this->instance_format_registered) T::registerSeparateInstanceFormat(INSTANCE_BUFFER_BINDING);
+				glBindVertexBuffer(INSTANCE_BUFFER_BINDING, instances->getID(), 0, sizeof(InstanceData));
+			}
+			this->instance_format_registered = true;
+			return;
+		}
+
+		Chunk & chunk = *this->chunks[allocation.chunk];
+		if (chunk.instance_buffer == instances->getID() && chunk.instance_buffer_generation == instances->getGeneration()) return;
+		chunk.instance_buffer = instances->getID();
+		chunk.instance_buffer_generation = instances->getGeneration();
+
+		state.bindVertexArray(chunk.VAO);
+		state.bindBuffer(GL_ARRAY_BUFFER, instances->getID());
+		T::registerInstanceFormat();
+	}
+
+	/**
+	 * @brief Moves all ranges of a chunk to the beginning of its buffers, so that its free space is not fragmented.
+	 *
+	 * The data is copied on the GPU, allocations stay valid, but their base vertex and first index change.
+	 */
+	void compact(uint32_t chunk_index)
+	{
+		Chunk & chunk = *this->chunks[chunk_index];
+		std::vector<BufferAllocator::Move> vertex_moves = chunk.vertex_allocator.compact();
+		std::vector<BufferAllocator::Move> index_moves = chunk.index_allocator.compact();
+		copyMoves(chunk.VBO, vertex_moves, sizeof(T));
+		copyMoves(chunk.EBO, index_moves, sizeof(GLuint));
+		if (!vertex_moves.empty() || !index_moves.empty()) this->generation++;
+	}
+
+	void compact()
+	{
+		for (uint32_t chunk = 0; chunk < this->chunks.size(); chunk++) compact(chunk);
+	}
+
+	/**
+	 * @brief Returns a number that increases whenever a compaction moved ranges, so that base vertices and first indices changed.
+	 *
+	 */
+	uint64_t getGeneration()
+	{
+		return this->generation;
+	}
+
+	std::vector<GeometryChunkStatistics> getStatistics()
+	{
+		std::vector<GeometryChunkStatistics> statistics;
+		for (const std::unique_ptr<Chunk> & chunk : this->chunks)
+		{
+			statistics.push_back({ chunk->vertex_allocator.getStatistics(), chunk->index_allocator.getStatistics() });
+		}
+		return statistics;
+	}
+private:
+	static constexpr uint32_t NO_CHUNK = 0xFFFFFFFF;
+
+	struct Chunk {
+		GLuint VAO = 0; // only used without a shared vertex array
+		GLuint VBO = 0;
+		GLuint EBO = 0;
+		BufferAllocator vertex_allocator;
+		BufferAllocator index_allocator;
+		GLuint instance_buffer = 0;
+		GLuint instance_buffer_generation = 0;
+
+		Chunk(uint64_t vertex_capacity, uint64_t index_capacity)
+			: vertex_allocator(vertex_capacity), index_allocator(index_capacity) {}
+	};
+
+	std::vector<std::unique_ptr<Chunk>> chunks;
+	uint64_t vertex_capacity = DEFAULT_VERTEX_CAPACITY;
+	uint64_t index_capacity = DEFAULT_INDEX_CAPACITY;
+	GLuint shared_vertex_array = 0;
+	uint64_t generation = 0;
+	uint32_t bound_chunk = NO_CHUNK;
+	bool instance_format_registered = false;
+	GLuint instance_buffer = 0;
+	GLuint instance_buffer_generation = 0;
+
+	GeometryPool() {}
+	GeometryPool(const GeometryPool&);
+	GeometryPool& operator = (const GeometryPool&);
+
+	bool allocateInChunk(uint32_t chunk_index, uint64_t vertex_count, uint64_t index_count, GeometryAllocation * allocation)
+	{
+		Chunk & chunk = *this->chunks[chunk_index];
+		BufferAllocator::Handle vertices = chunk.vertex_allocator.allocate(vertex_count);
+		if (vertices == BufferAllocator::INVALID_HANDLE) return false;
+
+		BufferAllocator::Handle indices = BufferAllocator::INVALID_HANDLE;
+		if (index_count > 0)
+		{
+			indices = chunk.index_allocator.allocate(index_count);
+			if (indices == BufferAllocator::INVALID_HANDLE)
+			{
+				chunk.vertex_allocator.free(vertices);
+				return false;
+			}
+		}
+
+		allocation->chunk = chunk_index;
+		allocation->vertices = vertices;
+		allocation->indices = indices;
+		return true;
+	}
+
+	static bool usesSharedVertexArray()
+	{
+		return GLCapabilities::getInstance().vertex_attrib_binding;
+	}
+
+	/**
+	 * @brief Creates the vertex array that all chunks share and describes the attribute layout of T once.
+	 *
+	 */
+	void createSharedVertexArray()
+	{
+		if (GLCapabilities::getInstance().direct_state_access) {
+			glCreateVertexArrays(1, &this->shared_vertex_array);
+			T::registerFormat(this->shared_vertex_array, 0);
+			return;
+		}
+		glGenVertexArrays(1, &this->shared_vertex_array);
+		GLStateCache & state = GLStateCache::getInstance();
+		state.bindVertexArray(this->shared_vertex_array);
+		T::registerSeparateFormat(0);
+	}
+
+	void createChunk(uint64_t vertex_capacity, uint64_t index_capacity)
+	{
+		std::unique_ptr<Chunk> chunk(new Chunk(vertex_capacity, index_capacity));
+		GLsizeiptr vertex_size = static_cast<GLsizeiptr>(sizeof(T) * vertex_capacity);
+		GLsizeiptr index_size = static_cast<GLsizeiptr>(sizeof(GLuint) * index_capacity);
+		GLStateCache & state = GLStateCache::getInstance();
+
+		if (GLCapabilities::getInstance().direct_state_access) {
+			glCreateBuffers(1, &chunk->VBO);
+			glCreateBuffers(1, &chunk->EBO);
+			glNamedBufferStorage(chunk->VBO, vertex_size, NULL, GL_DYNAMIC_STORAGE_BIT);
+			glNamedBufferStorage(chunk->EBO, index_size, NULL, GL_DYNAMIC_STORAGE_BIT);
+		}
+		else if (usesSharedVertexArray()) {
+			// the copy target does not change the element buffer of the bound vertex array
+			glGenBuffers(1, &chunk->VBO);
+			glGenBuffers(1, &chunk->EBO);
+			state.bindBuffer(GL_COPY_WRITE_BUFFER, chunk->VBO);
+			createStorage(GL_COPY_WRITE_BUFFER, vertex_size);
+			state.bindBuffer(GL_COPY_WRITE_BUFFER, chunk->EBO);
+			createStorage(GL_COPY_WRITE_BUFFER, index_size);
+		}
+		else {
+			glGenVertexArrays(1, &chunk->VAO);
+			glGenBuffers(1, &chunk->VBO);
+			glGenBuffers(1, &chunk->EBO);
+
+			state.bindVertexArray(chunk->VAO);
+			state.bindBuffer(GL_ARRAY_BUFFER, chunk->VBO);
+			createStorage(GL_ARRAY_BUFFER, vertex_size);
+			state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, chunk->EBO);
+			createStorage(GL_ELEMENT_ARRAY_BUFFER, index_size);
+			T::registerFormat();
+			state.bindVertexArray(0);
+		}
+		this->chunks.push_back(std::move(chunk));
+	}
+
+	static void createStorage(GLenum target, GLsizeiptr size)
+	{
+		if (GLCapabilities::getInstance().buffer_storage) {
+			glBufferStorage(target, size, NULL, GL_DYNAMIC_STORAGE_BIT);
+		}
+		else {
+			glBufferData(target, size, NULL, GL_STATIC_DRAW);
+		}
+	}
+
+	static void uploadRange(GLuint buffer, uint64_t offset, uint64_t size, const void * data)
+	{
+		if (GLCapabilities::getInstance().direct_state_access) {
+			glNamedBufferSubData(buffer, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), data);
+			return;
+		}
+		// the copy target is not part of any vertex array state, unlike the element array buffer
+		GLStateCache::getInstance().bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), data);
+	}
+
+	/**
+	 * @brief Applies the moves of a compaction to a buffer.
+	 *
+	 * Moves never overlap the sources of later moves, but a range may overlap its own destination,
+	 * in which case it is copied through a temporary buffer.
+	 */
+	static void copyMoves(GLuint buffer, const std::vector<BufferAllocator::Move> & moves, uint64_t unit_size)
+	{
+		if (moves.empty()) return;
+		bool direct_state_access = GLCapabilities::getInstance().direct_state_access;
+		GLStateCache & state = GLStateCache::getInstance();
+
+		uint64_t scratch_size = 0;
+		for (const BufferAllocator::Move & move : moves)
+		{
+			if (move.from - move.to < move.size) scratch_size = std::max(scratch_size, move.size * unit_size);
+		}
+		GLuint scratch = 0;
+		if (scratch_size > 0) {
+			if (direct_state_access) {
+				glCreateBuffers(1, &scratch);
+				glNamedBufferStorage(scratch, static_cast<GLsizeiptr>(scratch_size), NULL, 0);
+			}
+			else {
+				glGenBuffers(1, &scratch);
+				state.bindBuffer(GL_COPY_WRITE_BUFFER, scratch);
+				glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(scratch_size), NULL, GL_STREAM_COPY);
+			}
+		}
+
+		for (const BufferAllocator::Move & move : moves)
+		{
+			GLintptr from = static_cast<GLintptr>(move.from * unit_size);
+			GLintptr to = static_cast<GLintptr>(move.to * unit_size);
+			GLsizeiptr size = static_cast<GLsizeiptr>(move.size * unit_size);
+			bool overlapping = move.from - move.to < move.size;
+
+			if (direct_state_access) {
+				if (overlapping) {
+					glCopyNamedBufferSubData(buffer, scratch, from, 0, size);
+					glCopyNamedBufferSubData(scratch, buffer, 0, to, size);
+				}
+				else {
+					glCopyNamedBufferSubData(buffer, buffer, from, to, size);
+				}
+				continue;
+			}
+
+			if (overlapping) {
+				state.bindBuffer(GL_COPY_READ_BUFFER, buffer);
+				state.bindBuffer(GL_COPY_WRITE_BUFFER, scratch);
+				glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, from, 0, size);
+				state.bindBuffer(GL_COPY_READ_BUFFER, scratch);
+				state.bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+				glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, to, size);
+			}
+			else {
+				state.bindBuffer(GL_COPY_READ_BUFFER, buffer);
+				state.bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+				glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, from, to, size);
+			}
+		}
+
+		if (scratch != 0) {
+			glDeleteBuffers(1, &scratch);
+			state.deletedBuffer(scratch);
+		}
+	}
+};
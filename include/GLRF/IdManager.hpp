@@ -6,6 +6,8 @@ typedef unsigned long long IdSpaceSize;
 class IdManager {
 private:
     IdSpaceSize next_node_id;
+    IdSpaceSize next_material_id;
+    IdSpaceSize next_object_id;
     IdManager();
     IdManager(const IdManager&);
     IdManager & operator = (const IdManager &);
@@ -18,4 +20,6 @@ public:
     ~IdManager();
 
     IdSpaceSize getNodeId();
+    IdSpaceSize getMaterialId();
+    IdSpaceSize getObjectId();
 };
\ No newline at end of file
@@ -0,0 +1,125 @@
+#pragma once
+#include <glad/glad.h>
+#include <vector>
+#include <algorithm>
+
+#include <GLRF/GLStateCache.hpp>
+#include <GLRF/GLCapabilities.hpp>
+#include <GLRF/UniformBlocks.hpp>
+
+namespace GLRF {
+	struct DrawElementsIndirectCommand;
+	struct IndirectDraw;
+	class IndirectDrawBuffer;
+}
+
+/**
+ * @brief The layout of a single indexed draw inside an indirect buffer (see glMultiDrawElementsIndirect).
+ *
+ */
+struct GLRF::DrawElementsIndirectCommand {
+	GLuint count;
+	GLuint instance_count;
+	GLuint first_index;
+	GLint base_vertex;
+	GLuint base_instance;
+};
+
+/**
+ * @brief Describes how an object is drawn by an indirect command, draws can share a command if all fields except
+ * the instance count and the base instance are equal.
+ *
+ */
+struct GLRF::IndirectDraw {
+	GLuint vertex_buffer = 0;
+	GLenum mode = GL_TRIANGLES;
+	DrawElementsIndirectCommand command = { 0, 1, 0, 0, 0 };
+};
+
+/**
+ * @brief A ring buffer that holds the indirect commands and the 'DrawDataArray' storage block of all
+ * multi-draw indirect draws of a frame.
+ *
+ * Like DrawDataBuffer, the values of a frame are staged, uploaded with a single call and the buffers are split
+ * into one region per frame in flight. The storage block is bound once for the whole buffer, every draw selects
+ * its values through the base instance of its command (see getBaseInstance), so instances of a command read
+ * consecutive values.
+ */
+class GLRF::IndirectDrawBuffer {
+public:
+	/**
+	 * @brief Construct a new IndirectDrawBuffer object.
+	 *
+	 * @param frames_in_flight the number of frames that use separate regions of the buffers
+	 * @param initial_capacity the number of draws (and commands) per frame that fit into the buffers before they grow
+	 */
+	IndirectDrawBuffer(GLuint frames_in_flight = 3, size_t initial_capacity = 256);
+	~IndirectDrawBuffer();
+
+	IndirectDrawBuffer(const IndirectDrawBuffer&) = delete;
+	IndirectDrawBuffer& operator = (const IndirectDrawBuffer&) = delete;
+
+	/**
+	 * @brief Starts a new frame by switching to the next region and discarding all staged draws and commands.
+	 *
+	 */
+	void beginFrame();
+
+	/**
+	 * @brief Sets the number of draws of the current frame, new draws are uninitialized.
+	 *
+	 */
+	void resize(size_t draw_count);
+
+	DrawUniformBlock & at(size_t draw_index);
+
+	/**
+	 * @brief Returns the base instance that selects the values of the specified draw of the current frame.
+	 *
+	 */
+	GLuint getBaseInstance(size_t draw_index);
+
+	/**
+	 * @brief Appends a command to the current frame.
+	 *
+	 * @return size_t the index of the command inside the current frame
+	 */
+	size_t addCommand(const DrawElementsIndirectCommand & command);
+
+	DrawElementsIndirectCommand & getCommand(size_t command_index);
+
+	size_t getCommandCount();
+
+	/**
+	 * @brief Uploads all staged draws and commands of the current frame with a single call per buffer.
+	 *
+	 */
+	void upload();
+
+	/**
+	 * @brief Binds the indirect buffer and the 'DrawDataArray' storage block.
+	 *
+	 */
+	void bind();
+
+	/**
+	 * @brief Issues consecutive commands of the current frame with glMultiDrawElementsIndirect, the buffers must be bound.
+	 *
+	 * @param mode the primitive type of all commands
+	 * @param first_command the index of the first command inside the current frame
+	 * @param command_count the number of commands
+	 */
+	void draw(GLenum mode, size_t first_command, GLsizei command_count);
+private:
+	GLuint command_buffer = 0;
+	GLuint storage_buffer = 0;
+	GLuint frames_in_flight;
+	GLuint frame_index = 0;
+	size_t capacity;
+	std::vector<DrawUniformBlock> draws;
+	std::vector<DrawElementsIndirectCommand> commands;
+
+	void create();
+	void destroy();
+	static void upload(GLenum target, GLuint buffer, GLintptr offset, GLsizeiptr size, const void * data);
+};
@@ -0,0 +1,108 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <algorithm>
+
+#include <GLRF/GLStateCache.hpp>
+#include <GLRF/GLCapabilities.hpp>
+
+namespace GLRF {
+	/**
+	 * @brief The first attribute location and the vertex buffer binding point of the per-instance attributes.
+	 *
+	 */
+	static const GLuint INSTANCE_ATTRIBUTE_LOCATION = 4;
+	static const GLuint INSTANCE_BUFFER_BINDING = 1;
+
+	struct InstanceData;
+	class InstanceBuffer;
+}
+
+/**
+ * @brief The per-instance attributes of an instanced draw.
+ *
+ * Shaders opt into instancing by declaring the following attributes, which replace 'model' and 'model_normal':
+ *
+ *     layout(location = 4) in mat4 instance_model;
+ *     layout(location = 8) in mat3 instance_model_normal;
+ *
+ * Every draw of such a shader is an instanced draw, consecutive draws of the same mesh are merged into one.
+ */
+struct GLRF::InstanceData {
+	static constexpr const char * attribute_name = "instance_model";
+
+	glm::mat4 model;
+	glm::vec4 model_normal[3]; // the attributes only read the xyz components of each column
+
+	void setModelNormal(const glm::mat3 & model_normal) {
+		for (int i = 0; i < 3; i++) this->model_normal[i] = glm::vec4(model_normal[i], 0.f);
+	}
+};
+
+/**
+ * @brief A ring buffer that holds the per-instance attributes of all draws of a frame.
+ *
+ * Like DrawDataBuffer, the instances of a frame are staged, uploaded with a single call and the buffer
+ * is split into one region per frame in flight. Draws select their instances through the base instance,
+ * so vertex arrays only need to be attached again after the buffer grew (see getGeneration).
+ */
+class GLRF::InstanceBuffer {
+public:
+	/**
+	 * @brief Construct a new InstanceBuffer object.
+	 *
+	 * @param frames_in_flight the number of frames that use separate regions of the buffer
+	 * @param initial_capacity the number of instances per frame that fit into the buffer before it grows
+	 */
+	InstanceBuffer(GLuint frames_in_flight = 3, size_t initial_capacity = 256);
+	~InstanceBuffer();
+
+	InstanceBuffer(const InstanceBuffer&) = delete;
+	InstanceBuffer& operator = (const InstanceBuffer&) = delete;
+
+	/**
+	 * @brief Starts a new frame by switching to the next region and discarding all staged instances.
+	 *
+	 */
+	void beginFrame();
+
+	/**
+	 * @brief Sets the number of instances of the current frame, new instances are uninitialized.
+	 *
+	 */
+	void resize(size_t instance_count);
+
+	InstanceData & at(size_t instance_index);
+
+	/**
+	 * @brief Uploads all staged instances of the current frame with a single call.
+	 *
+	 */
+	void upload();
+
+	/**
+	 * @brief Returns the base instance that selects the specified instance of the current frame.
+	 *
+	 */
+	GLuint getBaseInstance(size_t instance_index);
+
+	GLuint getID();
+
+	/**
+	 * @brief Returns a number that changes whenever the buffer is replaced, so that vertex arrays must be attached again.
+	 *
+	 */
+	GLuint getGeneration();
+
+	size_t size();
+private:
+	GLuint ID = 0;
+	GLuint generation = 0;
+	GLuint frames_in_flight;
+	GLuint frame_index = 0;
+	size_t capacity;
+	std::vector<InstanceData> staging;
+
+	void create();
+};
@@ -5,12 +5,34 @@
 #include <variant>
 #include <optional>
 #include <memory>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
 
 #include <GLRF/Texture.hpp>
+#include <GLRF/IdManager.hpp>
+#include <GLRF/UniformBuffer.hpp>
+#include <GLRF/UniformBlocks.hpp>
 
 namespace GLRF {
 	template <typename T> class MaterialProperty;
 	class Material;
+
+	/**
+	 * @brief The features of a Material that shader variants can be specialized for.
+	 * 
+	 * Each feature is a single bit of the mask returned by Material::getFeatureMask.
+	 */
+	enum MaterialFeature : uint32_t {
+		MATERIAL_ALBEDO_TEXTURE = 1 << 0,
+		MATERIAL_NORMAL_TEXTURE = 1 << 1,
+		MATERIAL_ROUGHNESS_TEXTURE = 1 << 2,
+		MATERIAL_METALLIC_TEXTURE = 1 << 3,
+		MATERIAL_AO_TEXTURE = 1 << 4,
+		MATERIAL_HEIGHT_TEXTURE = 1 << 5,
+		MATERIAL_OPACITY_TEXTURE = 1 << 6
+	};
 }
 
 /**
@@ -128,10 +150,82 @@ public:
 	 */
 	void loadTextures(std::string name, std::string separator, std::string fileType);
 	
+	/**
+	 * @brief Returns the unique identifier of this material.
+	 * 
+	 */
+	IdSpaceSize getID();
+
+	/**
+	 * @brief Returns the features of this material as a bitmask of MaterialFeature values.
+	 * 
+	 * Materials with the same mask can be drawn by the same specialized shader variant.
+	 */
+	uint32_t getFeatureMask();
+
+	/**
+	 * @brief Returns whether objects behind this material stay visible, so that it is drawn back-to-front after opaque materials.
+	 * 
+	 */
+	bool isTranslucent() const;
+
+	/**
+	 * @brief Returns the preprocessor macros that describe a feature mask inside GLSL.
+	 * 
+	 * Every set feature is named 'GLRF_<PROPERTY>_TEXTURE' (e.g. 'GLRF_ALBEDO_TEXTURE').
+	 * 
+	 * @param feature_mask a bitmask of MaterialFeature values
+	 * @return std::vector<std::string> the names of the macros
+	 */
+	static std::vector<std::string> getFeatureDefines(uint32_t feature_mask);
+
 	/**
 	 * @brief Binds all textures to OpenGL texture units.
 	 * 
 	 * @param textureUnitsBegin the first texture unit that is currently free
 	 */
 	void bindTextures(GLuint textureUnitsBegin);
+
+	/**
+	 * @brief Updates the 'MaterialData' buffer of this material if any property changed since the last update.
+	 * 
+	 * @param frame the current frame (see ShaderManager::beginFrame), the material is checked at most once per frame
+	 * 
+	 * Changed values or textures increase the revision of the material, a changed feature mask or translucency
+	 * increases the draw generation of all materials.
+	 */
+	void sync(uint64_t frame);
+
+	/**
+	 * @brief Returns the revision of this material, which increases whenever sync detects a changed property.
+	 * 
+	 */
+	uint64_t getRevision();
+
+	/**
+	 * @brief Returns a number that increases whenever sync finds the feature mask or the translucency of any material changed.
+	 * 
+	 * Both decide about the program and the order of draws, so recorded draws (see RenderBundle) depend on this number.
+	 */
+	static uint64_t getDrawGeneration();
+
+	/**
+	 * @brief Returns the buffer that holds the 'MaterialData' block of this material (nullptr before the first sync).
+	 * 
+	 */
+	UniformBuffer * getUniformBuffer();
+private:
+	static const GLuint property_count = 7;
+	static uint64_t draw_generation;
+
+	IdSpaceSize id;
+	uint64_t revision = 0;
+	uint64_t synced_frame = 0;
+	uint32_t synced_feature_mask = 0;
+	bool synced_translucent = false;
+	MaterialUniformBlock uniform_block;
+	GLuint texture_ids[property_count];
+	std::unique_ptr<UniformBuffer> uniform_buffer;
+
+	void packUniformBlock(MaterialUniformBlock * block, GLuint * texture_ids);
 };
\ No newline at end of file
@@ -0,0 +1,151 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <GLRF/Bounds.hpp>
+#include <GLRF/WorkerPool.hpp>
+
+namespace GLRF {
+	struct OccluderGeometry;
+	class OcclusionCuller;
+}
+
+/**
+ * @brief The triangles that an object rasterizes as occluder, the data is only read until OcclusionCuller::rasterize returns.
+ *
+ */
+struct GLRF::OccluderGeometry {
+	const glm::vec3 * positions = nullptr;
+	size_t vertex_count = 0;
+	size_t stride = sizeof(glm::vec3);
+	const GLuint * indices = nullptr;
+	size_t index_count = 0;
+};
+
+/**
+ * @brief Hides objects behind occluders with a low resolution depth buffer that is rasterized on the CPU.
+ *
+ * Every frame, the triangles of the occluders are clipped, projected and rasterized into the depth buffer. Each pixel
+ * stores the farthest depth that an occluder can have inside of it, so a box whose nearest depth is behind the stored
+ * depth of every pixel it covers is hidden. Boxes that cross the near plane are always visible.
+ * The screen is split into bands of rows that are rasterized in parallel by the WorkerPool, pixels are processed four
+ * at a time with SSE2 if available. Nothing depends on a GL context, so the culler also runs headless.
+ */
+class GLRF::OcclusionCuller {
+public:
+	/**
+	 * @brief The work and the cost of the current frame.
+	 *
+	 */
+	struct Statistics {
+		size_t occluder_count = 0;
+		size_t triangle_count = 0;
+		size_t tested_count = 0;
+		size_t culled_count = 0;
+		double rasterize_milliseconds = 0.0;
+		double test_milliseconds = 0.0;
+	};
+
+	static constexpr int BAND_HEIGHT = 8;
+
+	/**
+	 * @brief Construct a new OcclusionCuller object.
+	 *
+	 * @param width the width of the depth buffer, rounded up to a multiple of four
+	 * @param height the height of the depth buffer
+	 */
+	OcclusionCuller(int width = 256, int height = 144);
+	~OcclusionCuller();
+
+	/**
+	 * @brief Clears the depth buffer, the occluders and the statistics.
+	 *
+	 * @param view_projection the product of the projection and the view matrix (OpenGL clip space)
+	 */
+	void beginFrame(const glm::mat4 & view_projection);
+
+	/**
+	 * @brief Adds the triangles of an occluder, which are rasterized by the next rasterize.
+	 *
+	 * @param geometry the triangles, which are stored by reference
+	 * @param model the model matrix of the occluder
+	 */
+	void addOccluder(const OccluderGeometry & geometry, const glm::mat4 & model);
+
+	/**
+	 * @brief Rasterizes all occluders of the frame into the depth buffer.
+	 *
+	 */
+	void rasterize();
+
+	/**
+	 * @brief Returns whether a box in world space may be visible, the result is only false if it is hidden by occluders.
+	 *
+	 */
+	bool isVisible(const BoundingBox & box) const;
+
+	/**
+	 * @brief Tests many boxes at once on the threads of the WorkerPool and counts them in the statistics.
+	 *
+	 * @param boxes the boxes in world space
+	 * @param count the number of boxes
+	 * @param visible receives 1 for every box that may be visible and 0 for all hidden boxes
+	 */
+	void testVisibility(const BoundingBox * boxes, size_t count, uint8_t * visible);
+
+	/**
+	 * @brief Returns the depth of a pixel in [0, 1], rows start at the bottom of the screen.
+	 *
+	 */
+	float getDepth(int x, int y) const;
+
+	int getWidth() const;
+
+	int getHeight() const;
+
+	const Statistics & getStatistics() const;
+private:
+	struct Occluder {
+		OccluderGeometry geometry;
+		glm::mat4 model_view_projection;
+	};
+
+	/**
+	 * @brief A counter-clockwise triangle in pixel coordinates with its depth (z) and the rows it covers.
+	 *
+	 */
+	struct ScreenTriangle {
+		glm::vec3 vertices[3];
+		int first_row;
+		int last_row;
+	};
+
+	static constexpr size_t MIN_OCCLUDERS_PER_RANGE = 4;
+	static constexpr size_t MIN_BOXES_PER_RANGE = 64;
+
+	int width;
+	int height;
+	std::vector<float> depth;
+	glm::mat4 view_projection = glm::mat4(1.f);
+	std::vector<Occluder> occluders;
+	std::vector<std::vector<ScreenTriangle>> triangles;
+	Statistics statistics;
+
+	/**
+	 * @brief Clips the triangles of an occluder against the near and the side planes and projects them onto the screen.
+	 *
+	 */
+	void setupTriangles(const Occluder & occluder, std::vector<ScreenTriangle> & triangles) const;
+
+	void addTriangle(const glm::vec4 * clip, size_t vertex_count, std::vector<ScreenTriangle> & triangles) const;
+
+	/**
+	 * @brief Rasterizes the part of a triangle that lies inside of the rows [first_row, end_row).
+	 *
+	 */
+	void rasterizeTriangle(const ScreenTriangle & triangle, int first_row, int end_row);
+};
@@ -0,0 +1,134 @@
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <GLRF/Bounds.hpp>
+#include <GLRF/FrameBuffer.hpp>
+#include <GLRF/GLStateCache.hpp>
+#include <GLRF/GLCapabilities.hpp>
+#include <GLRF/IdManager.hpp>
+
+namespace GLRF {
+	class OcclusionQueries;
+}
+
+/**
+ * @brief Hardware occlusion queries on the bounding boxes of nodes, whose results decide whether the nodes are drawn.
+ *
+ * After the draws of a frame, the boxes of the requested nodes are drawn without writing color or depth, each inside
+ * of its own query (GL_ANY_SAMPLES_PASSED_CONSERVATIVE if available). Results are read a frame later without waiting:
+ * queries whose results are not available yet stay pending, the draws of their nodes are wrapped into a conditional
+ * render (GL_QUERY_NO_WAIT), so the GPU skips them if the box was hidden. Nodes whose last result was occluded are not
+ * drawn at all until a new query finds them visible.
+ *
+ * Visibility is temporally coherent: hidden nodes are queried every frame, while visible nodes are only queried again
+ * after REQUERY_INTERVAL frames. Boxes that cross the near plane are visible without a query.
+ * All functions must be called on the thread of the GL context.
+ */
+class GLRF::OcclusionQueries {
+public:
+	/**
+	 * @brief The work of the current frame.
+	 *
+	 */
+	struct Statistics {
+		size_t requested_count = 0;
+		size_t issued_count = 0;
+		size_t pending_count = 0;
+		size_t conditional_count = 0;
+		size_t occluded_count = 0;
+	};
+
+	static constexpr uint64_t REQUERY_INTERVAL = 8;
+
+	/**
+	 * @brief The number of frames without a request after which the query of a node is released.
+	 *
+	 */
+	static constexpr uint64_t RETAIN_FRAMES = 16;
+
+	OcclusionQueries();
+	~OcclusionQueries();
+
+	OcclusionQueries(const OcclusionQueries&) = delete;
+	OcclusionQueries& operator = (const OcclusionQueries&) = delete;
+
+	/**
+	 * @brief Starts a new frame by reading the results of all pending queries that are available.
+	 *
+	 */
+	void beginFrame();
+
+	/**
+	 * @brief Announces that a node is drawn this frame, its box is queried after the draws if its history requires it.
+	 *
+	 * @param node_id the id of the node
+	 * @param box the box of the node in world space
+	 * @param framebuffer the framebuffer whose depth buffer the box is tested against
+	 */
+	void request(IdSpaceSize node_id, const BoundingBox & box, FrameBuffer * framebuffer);
+
+	/**
+	 * @brief Returns whether the last result of a node was occluded and no newer query is pending, so it is not drawn.
+	 *
+	 */
+	bool isOccluded(IdSpaceSize node_id);
+
+	/**
+	 * @brief Returns the pending query that the draws of a node are conditioned on, or 0 if they are unconditional.
+	 *
+	 */
+	GLuint getCondition(IdSpaceSize node_id);
+
+	/**
+	 * @brief Draws the boxes of all nodes that need a new query, after the draws of the frame were submitted.
+	 *
+	 * @param view_projection the product of the projection and the view matrix of this frame
+	 */
+	void issueQueries(const glm::mat4 & view_projection);
+
+	/**
+	 * @brief Releases the queries of nodes that were not requested for RETAIN_FRAMES frames.
+	 *
+	 */
+	void endFrame();
+
+	const Statistics & getStatistics() const;
+private:
+	struct NodeState {
+		GLuint query = 0;
+		bool pending = false;
+		bool visible = true;
+		uint64_t next_query_frame = 0;
+		uint64_t request_frame = 0;
+	};
+
+	struct Request {
+		IdSpaceSize node_id;
+		BoundingBox box;
+		FrameBuffer * framebuffer;
+	};
+
+	std::unordered_map<IdSpaceSize, NodeState> states;
+	std::vector<Request> requests;
+	std::vector<GLuint> free_queries;
+	GLuint program = 0;
+	GLint box_to_clip_location = -1;
+	GLuint vertex_array = 0;
+	GLuint vertex_buffer = 0;
+	GLuint index_buffer = 0;
+	uint64_t frame = 0;
+	Statistics statistics;
+
+	/**
+	 * @brief Creates the program and the unit cube that the boxes are drawn with.
+	 *
+	 */
+	void create();
+
+	static GLuint compile(GLenum type, const char * source);
+};
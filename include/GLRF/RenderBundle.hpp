@@ -0,0 +1,159 @@
+#pragma once
+#include <vector>
+#include <map>
+#include <memory>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <GLRF/SceneObject.hpp>
+#include <GLRF/FrameBuffer.hpp>
+#include <GLRF/RenderQueue.hpp>
+#include <GLRF/DrawDataBuffer.hpp>
+#include <GLRF/InstanceBuffer.hpp>
+#include <GLRF/IndirectDrawBuffer.hpp>
+#include <GLRF/RenderItem.hpp>
+#include <GLRF/WorkerPool.hpp>
+#include <GLRF/Frustum.hpp>
+
+namespace GLRF {
+	struct DrawList;
+	class RenderBundle;
+	class Scene;
+}
+
+/**
+ * @brief The resolved draws of a set of nodes: the sorted queue and the buffers that hold the values of all draws.
+ *
+ * Scene fills a draw list every frame for the dynamic nodes and once per recording for every RenderBundle.
+ */
+struct GLRF::DrawList {
+	/**
+	 * @brief A draw of an object node that was collected for the list, it only holds values and no GL state.
+	 *
+	 * Worker threads fill everything except the program, the flags that depend on it and the sort key,
+	 * which are resolved on the GL thread when the ranges are merged.
+	 * Draws with a RenderItem are submitted from the item, the others call the virtual draw functions of the object.
+	 */
+	struct PendingDraw {
+		SceneObject * object;
+		uint32_t slot;
+		FrameBuffer * framebuffer;
+		GLuint program;
+		glm::mat4 model;
+		glm::mat3 model_normal;
+		GLuint material_index;
+		float depth;
+		bool translucent;
+		bool instanced;
+		bool indirect;
+		bool has_item;
+		GLuint condition_query;
+		RenderItem item;
+	};
+
+	/**
+	 * @brief The draws that a worker thread collected for a range of nodes, with the world-space spheres that are culled.
+	 *
+	 */
+	struct DrawRange {
+		std::vector<PendingDraw> draws;
+		std::vector<glm::vec4> spheres;
+		std::vector<uint8_t> visible;
+	};
+
+	/**
+	 * @brief Consecutive draws of the render queue that are issued with a single multi-draw indirect call.
+	 *
+	 */
+	struct IndirectBatch {
+		size_t draw_count;
+		size_t first_command;
+		GLsizei command_count;
+		GLenum mode;
+	};
+
+	/**
+	 * @brief Construct a new DrawList object.
+	 *
+	 * @param frames_in_flight the number of regions of the buffers, lists that are prepared once only need one
+	 */
+	DrawList(GLuint frames_in_flight = 3);
+
+	GLuint frames_in_flight;
+	std::vector<PendingDraw> pending_draws;
+	std::vector<DrawRange> ranges;
+	std::vector<FrameBuffer *> framebuffer_ranks;
+	RenderQueue render_queue;
+	std::unique_ptr<DrawDataBuffer> draw_data;
+	std::unique_ptr<InstanceBuffer> instance_data;
+	std::unique_ptr<IndirectDrawBuffer> indirect_data;
+	std::vector<IndirectBatch> indirect_batches;
+
+	void clear();
+};
+
+/**
+ * @brief A recorded draw stream of nodes that rarely change, which the Scene replays instead of rebuilding it every frame.
+ *
+ * Recording resolves the programs, sorts the draws and uploads their matrices into buffers that belong to the bundle.
+ * Replaying only binds these buffers and issues the draws. The Scene invalidates the bundle when one of its nodes moves
+ * or one of their objects reports a change (see SceneObject::trackChanges). Changes of the framebuffers of the shaders,
+ * the available material variants or the feature masks of materials (see Material::getDrawGeneration) are detected
+ * by comparing counters, so checking a bundle does not touch its nodes.
+ *
+ * Translucent objects depend on the camera position, so they are not recorded and drawn with the dynamic nodes.
+ */
+class GLRF::RenderBundle {
+public:
+	/**
+	 * @brief Construct a new RenderBundle object, use Scene::createBundle to draw it.
+	 *
+	 * @param nodes the nodes that the bundle draws
+	 */
+	RenderBundle(const std::vector<std::shared_ptr<SceneNode<SceneObject>>> & nodes);
+	~RenderBundle();
+
+	RenderBundle(const RenderBundle&) = delete;
+	RenderBundle& operator = (const RenderBundle&) = delete;
+
+	const std::vector<std::shared_ptr<SceneNode<SceneObject>>>& getNodes();
+
+	/**
+	 * @brief Forces the bundle to be recorded again before it is drawn next, e.g. after a change that is not tracked.
+	 *
+	 */
+	void invalidate();
+
+	/**
+	 * @brief Returns how often the bundle was recorded.
+	 *
+	 */
+	uint64_t getRecordCount();
+private:
+	friend class Scene;
+
+	std::vector<std::shared_ptr<SceneNode<SceneObject>>> nodes;
+	std::vector<std::shared_ptr<SceneNode<SceneObject>>> taken_nodes;
+	std::vector<uint32_t> slots;
+	std::vector<uint32_t> translucent_slots;
+	std::vector<Material *> materials;
+	std::map<GLuint, FrameBuffer*> framebuffers;
+	uint64_t variant_generation = 0;
+	uint64_t material_generation = 0;
+	bool recorded = false;
+	uint64_t record_count = 0;
+	DrawList draws;
+
+	/**
+	 * @brief Returns whether the bundle was not invalidated and the recording still matches the specified framebuffers.
+	 *
+	 */
+	bool isValid(const std::map<GLuint, FrameBuffer*> & map_shader_fbs);
+
+	/**
+	 * @brief Syncs the materials of the bundle and stores the counters after the bundle was recorded.
+	 *
+	 */
+	void finishRecording(const std::map<GLuint, FrameBuffer*> & map_shader_fbs);
+};
@@ -0,0 +1,145 @@
+#pragma once
+#include <vector>
+#include <memory>
+
+#include <glad/glad.h>
+
+#include <GLRF/GeometryPool.hpp>
+#include <GLRF/GLStateCache.hpp>
+#include <GLRF/InstanceBuffer.hpp>
+#include <GLRF/IndirectDrawBuffer.hpp>
+#include <GLRF/Material.hpp>
+
+namespace GLRF {
+	struct RenderItem;
+	struct RenderItemFormat;
+	class RenderItemFormats;
+}
+
+/**
+ * @brief Everything that is needed to draw a mesh, as plain values that are copied into the draw lists of the Scene.
+ *
+ * Items are drawn without calling any virtual function of the object that they were created from,
+ * the behaviour that depends on the vertex format is selected through the format (see RenderItemFormats).
+ * The material is not owned by the item, the Scene keeps it alive while the item is in use.
+ */
+struct GLRF::RenderItem {
+	GLuint format = 0;
+	GLenum mode = GL_TRIANGLES;
+	GeometryAllocation geometry;
+	GLuint vertex_buffer = 0;
+	GLint base_vertex = 0;
+	GLuint first_index = 0;
+	GLuint count = 0;
+	GLuint shader_id = 0;
+	GLuint material_index = 0;
+	Material * material = nullptr;
+
+	bool hasIndices() const { return this->geometry.hasIndices(); }
+
+	/**
+	 * @brief Binds the vertex array of the item and applies the raster state of its primitive type.
+	 *
+	 */
+	void bind() const;
+
+	/**
+	 * @brief Binds the item and draws it with the current shader.
+	 *
+	 */
+	void draw() const;
+
+	/**
+	 * @brief Binds the item with the instance buffer attached and draws consecutive instances of it with the current shader,
+	 * which must use instancing.
+	 *
+	 * @param instances the buffer that holds the instances of the current frame
+	 * @param first_instance the index of the first instance inside the current frame
+	 * @param instance_count the number of instances
+	 */
+	void drawInstanced(InstanceBuffer * instances, size_t first_instance, GLsizei instance_count) const;
+
+	/**
+	 * @brief Returns the indirect command of a single instance of the item, which must have indices.
+	 *
+	 */
+	DrawElementsIndirectCommand getIndirectCommand() const;
+
+	/**
+	 * @brief Sets the point size or the line width that primitives of the specified type are drawn with.
+	 *
+	 */
+	static void applyRasterState(GLenum mode);
+};
+
+/**
+ * @brief The functions of a vertex format that render items call, which forward to the GeometryPool of the format.
+ *
+ */
+struct GLRF::RenderItemFormat {
+	void (*bind_vertex_array)(const GeometryAllocation & geometry);
+	void (*attach_instance_buffer)(const GeometryAllocation & geometry, InstanceBuffer * instances);
+	uint64_t (*get_generation)();
+};
+
+/**
+ * @brief Assigns an ID to every vertex format that render items use.
+ *
+ * The functions of a format are instantiated once when its ID is requested first (e.g. by the constructor of a SceneMesh),
+ * so drawing an item only needs to look them up by the ID.
+ */
+class GLRF::RenderItemFormats {
+public:
+	static RenderItemFormats& getInstance() {
+		static RenderItemFormats instance;
+		return instance;
+	}
+
+	~RenderItemFormats();
+
+	/**
+	 * @brief Returns the ID of the vertex format T, which is registered on the first call.
+	 *
+	 */
+	template <typename T>
+	GLuint getFormatID()
+	{
+		static const GLuint format_id = add({ &bindVertexArray<T>, &attachInstanceBuffer<T>, &getGeneration<T> });
+		return format_id;
+	}
+
+	const RenderItemFormat & getFormat(GLuint format_id);
+
+	/**
+	 * @brief Returns a number that increases whenever a compaction of the GeometryPool of any format moved data,
+	 * so that the items of these formats have to be created again.
+	 *
+	 */
+	uint64_t getGeneration();
+private:
+	std::vector<RenderItemFormat> formats;
+
+	RenderItemFormats();
+	RenderItemFormats(const RenderItemFormats&);
+	RenderItemFormats& operator = (const RenderItemFormats&);
+
+	GLuint add(const RenderItemFormat & format);
+
+	template <typename T>
+	static void bindVertexArray(const GeometryAllocation & geometry)
+	{
+		GeometryPool<T>::getInstance().bindVertexArray(geometry);
+	}
+
+	template <typename T>
+	static void attachInstanceBuffer(const GeometryAllocation & geometry, InstanceBuffer * instances)
+	{
+		GeometryPool<T>::getInstance().attachInstanceBuffer(geometry, instances);
+	}
+
+	template <typename T>
+	static uint64_t getGeneration()
+	{
+		return GeometryPool<T>::getInstance().getGeneration();
+	}
+};
@@ -0,0 +1,84 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+namespace GLRF {
+	struct RenderQueueItem;
+	class RenderQueue;
+}
+
+/**
+ * @brief A draw inside a RenderQueue, which refers to the data of the draw by an index of the caller.
+ *
+ */
+struct GLRF::RenderQueueItem {
+	uint64_t key;
+	uint32_t index;
+};
+
+/**
+ * @brief A list of draws that is sorted by 64-bit keys before it is submitted, so that state changes are minimized.
+ *
+ * From the most to the least significant bit, a key consists of:
+ *
+ *     opaque:      framebuffer (6) | 0 (1) | program (10) | material (12) | mesh (12) | depth (23, front-to-back)
+ *     translucent: framebuffer (6) | 1 (1) | depth (23, back-to-front) | program (10) | material (12) | mesh (12)
+ *
+ * Thus all draws into the same framebuffer are grouped, opaque draws are grouped by state and drawn before
+ * translucent draws, which are drawn in the order that blending requires.
+ * Identifiers that exceed their bits only weaken the grouping, never the correctness of the draws.
+ */
+class GLRF::RenderQueue {
+public:
+	static const unsigned int FRAMEBUFFER_BITS = 6;
+	static const unsigned int PROGRAM_BITS = 10;
+	static const unsigned int MATERIAL_BITS = 12;
+	static const unsigned int MESH_BITS = 12;
+	static const unsigned int DEPTH_BITS = 23;
+
+	RenderQueue();
+	~RenderQueue();
+
+	/**
+	 * @brief Creates the sort key of a draw.
+	 *
+	 * @param framebuffer the rank of the target framebuffer (lower ranks are drawn first)
+	 * @param translucent whether the draw must be blended back-to-front
+	 * @param program the identifier of the shader program
+	 * @param material the identifier of the material
+	 * @param mesh the identifier of the mesh
+	 * @param depth the non-negative distance of the draw to the camera
+	 * @return uint64_t the key
+	 */
+	static uint64_t createKey(uint32_t framebuffer, bool translucent, uint32_t program, uint32_t material, uint32_t mesh, float depth);
+
+	/**
+	 * @brief Removes all draws.
+	 *
+	 */
+	void clear();
+
+	/**
+	 * @brief Adds a draw.
+	 *
+	 * @param key the sort key (see createKey)
+	 * @param index the index of the data of the draw
+	 */
+	void push(uint64_t key, uint32_t index);
+
+	/**
+	 * @brief Sorts all draws by their keys with a stable radix sort.
+	 *
+	 * Bytes that are equal in all keys are skipped.
+	 */
+	void sort();
+
+	size_t size();
+	const std::vector<RenderQueueItem>& getItems();
+private:
+	std::vector<RenderQueueItem> items;
+	std::vector<RenderQueueItem> scratch;
+
+	static uint32_t quantizeDepth(float depth);
+};
@@ -2,6 +2,8 @@
 #include <vector>
 #include <algorithm>
 #include <memory>
+#include <limits>
+#include <unordered_map>
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -13,6 +15,19 @@
 #include <GLRF/SceneObject.hpp>
 #include <GLRF/SceneLight.hpp>
 #include <GLRF/VectorMath.hpp>
+#include <GLRF/UniformBuffer.hpp>
+#include <GLRF/UniformBlocks.hpp>
+#include <GLRF/DrawDataBuffer.hpp>
+#include <GLRF/RenderQueue.hpp>
+#include <GLRF/InstanceBuffer.hpp>
+#include <GLRF/IndirectDrawBuffer.hpp>
+#include <GLRF/RenderBundle.hpp>
+#include <GLRF/Frustum.hpp>
+#include <GLRF/SpatialIndex.hpp>
+#include <GLRF/BoundingVolumeHierarchy.hpp>
+#include <GLRF/SpatialHashGrid.hpp>
+#include <GLRF/OcclusionCuller.hpp>
+#include <GLRF/OcclusionQueries.hpp>
 
 namespace GLRF {
 	class Scene;
@@ -21,6 +36,17 @@ namespace GLRF {
 /**
  * @brief A 3d space can contain objects, lights and cameras.
  * 
+ * A frame is drawn in these steps:
+ * 1. Camera and light data are uploaded into the 'SceneData' uniform block (see SceneUniformBlock).
+ * 2. Bundles whose nodes changed are recorded again (see createBundle).
+ * 3. The other nodes are culled against the view frustum (see queryNodes) and occluders (see setOcclusionCulling),
+ *    nodes without bounds are always drawn.
+ * 4. The values of all draws are computed by the WorkerPool and sorted by framebuffer, program, material and mesh,
+ *    translucent draws back-to-front (see RenderQueue), then uploaded at once (see DrawDataBuffer).
+ * 5. Consecutive draws of one mesh are merged into instanced draws (see InstanceData), indexed meshes whose shader reads
+ *    the 'DrawDataArray' block are issued through glMultiDrawElementsIndirect (see IndirectDrawBuffer).
+ * 6. The draws of bundles are replayed, then the draws of the frame are submitted.
+ * 7. The boxes of nodes that use occlusion queries are tested for the next frames (see setOcclusionQueries).
  */
 class GLRF::Scene {
 public:
@@ -37,6 +63,7 @@ public:
 	 * A default camera will be created and set as active.
 	 */
 	Scene();
+	~Scene();
 
 	/**
 	 * @brief Adds an object to the scene.
@@ -48,6 +75,7 @@ public:
 		static_assert(std::is_base_of<SceneObject, T>::value, "T must extend SceneObject");
 		std::shared_ptr<SceneNode<SceneObject>> node(new SceneNode<SceneObject>(object));
 		this->objectNodes.push_back(node);
+		registerNode(node);
 		return node;
 	}
 
@@ -82,9 +110,99 @@ public:
 	void setActiveCamera(std::shared_ptr<Camera> camera);
 
 	/**
-	 * @brief Draws all objects of the scene with the given shader.
+	 * @brief Moves object nodes of the scene into a RenderBundle, which is only recorded again when one of them changes.
 	 * 
-	 * @param shader the shader to draw the scenes objects with
+	 * Nodes that were not added to the scene are only drawn while the bundle exists, nodes that already belong to a bundle
+	 * (or appear more than once) are skipped, so every node is drawn once.
+	 * 
+	 * @param nodes the nodes that will be drawn by the bundle instead of being resolved every frame
+	 * @return std::shared_ptr<RenderBundle> the bundle, which is drawn before all other objects
+	 * 
+	 * @throws std::invalid_argument if a node is drawn by another scene
+	 */
+	std::shared_ptr<RenderBundle> createBundle(const std::vector<std::shared_ptr<SceneNode<SceneObject>>> & nodes);
+
+	/**
+	 * @brief Removes a bundle, the nodes that it took from the scene are resolved every frame again.
+	 * 
+	 */
+	void removeBundle(std::shared_ptr<RenderBundle> bundle);
+
+	/**
+	 * @brief Enables or disables frustum culling (enabled by default).
+	 * 
+	 */
+	void setFrustumCulling(bool enabled);
+
+	/**
+	 * @brief Enables or disables occlusion culling (disabled by default).
+	 * 
+	 * Every frame, the occluders among the visible nodes (see SceneNode::setOccluder) are rasterized by an
+	 * OcclusionCuller and the other visible nodes are only drawn if their boxes are not hidden behind them.
+	 * The nodes of bundles are not culled, but their occluders hide the other nodes like all occluders.
+	 */
+	void setOcclusionCulling(bool enabled);
+
+	/**
+	 * @brief Returns the culled counts and the cost of the occlusion culling of the last frame.
+	 * 
+	 */
+	const OcclusionCuller::Statistics & getOcclusionStatistics();
+
+	/**
+	 * @brief Enables or disables hardware occlusion queries (disabled by default).
+	 * 
+	 * The boxes of the nodes that use queries (see SceneNode::setOcclusionQuery) are tested against the depth buffers
+	 * after the draws of each frame by OcclusionQueries. Nodes found hidden are skipped, while a query is pending their
+	 * draws are rendered conditionally, so the GPU drops them if the box was hidden. The nodes of bundles are not queried.
+	 */
+	void setOcclusionQueries(bool enabled);
+
+	/**
+	 * @brief Returns the requested, issued and occluded counts of the occlusion queries of the last frame.
+	 * 
+	 */
+	const OcclusionQueries::Statistics & getOcclusionQueryStatistics();
+
+	/**
+	 * @brief Replaces the spatial index of the object nodes (a BoundingVolumeHierarchy by default) and inserts all nodes.
+	 * 
+	 * A SpatialHashGrid suits scenes in which most nodes move every frame, as its updates do not depend on the number
+	 * of nodes, while the hierarchy answers queries faster if the nodes differ a lot in size or rarely move.
+	 */
+	void setSpatialIndex(std::unique_ptr<SpatialIndex> index);
+
+	/**
+	 * @brief Returns the object nodes whose bounds intersect a frustum.
+	 * 
+	 * All spatial queries are answered by the spatial index over the world-space boxes of the object nodes
+	 * (see setSpatialIndex), which is updated with the nodes that moved (or whose objects changed their bounds)
+	 * since the last query.
+	 * Nodes without bounds are never returned, the nodes of bundles are returned like all other nodes.
+	 */
+	std::vector<std::shared_ptr<SceneNode<SceneObject>>> queryNodes(const Frustum & frustum);
+
+	/**
+	 * @brief Returns the object nodes whose bounds intersect a sphere (see queryNodes).
+	 * 
+	 */
+	std::vector<std::shared_ptr<SceneNode<SceneObject>>> queryNodes(const BoundingSphere & sphere);
+
+	/**
+	 * @brief Returns the object nodes whose bounds are hit by a ray, in no particular order (see queryNodes).
+	 * 
+	 * @param origin the origin of the ray
+	 * @param direction the direction of the ray
+	 * @param max_distance the length of the ray in multiples of the direction
+	 */
+	std::vector<std::shared_ptr<SceneNode<SceneObject>>> raycast(const glm::vec3 & origin, const glm::vec3 & direction,
+		float max_distance);
+
+	/**
+	 * @brief Draws all objects of the scene with the given shader configuration (see the class description for the steps).
+	 * 
+	 * @param configuration the scene-wide shader configuration (a 'projection' matrix is forwarded into the 'SceneData' block)
+	 * @param map_shader_fbs the framebuffers that the objects of each shader are drawn into
 	 */
 	void draw(ShaderConfiguration * configuration, std::map<GLuint, FrameBuffer*> & map_shader_fbs);
 
@@ -103,9 +221,159 @@ public:
 	 */
 	void processMouse(float xOffset, float yOffset);
 private:
+	static constexpr size_t MIN_NODES_PER_RANGE = 256;
+
+	/**
+	 * @brief A registered object node with the values that drawing it needs besides its RenderItem.
+	 *
+	 * Draws read the slots and the render items of the scene, which are only refreshed when an object reports a change
+	 * (see SceneObject::trackChanges), instead of asking the objects every frame.
+	 */
+	struct NodeSlot {
+		std::shared_ptr<SceneNode<SceneObject>> node;
+		SceneObject * object = nullptr;
+		std::shared_ptr<Material> material;
+		RenderBundle * bundle = nullptr;
+		int32_t proxy = SpatialIndex::NULL_PROXY;
+		bool has_item = false;
+	};
+
 	std::vector<std::shared_ptr<SceneNode<SceneObject>>> objectNodes;
 	std::vector<std::shared_ptr<SceneNode<PointLight>>> pointLights;
 	std::vector<std::shared_ptr<SceneNode<DirectionalLight>>> directionalLights;
 	std::vector<std::shared_ptr<Camera>> cameras;
 	std::shared_ptr<Camera> activeCamera;
+	std::unique_ptr<UniformBuffer> scene_uniform_buffer;
+	ShaderConfiguration object_configuration;
+	DrawList frame_draws;
+	Frustum frustum;
+	bool frustum_culling = true;
+	bool occlusion_culling = false;
+	OcclusionCuller occlusion_culler;
+	bool occlusion_queries_enabled = false;
+	OcclusionQueries occlusion_queries;
+	std::vector<BoundingBox> occludee_boxes;
+	std::vector<uint8_t> occludee_visible;
+	std::unique_ptr<SpatialIndex> spatial_index = std::unique_ptr<SpatialIndex>(new BoundingVolumeHierarchy());
+	std::vector<NodeSlot> node_slots;
+	std::vector<RenderItem> render_items;
+	std::vector<uint32_t> free_slots;
+	std::vector<uint32_t> proxy_slots;
+	std::unordered_multimap<SceneObject*, uint32_t> object_slots;
+	std::vector<uint32_t> unbounded_slots;
+	std::vector<SceneNode<SceneObject>*> moved_nodes;
+	std::vector<SceneObject*> changed_objects;
+	uint64_t geometry_generation = 0;
+	std::vector<int32_t> visible_proxies;
+	std::vector<uint32_t> visible_slots;
+	std::vector<uint32_t> unoccluded_slots;
+	std::vector<uint32_t> dynamic_slots;
+	std::vector<uint32_t> occluder_slots;
+	std::vector<std::shared_ptr<RenderBundle>> bundles;
+	std::vector<UniformId> point_light_uniform_ids;
+
+	/**
+	 * @brief Uploads the camera and light data of this frame into the 'SceneData' uniform block.
+	 * 
+	 * @param projection the projection matrix of this frame
+	 */
+	void updateSceneUniforms(const glm::mat4 & projection);
+
+	/**
+	 * @brief Writes the camera and light data as individual uniforms for shaders without the 'SceneData' block.
+	 * 
+	 * @param configuration the configuration to write the uniforms into
+	 */
+	void writeLegacySceneUniforms(ShaderConfiguration * configuration);
+
+	/**
+	 * @brief Assigns a slot to an object node, creates its RenderItem and inserts it into the spatial index.
+	 * 
+	 * @param node the node to register
+	 * @param bundle the bundle that draws the node, or nullptr if the node is drawn every frame
+	 */
+	void registerNode(const std::shared_ptr<SceneNode<SceneObject>> & node, RenderBundle * bundle = nullptr);
+
+	/**
+	 * @brief Removes the node of a slot from the spatial index and frees the slot.
+	 * 
+	 */
+	void unregisterNode(uint32_t slot);
+
+	/**
+	 * @brief Inserts the node of a slot into the spatial index, or into the list of unbounded nodes if its object has no bounds
+	 * and it is not drawn by a bundle.
+	 * 
+	 */
+	void insertProxy(uint32_t slot);
+
+	void removeProxy(uint32_t slot);
+
+	/**
+	 * @brief Creates the RenderItem of a slot again from its object.
+	 * 
+	 */
+	void refreshSlot(uint32_t slot);
+
+	/**
+	 * @brief Refreshes the slots of all objects that changed and moves the proxies of all nodes that moved
+	 * or whose objects changed their bounds since the last update.
+	 * 
+	 */
+	void processChanges();
+
+	std::vector<std::shared_ptr<SceneNode<SceneObject>>> getProxyNodes(const std::vector<int32_t> & proxies);
+
+	/**
+	 * @brief Rasterizes the occluders and keeps the nodes that may be visible.
+	 * 
+	 * @param occluder_slots the slots of the occluders that passed the frustum culling, including the nodes of bundles
+	 * @param slots the slots of the nodes of this frame that passed the frustum culling
+	 * @param view_projection the product of the projection and the view matrix of this frame
+	 * @param visible_slots receives the occluders, the nodes without bounds and the nodes that are not hidden
+	 */
+	void cullOccluded(const std::vector<uint32_t> & occluder_slots, const std::vector<uint32_t> & slots,
+		const glm::mat4 & view_projection, std::vector<uint32_t> & visible_slots);
+
+	/**
+	 * @brief Adds the draws of object nodes to the queue of a list.
+	 * 
+	 * The matrices and the indirect draws are computed by the WorkerPool, the programs are resolved on the calling thread.
+	 * 
+	 * @param list the list that receives the draws
+	 * @param slots the slots of the nodes to draw
+	 * @param map_shader_fbs the framebuffers that the objects of each shader are drawn into
+	 * @param translucent_slots if not nullptr, receives the slots of the translucent nodes instead of the list
+	 * @param frustum if not nullptr, the draws of nodes outside of it are skipped
+	 * @param queries if not nullptr, the nodes that use occlusion queries are requested and skipped or conditioned
+	 */
+	void collectDraws(DrawList & list, const std::vector<uint32_t> & slots, std::map<GLuint, FrameBuffer*> & map_shader_fbs,
+		std::vector<uint32_t> * translucent_slots, const Frustum * frustum, OcclusionQueries * queries);
+
+	/**
+	 * @brief Sorts the queue of a list and uploads the values of all its draws.
+	 * 
+	 */
+	void prepareDraws(DrawList & list);
+
+	/**
+	 * @brief Issues the draws of a prepared list.
+	 * 
+	 */
+	void submitDraws(DrawList & list, ShaderConfiguration * configuration);
+
+	/**
+	 * @brief Configures the material and the program of a draw with a RenderItem.
+	 * 
+	 */
+	void useRenderItem(const DrawList::PendingDraw & pending_draw, ShaderConfiguration * configuration);
+
+	/**
+	 * @brief Writes the command of an indirect draw, merging it into the batch of the previous draw if possible.
+	 * 
+	 * @param list the list that the draw belongs to
+	 * @param queue_index the index of the draw inside the sorted queue
+	 * @param draw_index the index of the values of the draw inside the 'DrawDataArray' storage block
+	 */
+	void addIndirectDraw(DrawList & list, size_t queue_index, size_t draw_index);
 };
\ No newline at end of file
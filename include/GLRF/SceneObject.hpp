@@ -10,9 +10,16 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <GLRF/VertexFormat.hpp>
+#include <GLRF/DirtyRanges.hpp>
+#include <GLRF/Bounds.hpp>
 #include <GLRF/Material.hpp>
 #include <GLRF/IdManager.hpp>
 #include <GLRF/Shader.hpp>
+#include <GLRF/GeometryPool.hpp>
+#include <GLRF/RenderItem.hpp>
+#include <GLRF/OcclusionCuller.hpp>
+#include <GLRF/StreamingBuffer.hpp>
+#include <cstring>
 
 namespace GLRF {
 	template <typename T> class MeshData;
@@ -43,6 +50,35 @@ public:
 
 	std::vector<T> vertices;
 	std::optional<std::vector<GLuint>> indices = std::nullopt;
+
+	/**
+	 * @brief Marks vertices that were changed in place, so that SceneMesh::updateDirtyRanges only uploads them.
+	 * 
+	 * @param first the index of the first changed vertex
+	 * @param count the number of changed vertices
+	 */
+	void markVerticesDirty(size_t first, size_t count) {
+		this->dirty_vertices.mark(first, count);
+	}
+
+	/**
+	 * @brief Marks indices that were changed in place, so that SceneMesh::updateDirtyRanges only uploads them.
+	 * 
+	 * @param first the position of the first changed index
+	 * @param count the number of changed indices
+	 */
+	void markIndicesDirty(size_t first, size_t count) {
+		this->dirty_indices.mark(first, count);
+	}
+
+	const DirtyRanges & getDirtyVertices() const { return this->dirty_vertices; }
+	const DirtyRanges & getDirtyIndices() const { return this->dirty_indices; }
+
+	void clearDirtyRanges() {
+		this->dirty_vertices.clear();
+		this->dirty_indices.clear();
+	}
+
 	void unionize(MeshData<T>& other) {
 		size_t current_vertices_size = this->vertices.size();
 		size_t current_indices_size = this->indices.value().size();
@@ -64,6 +100,8 @@ public:
 		}
 	}
 private:
+	DirtyRanges dirty_vertices;
+	DirtyRanges dirty_indices;
 };
 
 /**
@@ -87,6 +125,7 @@ public:
 	void setShaderID(GLuint ID)
 	{
 		this->ID = ID;
+		markChanged();
 	}
 
 	GLuint getShaderID()
@@ -94,14 +133,32 @@ public:
 		return this->ID;
 	}
 
+	/**
+	 * @brief Returns the unique identifier of this object, which the Scene sorts the draws of a program and material by.
+	 * 
+	 */
+	IdSpaceSize getObjectID()
+	{
+		return this->object_id;
+	}
+
+	/**
+	 * @brief Returns the shader program that draws this object, which is a variant of the assigned shader
+	 * that is specialized for the material of this object if available (see ShaderManager::getMaterialVariant).
+	 * 
+	 */
+	GLuint getProgramID()
+	{
+		return ShaderManager::getInstance().getMaterialVariant(this->ID, getMaterial().get());
+	}
 
 	void configureShader(ShaderConfiguration* scene_configuration, ShaderConfiguration* object_configuration)
 	{
-		GLuint shader_id = this->getShaderID();
+		GLuint shader_id = this->getProgramID();
 		ShaderManager& shader_manager = ShaderManager::getInstance();
 		shader_manager.useShader(shader_id);
-		shader_manager.configureShader(scene_configuration, shader_id, false);
-		shader_manager.configureShader(object_configuration, shader_id, true);
+		shader_manager.configureShader(scene_configuration, shader_id);
+		shader_manager.configureShader(object_configuration, shader_id);
 	}
 
 	/**
@@ -110,6 +167,45 @@ public:
 	 */
 	virtual void draw(ShaderConfiguration* scene_configuration, ShaderConfiguration* object_configuration) = 0;
 
+	/**
+	 * @brief Returns whether the object can be drawn many times with a single instanced draw.
+	 * 
+	 */
+	virtual bool supportsInstancing() { return false; }
+
+	/**
+	 * @brief Draws consecutive instances of the object with the current shader, which must use instancing.
+	 * 
+	 * @param instances the buffer that holds the instances of the current frame
+	 * @param first_instance the index of the first instance inside the current frame
+	 * @param instance_count the number of instances
+	 */
+	virtual void drawInstanced(ShaderConfiguration*, ShaderConfiguration*, InstanceBuffer*, size_t, GLsizei)
+	{
+		throw std::logic_error("object does not support instancing");
+	}
+
+	/**
+	 * @brief Describes the object as a RenderItem, which the Scene draws without calling draw or drawInstanced.
+	 * 
+	 * The Scene asks for the item once when a node of the object is added and again after the object changed
+	 * (see trackChanges), so the item must only depend on values whose changes are reported.
+	 * 
+	 * @param item the item that will be filled
+	 * @return true if the object can be drawn as an item
+	 * @return false if the Scene has to call draw or drawInstanced
+	 */
+	virtual bool getRenderItem(RenderItem *) { return false; }
+
+	/**
+	 * @brief Describes the triangles that the OcclusionCuller rasterizes if a node of the object is an occluder.
+	 * 
+	 * @param geometry the geometry that will be filled, its data must stay valid until the Scene was drawn
+	 * @return true if the object has triangles
+	 * @return false if the object can not occlude anything
+	 */
+	virtual bool getOccluderGeometry(OccluderGeometry *) { return false; }
+
 	/**
 	 * @brief Returns the Material object.
 	 * 
@@ -122,11 +218,95 @@ public:
 	 * 
 	 * @param material the new material for the object
 	 */
-	virtual void setMaterial(std::shared_ptr<Material> material) { this->material = material; }
+	virtual void setMaterial(std::shared_ptr<Material> material) { this->material = material; markChanged(); }
+
+	/**
+	 * @brief Returns whether the object has bounds, objects without bounds are never culled.
+	 * 
+	 */
+	bool hasBounds() { return this->has_bounds; }
+
+	/**
+	 * @brief Returns the bounds of the object in its local coordinate system.
+	 * 
+	 */
+	const Bounds & getBounds() { return this->bounds; }
+
+	/**
+	 * @brief Lets the object append itself to a list when it or its bounds change, every Scene that draws the object
+	 * subscribes a list of its own to update its spatial index and the render items of the object.
+	 * 
+	 * @param changed_objects the list, which receives the object at most once until clearChanged is called for it
+	 */
+	void trackChanges(std::vector<SceneObject*> * changed_objects)
+	{
+		this->change_trackers.push_back({ changed_objects, false });
+	}
+
+	/**
+	 * @brief Stops appending the object to a list.
+	 * 
+	 */
+	void untrackChanges(std::vector<SceneObject*> * changed_objects)
+	{
+		auto it = std::find_if(this->change_trackers.begin(), this->change_trackers.end(),
+			[changed_objects](const ChangeTracker & tracker) { return tracker.changed_objects == changed_objects; });
+		if (it != this->change_trackers.end()) this->change_trackers.erase(it);
+	}
+
+	/**
+	 * @brief Allows the object to append itself to a list again.
+	 * 
+	 */
+	void clearChanged(std::vector<SceneObject*> * changed_objects)
+	{
+		for (ChangeTracker & tracker : this->change_trackers) {
+			if (tracker.changed_objects == changed_objects) tracker.changed = false;
+		}
+	}
+
+protected:
+	/**
+	 * @brief Appends the object to all tracking lists, whenever the way it is drawn changes (e.g. its shader, material or data).
+	 * 
+	 */
+	void markChanged()
+	{
+		for (ChangeTracker & tracker : this->change_trackers) {
+			if (tracker.changed) continue;
+			tracker.changed = true;
+			tracker.changed_objects->push_back(this);
+		}
+	}
+
+	/**
+	 * @brief Sets the bounds of the object, which only marks it as changed if they differ from the previous bounds.
+	 * 
+	 */
+	void setBounds(const Bounds & bounds)
+	{
+		if (this->has_bounds && this->bounds == bounds) return;
+		this->bounds = bounds;
+		this->has_bounds = true;
+		markChanged();
+	}
 
 private:
+	/**
+	 * @brief A list that the object appends itself to, and whether it is already in there.
+	 * 
+	 */
+	struct ChangeTracker {
+		std::vector<SceneObject*> * changed_objects;
+		bool changed;
+	};
+
 	std::shared_ptr<Material> material;
+	Bounds bounds;
+	bool has_bounds = false;
+	std::vector<ChangeTracker> change_trackers;
 	GLuint ID = 0;
+	IdSpaceSize object_id = IdManager::getInstance().getObjectId();
 	std::string debug_name = "MISSING_NAME";
 };
 
@@ -146,45 +326,29 @@ public:
 	 * 
 	 * @param vertices the vertices that define the structure of the mesh
 	 * @param drawType the OpenGL draw type that specifies how the mesh will be rendered - e.g. GL_STATIC_DRAW
+	 * (the data is stored in the shared buffers of the GeometryPool, GL_STREAM_DRAW meshes are written into the StreamingBuffer)
 	 * @param material the material that defines the appearance of the mesh
 	 */
 	SceneMesh(std::shared_ptr<MeshData<T>> data, GLenum draw_type, GLenum geometry_type = GL_TRIANGLES,
 		std::shared_ptr<Material> material = std::shared_ptr<Material>(new Material()))
 	{
-		glGenVertexArrays(1, &VAO);
-		glGenBuffers(1, &VBO);
-		glGenBuffers(1, &EBO);
-
 		this->draw_type = draw_type;
 		this->geometry_type = geometry_type;
 		this->data = data;
 		setMaterial(material);
-
-		glBindVertexArray(VAO);
-
-		glBindBuffer(GL_ARRAY_BUFFER, VBO);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(T) * this->data->vertices.size(), &this->data->vertices[0], draw_type);
-
-		if (this->data->indices.has_value()) {
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-			glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * this->data->indices.value().size(), &this->data->indices.value()[0], draw_type);
-		}
-
-		vertex_format_t::registerFormat();
-
-		glBindVertexArray(0);
+		upload();
 	}
 
 	~SceneMesh()
 	{
-		glDeleteVertexArrays(1, &VAO);
-		glDeleteBuffers(1, &VBO);
-		glDeleteBuffers(1, &EBO);
+		GeometryPool<T>::getInstance().free(this->geometry);
 	}
 
 	/**
 	 * @brief Updates the vertex data and the draw type of the mesh.
 	 * 
+	 * The data is written into the ranges of the mesh inside the GeometryPool, which are only replaced if the data does not fit.
+	 * 
 	 * @param vertices the new vertices that will replace the old vertices
 	 * @param drawType the new value for the OpenGL draw type
 	 */
@@ -193,19 +357,9 @@ public:
 		this->data = data;
 		this->draw_type = draw_type;
 		this->geometry_type = geometry_type;
-
-		glBindVertexArray(VAO);
-
-		glBindBuffer(GL_ARRAY_BUFFER, VBO);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(T) * this->data->vertices.size(), NULL, draw_type);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(T) * this->data->vertices.size(), this->data->vertices.data(), draw_type);
-
-		bool has_indices = data->indices.has_value();
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, has_indices ? sizeof(GLuint) * this->data->indices.value().size() : 0,
-			has_indices ? &this->data->indices.value()[0] : NULL, draw_type);
-
-		glBindVertexArray(0);
+		upload();
+		this->data->clearDirtyRanges();
+		markChanged();
 	}
 
 	/**
@@ -218,47 +372,291 @@ public:
 		SceneMesh::update(data, this->draw_type, this->geometry_type);
 	}
 
+	/**
+	 * @brief Uploads only the vertices and indices that were marked as dirty in the data of the mesh and clears the marks.
+	 * 
+	 * The ranges of the mesh inside the GeometryPool are only replaced (with a full upload) if the data grew beyond them.
+	 * Streamed meshes are written completely, as they are written into new memory every frame anyway.
+	 * The bounds grow with the dirty vertices and are only computed from all vertices if the mesh lost vertices.
+	 * The mesh is only marked as changed if its counts, its ranges or its bounds changed.
+	 */
+	void updateDirtyRanges()
+	{
+		GeometryPool<T> & pool = GeometryPool<T>::getInstance();
+		size_t vertex_count = this->data->vertices.size();
+		size_t index_count = this->data->indices.has_value() ? this->data->indices.value().size() : 0;
+		bool counts_changed = vertex_count != this->vertex_count || index_count != this->index_count;
+		bool fits = this->geometry.isValid() && vertex_count <= pool.getVertexCapacity(this->geometry)
+			&& index_count <= pool.getIndexCapacity(this->geometry) && (index_count > 0) == this->geometry.hasIndices();
+		if (this->streaming || !fits) {
+			GeometryAllocation previous = this->geometry;
+			upload();
+			this->data->clearDirtyRanges();
+			if (counts_changed || this->geometry != previous) markChanged();
+			return;
+		}
+
+		// removed vertices might have defined the bounds, so only a full computation can shrink them
+		if (vertex_count < this->vertex_count) updateBounds();
+		else updateDirtyBounds();
+
+		for (const DirtyRanges::Range & range : this->data->getDirtyVertices().getRanges()) {
+			if (range.first >= vertex_count) break;
+			size_t count = std::min(range.count, vertex_count - range.first);
+			pool.uploadVertices(this->geometry, range.first, &this->data->vertices[range.first], count);
+		}
+		for (const DirtyRanges::Range & range : this->data->getDirtyIndices().getRanges()) {
+			if (range.first >= index_count) break;
+			size_t count = std::min(range.count, index_count - range.first);
+			pool.uploadIndices(this->geometry, range.first, &this->data->indices.value()[range.first], count);
+		}
+		this->vertex_count = vertex_count;
+		this->index_count = index_count;
+		this->data->clearDirtyRanges();
+		if (counts_changed) markChanged();
+	}
+
 	/**
 	 * @brief Draws the mesh with the current shader.
 	 * 
 	 */
 	void draw(ShaderConfiguration* scene_configuration, ShaderConfiguration* object_configuration)
 	{
-		object_configuration->setMaterial("material", getMaterial());
+		static const UniformId material_id = UniformRegistry::getInstance().intern("material");
+		object_configuration->setMaterial(material_id, getMaterial());
 		configureShader(scene_configuration, object_configuration);
 
-		glBindVertexArray(VAO);
+		if (!hasGeometry()) return;
+		void * index_offset;
+		GLint base_vertex = bindGeometry(&index_offset);
+		applyRasterState();
 
-		switch (this->geometry_type)
-		{
-		case GL_POINTS:
-			glPointSize(8.f);
-			break;
-		case GL_LINES:
-		case GL_LINE_STRIP:
-		case GL_LINES_ADJACENCY:
-		case GL_LINE_STRIP_ADJACENCY:
-			glLineWidth(3.f);
-			break;
-		default:
-			break;
+		if (hasIndices()) {
+			glDrawElementsBaseVertex(this->geometry_type, static_cast<GLsizei>(data->indices.value().size()), GL_UNSIGNED_INT,
+				index_offset, base_vertex);
+		}
+		else {
+			glDrawArrays(this->geometry_type, base_vertex, static_cast<GLsizei>(data->vertices.size()));
 		}
+	}
+
+	bool supportsInstancing()
+	{
+		return GLCapabilities::getInstance().base_instance;
+	}
 
-		if (data->indices.has_value()) {
-			glDrawElements(this->geometry_type, static_cast<GLsizei>(data->indices.value().size()), GL_UNSIGNED_INT, 0);
+	/**
+	 * @brief Draws consecutive instances of the mesh with the current shader, which must use instancing.
+	 * 
+	 */
+	void drawInstanced(ShaderConfiguration* scene_configuration, ShaderConfiguration* object_configuration,
+		InstanceBuffer * instances, size_t first_instance, GLsizei instance_count)
+	{
+		static const UniformId material_id = UniformRegistry::getInstance().intern("material");
+		object_configuration->setMaterial(material_id, getMaterial());
+		configureShader(scene_configuration, object_configuration);
+
+		if (!hasGeometry()) return;
+		GeometryPool<T>::getInstance().attachInstanceBuffer(this->geometry, instances);
+		void * index_offset;
+		GLint base_vertex = bindGeometry(&index_offset);
+		applyRasterState();
+
+		GLuint base_instance = instances->getBaseInstance(first_instance);
+		if (hasIndices()) {
+			glDrawElementsInstancedBaseVertexBaseInstance(this->geometry_type, static_cast<GLsizei>(data->indices.value().size()),
+				GL_UNSIGNED_INT, index_offset, instance_count, base_vertex, base_instance);
 		}
 		else {
-			glDrawArrays(this->geometry_type, 0, static_cast<GLsizei>(data->vertices.size()));
+			glDrawArraysInstancedBaseInstance(this->geometry_type, base_vertex,
+				static_cast<GLsizei>(data->vertices.size()), instance_count, base_instance);
 		}
+	}
 
-		glBindVertexArray(0);
+	/**
+	 * @brief Describes the mesh as a RenderItem, streamed meshes are written every frame and are drawn by the mesh instead.
+	 * 
+	 */
+	bool getRenderItem(RenderItem * item)
+	{
+		if (this->streaming || !this->geometry.isValid()) return false;
+		GeometryPool<T> & pool = GeometryPool<T>::getInstance();
+		item->format = this->format_id;
+		item->mode = this->geometry_type;
+		item->geometry = this->geometry;
+		item->vertex_buffer = pool.getVertexBuffer(this->geometry);
+		item->base_vertex = pool.getBaseVertex(this->geometry);
+		item->first_index = this->geometry.hasIndices() ? pool.getFirstIndex(this->geometry) : 0;
+		item->count = static_cast<GLuint>(this->geometry.hasIndices() ? this->data->indices.value().size() : this->data->vertices.size());
+		item->shader_id = getShaderID();
+		item->material = getMaterial().get();
+		item->material_index = item->material ? static_cast<GLuint>(item->material->getID()) : 0;
+		return true;
+	}
+
+	/**
+	 * @brief Describes the vertices of the mesh as occluder, only triangle meshes with positions can occlude.
+	 * 
+	 */
+	bool getOccluderGeometry(OccluderGeometry * geometry)
+	{
+		if constexpr (HasPosition<T>::value) {
+			if (this->geometry_type != GL_TRIANGLES || this->data->vertices.empty()) return false;
+			geometry->positions = &this->data->vertices[0].position;
+			geometry->vertex_count = this->data->vertices.size();
+			geometry->stride = sizeof(T);
+			bool indexed = this->data->indices.has_value() && !this->data->indices.value().empty();
+			geometry->indices = indexed ? this->data->indices.value().data() : nullptr;
+			geometry->index_count = indexed ? this->data->indices.value().size() : 0;
+			return true;
+		} else {
+			return false;
+		}
 	}
 
 private:
-	GLuint VBO, VAO, EBO;
+	const GLuint format_id = RenderItemFormats::getInstance().getFormatID<T>();
 	GLenum draw_type;
 	GLenum geometry_type;
 	std::shared_ptr<MeshData<T>> data;
+	GeometryAllocation geometry;
+	size_t vertex_count = 0;
+	size_t index_count = 0;
+	bool streaming = false;
+	StreamingAllocation stream;
+	GLintptr stream_index_offset = 0;
+	uint64_t stream_frame = 0;
+
+	void applyRasterState()
+	{
+		RenderItem::applyRasterState(this->geometry_type);
+	}
+
+	/**
+	 * @brief Writes the data of the mesh into the GeometryPool, its ranges are only replaced if the data does not fit.
+	 * 
+	 * Meshes with the draw type GL_STREAM_DRAW write their data into the StreamingBuffer instead, if it is available.
+	 */
+	void upload()
+	{
+		GeometryPool<T> & pool = GeometryPool<T>::getInstance();
+		uint64_t vertex_count = this->data->vertices.size();
+		uint64_t index_count = this->data->indices.has_value() ? this->data->indices.value().size() : 0;
+		updateBounds();
+		this->vertex_count = static_cast<size_t>(vertex_count);
+		this->index_count = static_cast<size_t>(index_count);
+
+		this->streaming = this->draw_type == GL_STREAM_DRAW && GeometryPool<T>::supportsStreaming();
+		if (this->streaming) {
+			pool.free(this->geometry);
+			writeStream();
+			return;
+		}
+
+		bool fits = this->geometry.isValid() && vertex_count <= pool.getVertexCapacity(this->geometry)
+			&& index_count <= pool.getIndexCapacity(this->geometry) && (index_count > 0) == this->geometry.hasIndices();
+		if (!fits) {
+			pool.free(this->geometry);
+			this->geometry = pool.allocate(vertex_count, index_count);
+		}
+		pool.upload(this->geometry, this->data->vertices.data(), vertex_count,
+			index_count > 0 ? this->data->indices.value().data() : NULL, index_count);
+	}
+
+	/**
+	 * @brief Computes the bounds of the vertices, vertex formats without a position are never culled.
+	 * 
+	 */
+	void updateBounds()
+	{
+		if constexpr (HasPosition<T>::value) setBounds(computeBounds(this->data->vertices));
+	}
+
+	/**
+	 * @brief Grows the bounds until they enclose the dirty vertices, the bounds of a mesh without vertices start at the first range.
+	 * 
+	 */
+	void updateDirtyBounds()
+	{
+		if constexpr (HasPosition<T>::value) {
+			const std::vector<T> & vertices = this->data->vertices;
+			Bounds bounds = getBounds();
+			bool empty = this->vertex_count == 0;
+			for (const DirtyRanges::Range & range : this->data->getDirtyVertices().getRanges()) {
+				if (range.first >= vertices.size()) break;
+				size_t count = std::min(range.count, vertices.size() - range.first);
+				if (empty) bounds = computeBounds(&vertices[range.first].position, count, sizeof(T));
+				else growBounds(&bounds, &vertices[range.first].position, count, sizeof(T));
+				empty = false;
+			}
+			setBounds(bounds);
+		}
+	}
+
+	/**
+	 * @brief Copies the data of the mesh into mapped memory of the current frame.
+	 * 
+	 * The vertices and indices share one allocation, so that they are always in the same buffer.
+	 */
+	void writeStream()
+	{
+		StreamingBuffer & stream_buffer = StreamingBuffer::getInstance();
+		this->stream_frame = stream_buffer.getFrame();
+		if (this->data->vertices.empty()) return;
+
+		GLsizeiptr vertex_size = static_cast<GLsizeiptr>(sizeof(T) * this->data->vertices.size());
+		GLsizeiptr index_size = this->data->indices.has_value()
+			? static_cast<GLsizeiptr>(sizeof(GLuint) * this->data->indices.value().size()) : 0;
+		this->stream_index_offset = ((vertex_size + 15) / 16) * 16;
+		this->stream = stream_buffer.allocate(this->stream_index_offset + index_size);
+
+		unsigned char * memory = static_cast<unsigned char *>(this->stream.data);
+		std::memcpy(memory, this->data->vertices.data(), static_cast<size_t>(vertex_size));
+		if (index_size > 0) {
+			std::memcpy(memory + this->stream_index_offset, this->data->indices.value().data(), static_cast<size_t>(index_size));
+		}
+	}
+
+	bool hasGeometry()
+	{
+		return this->streaming ? !this->data->vertices.empty() : this->geometry.isValid();
+	}
+
+	bool hasIndices()
+	{
+		return this->streaming ? this->data->indices.has_value() && !this->data->indices.value().empty() : this->geometry.hasIndices();
+	}
+
+	/**
+	 * @brief Binds the vertex array that reads the data of the mesh.
+	 * 
+	 * Streamed data is only valid during the frame it was written in, so it is written again if the mesh was not updated.
+	 * 
+	 * @param index_offset the offset of the first index inside the bound element buffer
+	 * @return GLint the base vertex of the mesh
+	 */
+	GLint bindGeometry(void ** index_offset)
+	{
+		GeometryPool<T> & pool = GeometryPool<T>::getInstance();
+		if (this->streaming) {
+			if (this->stream_frame != StreamingBuffer::getInstance().getFrame()) writeStream();
+			pool.bindStreamVertexArray(this->stream.buffer, this->stream.offset);
+			*index_offset = reinterpret_cast<void*>(static_cast<uintptr_t>(this->stream.offset + this->stream_index_offset));
+			return 0;
+		}
+		pool.bindVertexArray(this->geometry);
+		*index_offset = this->geometry.hasIndices() ? getIndexOffset() : NULL;
+		return pool.getBaseVertex(this->geometry);
+	}
+
+	/**
+	 * @brief Returns the offset of the first index inside the index buffer of the chunk.
+	 * 
+	 */
+	void * getIndexOffset()
+	{
+		return reinterpret_cast<void*>(sizeof(GLuint) * static_cast<size_t>(GeometryPool<T>::getInstance().getFirstIndex(this->geometry)));
+	}
 };
 
 /**
@@ -303,6 +701,7 @@ public:
 	 */
 	void setPosition(glm::vec3 position)  {
 		this->position = position;
+		markMoved();
 	}
 
 	/**
@@ -312,6 +711,7 @@ public:
 	 */
 	void setRotation(glm::mat4 rotation)  {
 		this->rotation = rotation;
+		markMoved();
 	}
 
 	/**
@@ -321,6 +721,7 @@ public:
 	 */
 	void move(glm::vec3 offset)  {
 		this->position += offset;
+		markMoved();
 	}
 
 	/**
@@ -331,6 +732,7 @@ public:
 	 */
 	void rotateDeg(glm::vec3 axis, float angle) {
 		this->rotation = glm::rotate(this->rotation, glm::radians(angle), axis);
+		markMoved();
 	}
 
 	/**
@@ -341,6 +743,7 @@ public:
 	 */
 	void rotateRad(glm::vec3 axis, float angle) {
 		this->rotation = glm::rotate(this->rotation, angle, axis);
+		markMoved();
 	}
 
 	/**
@@ -365,8 +768,63 @@ public:
 	glm::mat4 calculateModelMatrix() {
 		return glm::translate(glm::mat4(1.f), this->position) * this->rotation;
 	}
+
+	/**
+	 * @brief Lets the node append itself to a list when it moves, the Scene uses this to update its spatial index.
+	 * 
+	 * A node is tracked by a single scene, which also stores its slot in the node, so it can only be drawn by one scene.
+	 * 
+	 * @param moved_nodes the list, or nullptr to stop tracking
+	 * @param slot the index of the node inside the arrays of the Scene
+	 */
+	void trackMoves(std::vector<SceneNode<T>*> * moved_nodes, uint32_t slot) {
+		this->moved_nodes = moved_nodes;
+		this->slot = slot;
+		this->moved = false;
+	}
+
+	uint32_t getSlot() { return this->slot; }
+
+	bool isTracked() { return this->moved_nodes != nullptr; }
+
+	/**
+	 * @brief Allows the node to append itself to the tracking list again.
+	 * 
+	 */
+	void clearMoved() { this->moved = false; }
+
+	/**
+	 * @brief Marks the node as occluder, whose object hides the nodes behind it if the Scene uses occlusion culling.
+	 * 
+	 * Good occluders are large and simple, e.g. walls, floors and buildings. Occluders are always drawn.
+	 */
+	void setOccluder(bool occluder) { this->occluder = occluder; }
+
+	bool isOccluder() { return this->occluder; }
+
+	/**
+	 * @brief Marks the node to be drawn only if a hardware occlusion query finds its box visible, if the Scene uses them.
+	 * 
+	 * Queries cost a draw of their own and their results arrive a frame late, so they pay off for expensive objects
+	 * that are often hidden, e.g. detailed meshes inside of buildings. The object must have bounds.
+	 */
+	void setOcclusionQuery(bool occlusion_query) { this->occlusion_query = occlusion_query; }
+
+	bool usesOcclusionQuery() { return this->occlusion_query; }
 private:
 	std::shared_ptr<T> object = nullptr;
 	glm::vec3 position = glm::vec3(0.0f);
 	glm::mat4 rotation = glm::mat4(1.0f);
+	std::vector<SceneNode<T>*> * moved_nodes = nullptr;
+	uint32_t slot = 0;
+	bool moved = false;
+	bool occluder = false;
+	bool occlusion_query = false;
+
+	void markMoved() {
+		if (this->moved_nodes && !this->moved) {
+			this->moved = true;
+			this->moved_nodes->push_back(this);
+		}
+	}
 };
\ No newline at end of file
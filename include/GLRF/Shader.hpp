@@ -4,29 +4,174 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <vector>
+#include <algorithm>
 #include <map>
+#include <unordered_map>
 #include <set>
 #include <string>
+#include <optional>
+#include <memory>
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 
 #include <GLRF/Material.hpp>
 #include <GLRF/FrameBuffer.hpp>
+#include <GLRF/UniformBlocks.hpp>
+#include <GLRF/UniformRegistry.hpp>
+#include <GLRF/GLCapabilities.hpp>
+#include <GLRF/GLStateCache.hpp>
+#include <GLRF/InstanceBuffer.hpp>
+#include <GLRF/ShaderBinaryCache.hpp>
 
 namespace GLRF {
 	struct ShaderOptions;
+	struct UniformHandle;
+	struct MaterialPropertyUniformHandles;
+	struct MaterialUniformHandles;
+	struct ShaderBuildRequest;
+	enum class ShaderBuildStatus;
+	struct ShaderBuildResult;
 	class ShaderConfiguration;
 	class Shader;
+	class ShaderBatch;
 	class ShaderManager;
 }
 
+/**
+ * @brief A resolved reference to an active uniform of a specific Shader.
+ * 
+ * Handles are obtained once through Shader::uniform and can then be used to set values without any string lookups.
+ * Handles of uniforms that are not active in the shader are invalid and setting them has no effect.
+ */
+struct GLRF::UniformHandle {
+	GLint location = -1;
+
+	bool isValid() const { return this->location >= 0; }
+};
+
+/**
+ * @brief The resolved uniforms of a single MaterialProperty inside a shader.
+ * 
+ */
+struct GLRF::MaterialPropertyUniformHandles {
+	UniformHandle value_default;
+	UniformHandle use_texture;
+	UniformHandle texture;
+};
+
+/**
+ * @brief The resolved uniforms of a Material inside a shader.
+ * 
+ */
+struct GLRF::MaterialUniformHandles {
+	MaterialPropertyUniformHandles albedo;
+	MaterialPropertyUniformHandles normal;
+	MaterialPropertyUniformHandles roughness;
+	MaterialPropertyUniformHandles metallic;
+	MaterialPropertyUniformHandles ao;
+	MaterialPropertyUniformHandles height;
+	MaterialPropertyUniformHandles opacity;
+	UniformHandle height_scale;
+
+	/**
+	 * @brief Whether the samplers have been assigned to the texture units of the material, which never change.
+	 * 
+	 */
+	mutable bool samplers_assigned = false;
+
+	/**
+	 * @brief The material whose values have been uploaded into these uniforms last and its revision at that time.
+	 * 
+	 */
+	mutable IdSpaceSize uploaded_material = 0;
+	mutable uint64_t uploaded_revision = 0;
+};
+
+/**
+ * @brief The paths of the GLSL sources of a shader program that will be built (see ShaderManager::submitBatch).
+ * 
+ */
+struct GLRF::ShaderBuildRequest {
+	std::string shader_lib;
+	std::string vertex_path;
+	std::optional<std::string> geometry_path;
+	std::string fragment_path;
+	std::string debug_name;
+
+	/**
+	 * @brief The macros that are defined in every stage, directly after the '#version' directive.
+	 * 
+	 */
+	std::vector<std::string> defines;
+};
+
+enum class GLRF::ShaderBuildStatus {
+	PENDING,
+	SUCCEEDED,
+	FAILED
+};
+
+/**
+ * @brief The outcome of building a single shader program.
+ * 
+ */
+struct GLRF::ShaderBuildResult {
+	ShaderBuildStatus status = ShaderBuildStatus::PENDING;
+	std::string debug_name;
+
+	/**
+	 * @brief The stage that failed ('PREPROCESS', 'VERTEX', 'GEOMETRY', 'FRAGMENT' or 'PROGRAM' for linking errors).
+	 * 
+	 */
+	std::string failed_stage;
+
+	/**
+	 * @brief The info log of the driver for the failed stage.
+	 * 
+	 */
+	std::string log;
+
+	/**
+	 * @brief The built shader, which is registered at the ShaderManager (nullptr unless succeeded).
+	 * 
+	 */
+	std::shared_ptr<Shader> shader;
+};
+
+/**
+ * @brief A set of uniform values that can be loaded into shaders.
+ * 
+ * Values are stored in a single contiguous arena and addressed by interned uniform identifiers (see UniformRegistry).
+ * Every value carries a globally unique version that changes whenever the value changes.
+ * Shaders remember the version they received last, so loading a configuration only uploads values that changed.
+ */
 class GLRF::ShaderConfiguration {
 public:
 	ShaderConfiguration();
 	~ShaderConfiguration();
 
-	void loadIntoShader(Shader * shader) const;
+	/**
+	 * @brief Uploads all values into the specified shader, which must be in use unless direct state access is available (see GLCapabilities).
+	 * 
+	 * @param shader the shader that receives the values
+	 * @param force whether values that the shader already received will be uploaded again
+	 */
+	void loadIntoShader(Shader * shader, bool force = false) const;
+
+	void setBool(UniformId id, bool value);
+	void setInt(UniformId id, GLint value);
+	void setUInt(UniformId id, GLuint value);
+	void setFloat(UniformId id, float value);
+	void setMat4(UniformId id, const glm::mat4& value);
+	void setMat3(UniformId id, const glm::mat3& value);
+	void setVec4(UniformId id, const glm::vec4& value);
+	void setVec3(UniformId id, const glm::vec3& value);
+	void setVec2(UniformId id, const glm::vec2& value);
+	void setMaterial(UniformId id, const std::shared_ptr<Material> & material);
 
 	void setBool(const std::string& name, bool value);
 	void setInt(const std::string& name, GLint value);
@@ -39,6 +184,21 @@ public:
 	void setVec2(const std::string& name, glm::vec2 value);
 	void setMaterial(const std::string& name, std::shared_ptr<Material> material);
 
+	bool getBool(UniformId id);
+	GLint getInt(UniformId id);
+	GLuint getUInt(UniformId id);
+	float getFloat(UniformId id);
+	glm::mat4 getMat4(UniformId id);
+	glm::mat3 getMat3(UniformId id);
+	glm::vec4 getVec4(UniformId id);
+	glm::vec3 getVec3(UniformId id);
+	glm::vec2 getVec2(UniformId id);
+	std::shared_ptr<Material> getMaterial(UniformId id);
+
+	/**
+	 * @brief The getters by name do not intern unknown names, they return the default value of the type instead.
+	 * 
+	 */
 	bool getBool(const std::string& name);
 	GLint getInt(const std::string& name);
 	GLuint getUInt(const std::string& name);
@@ -49,17 +209,70 @@ public:
 	glm::vec3 getVec3(const std::string& name);
 	glm::vec2 getVec2(const std::string& name);
 	std::shared_ptr<Material> getMaterial(const std::string& name);
+
+	/**
+	 * @brief Returns the version of the value of the specified uniform, which changes whenever the value changes.
+	 * 
+	 * @param id the identifier of the uniform
+	 * @return uint64_t the version of the value or 0 if the uniform has no value
+	 */
+	uint64_t getVersion(UniformId id) const;
 private:
-	std::map<std::string, bool>			v_bool;
-	std::map<std::string, int>			v_int;
-	std::map<std::string, unsigned int> v_uint;
-	std::map<std::string, float>		v_float;
-	std::map<std::string, glm::mat4>	v_mat4;
-	std::map<std::string, glm::mat3>	v_mat3;
-	std::map<std::string, glm::vec4>	v_vec4;
-	std::map<std::string, glm::vec3>	v_vec3;
-	std::map<std::string, glm::vec2>	v_vec2;
-	std::map<std::string, std::shared_ptr<Material>> v_material;
+	enum class ValueType : uint8_t {
+		BOOL, INT, UINT, FLOAT, MAT4, MAT3, VEC4, VEC3, VEC2, MATERIAL
+	};
+
+	struct Entry {
+		UniformId id;
+		ValueType type;
+		uint32_t offset;
+		uint64_t version;
+	};
+
+	static constexpr int32_t NO_ENTRY = -1;
+
+	std::vector<Entry> entries;
+	std::vector<int32_t> entry_indices;
+	std::vector<unsigned char> arena;
+	std::vector<std::shared_ptr<Material>> materials;
+
+	static uint64_t nextVersion();
+
+	const Entry * findEntry(UniformId id, ValueType type) const;
+	Entry & findOrCreateEntry(UniformId id, ValueType type, size_t size);
+
+	template <typename T>
+	void setValue(UniformId id, ValueType type, const T& value) {
+		size_t entry_count = this->entries.size();
+		Entry & entry = findOrCreateEntry(id, type, sizeof(T));
+		unsigned char * data = &this->arena[entry.offset];
+		if (entry_count == this->entries.size() && std::memcmp(data, &value, sizeof(T)) == 0) return;
+		std::memcpy(data, &value, sizeof(T));
+		entry.version = nextVersion();
+	}
+
+	template <typename T>
+	T getValue(UniformId id, ValueType type, T fallback) const {
+		const Entry * entry = findEntry(id, type);
+		if (entry == nullptr) return fallback;
+		T value;
+		std::memcpy(&value, &this->arena[entry->offset], sizeof(T));
+		return value;
+	}
+
+	template <typename T>
+	T getValue(const std::string& name, ValueType type, T fallback) const {
+		UniformId id;
+		if (!UniformRegistry::getInstance().find(name, &id)) return fallback;
+		return getValue(id, type, fallback);
+	}
+
+	template <typename T>
+	T readValue(const Entry & entry) const {
+		T value;
+		std::memcpy(&value, &this->arena[entry.offset], sizeof(T));
+		return value;
+	}
 };
 
 /**
@@ -67,6 +280,8 @@ private:
  * 
  */
 class GLRF::Shader {
+	friend class ShaderManager;
+	friend class ShaderBatch;
 public:
 	/**
 	 * @brief Construct a new Shader object.
@@ -79,6 +294,10 @@ public:
 	 * 
 	 * Creates a new Shader from the specified library path and sub-paths to the vertex and fragment shader files.
 	 * Takes shader options as input to configure itself.
+	 * If a binary cache is set on the ShaderManager, a previously linked binary of the same sources is loaded instead of compiling them.
+	 * The shader is built synchronously, use ShaderManager::submitBatch to build many shaders without blocking.
+	 * 
+	 * @throws std::runtime_error if a stage fails to compile or the program fails to link
 	 */
 	Shader(const std::string shader_lib, const std::string vertex_path, std::optional<const std::string> geometry_path,
 		const std::string fragment_path);
@@ -89,8 +308,191 @@ public:
 	 */
 	unsigned int getID();
 
+	/**
+	 * @brief Returns the handle of the specified, named uniform of this Shader.
+	 * 
+	 * @param name the name of the uniform (e.g. 'model' or 'pointLight_color[2]')
+	 * @return UniformHandle the handle of the uniform, which is invalid if the uniform is not active
+	 * 
+	 * The lookup is done in the table of active uniforms that was reflected after linking.
+	 * Resolve handles once and reuse them, instead of setting values by name on hot paths.
+	 */
+	UniformHandle uniform(const std::string& name) const;
+
+	/**
+	 * @brief Returns the handle of the uniform with the specified, interned identifier.
+	 * 
+	 * @param id the identifier of the uniform name (see UniformRegistry)
+	 * @return UniformHandle the handle of the uniform, which is invalid if the uniform is not active
+	 * 
+	 * Identifiers are resolved once and cached in a flat table afterwards.
+	 */
+	UniformHandle uniform(UniformId id) const;
+
+	/**
+	 * @brief Returns the handles of all uniforms of the specified, named material variable in this Shader.
+	 * 
+	 * @param name the name of the material variable (e.g. 'material')
+	 * @return const MaterialUniformHandles& the handles of all uniforms of the material
+	 * 
+	 * The handles are resolved on first request and cached afterwards.
+	 */
+	const MaterialUniformHandles& materialUniform(const std::string& name);
+
+	/**
+	 * @brief Returns the handles of all uniforms of the material variable with the specified, interned identifier.
+	 * 
+	 * @param id the identifier of the material variable name (see UniformRegistry)
+	 * @return const MaterialUniformHandles& the handles of all uniforms of the material
+	 */
+	const MaterialUniformHandles& materialUniform(UniformId id);
+
+	/**
+	 * @brief Returns the version of the value that was last uploaded for the specified uniform (see ShaderConfiguration).
+	 * 
+	 * @param id the identifier of the uniform
+	 * @return uint64_t the version of the value or 0 if no value was uploaded yet
+	 */
+	uint64_t getUploadedVersion(UniformId id) const;
+
+	/**
+	 * @brief Remembers the version of the value that was uploaded for the specified uniform.
+	 * 
+	 * @param id the identifier of the uniform
+	 * @param version the version of the uploaded value
+	 */
+	void setUploadedVersion(UniformId id, uint64_t version);
+
+	/**
+	 * @brief Forgets all uploaded versions, so that the next configuration uploads all of its values.
+	 * 
+	 */
+	void clearUploadedVersions();
+
+	/**
+	 * @brief Connects the specified, named uniform block of this Shader to a uniform buffer binding point.
+	 * 
+	 * @param name the name of the uniform block (e.g. 'SceneData')
+	 * @param binding the index of the binding point
+	 * @return true if the block is active in this Shader
+	 * @return false else
+	 */
+	bool bindUniformBlock(const std::string& name, GLuint binding);
+
+	/**
+	 * @brief Connects the specified, named shader storage block of this Shader to a shader storage buffer binding point.
+	 * 
+	 * @param name the name of the storage block (e.g. 'DrawDataArray')
+	 * @param binding the index of the binding point
+	 * @return true if the block is active in this Shader and the context supports multi-draw indirect
+	 * @return false else
+	 */
+	bool bindStorageBlock(const std::string& name, GLuint binding);
+
+	/**
+	 * @brief Returns whether this Shader reads its per-draw values from the 'DrawData' uniform block.
+	 * 
+	 */
+	bool usesDrawBlock();
+
+	/**
+	 * @brief Returns whether this Shader reads the model matrices from per-instance attributes (see InstanceData).
+	 * 
+	 */
+	bool usesInstancing();
+
+	/**
+	 * @brief Returns whether this Shader reads its per-draw values from the 'DrawDataArray' storage block,
+	 * so that its draws can be issued with multi-draw indirect (see IndirectDrawBuffer).
+	 * 
+	 */
+	bool usesDrawStorage();
+
 	// === utility uniform functions ===
 
+	/**
+	 * @brief Sets the specified value for the uniform of the specified handle in this Shader.
+	 * 
+	 * @param handle the handle of the uniform that will be set
+	 * @param value the new value for the uniform
+	 */
+	void setBool(UniformHandle handle, bool value) const;
+
+	/**
+	 * @brief Sets the specified value for the uniform of the specified handle in this Shader.
+	 * 
+	 * @param handle the handle of the uniform that will be set
+	 * @param value the new value for the uniform
+	 */
+	void setInt(UniformHandle handle, GLint value) const;
+
+	/**
+	 * @brief Sets the specified value for the uniform of the specified handle in this Shader.
+	 * 
+	 * @param handle the handle of the uniform that will be set
+	 * @param value the new value for the uniform
+	 */
+	void setUInt(UniformHandle handle, GLuint value) const;
+
+	/**
+	 * @brief Sets the specified value for the uniform of the specified handle in this Shader.
+	 * 
+	 * @param handle the handle of the uniform that will be set
+	 * @param value the new value for the uniform
+	 */
+	void setFloat(UniformHandle handle, float value) const;
+
+	/**
+	 * @brief Sets the specified value for the uniform of the specified handle in this Shader.
+	 * 
+	 * @param handle the handle of the uniform that will be set
+	 * @param value the new value for the uniform
+	 */
+	void setMat4(UniformHandle handle, const glm::mat4& value) const;
+
+	/**
+	 * @brief Sets the specified value for the uniform of the specified handle in this Shader.
+	 * 
+	 * @param handle the handle of the uniform that will be set
+	 * @param value the new value for the uniform
+	 */
+	void setMat3(UniformHandle handle, const glm::mat3& value) const;
+
+	/**
+	 * @brief Sets the specified value for the uniform of the specified handle in this Shader.
+	 * 
+	 * @param handle the handle of the uniform that will be set
+	 * @param value the new value for the uniform
+	 */
+	void setVec4(UniformHandle handle, const glm::vec4& value) const;
+
+	/**
+	 * @brief Sets the specified value for the uniform of the specified handle in this Shader.
+	 * 
+	 * @param handle the handle of the uniform that will be set
+	 * @param value the new value for the uniform
+	 */
+	void setVec3(UniformHandle handle, const glm::vec3& value) const;
+
+	/**
+	 * @brief Sets the specified value for the uniform of the specified handle in this Shader.
+	 * 
+	 * @param handle the handle of the uniform that will be set
+	 * @param value the new value for the uniform
+	 */
+	void setVec2(UniformHandle handle, const glm::vec2& value) const;
+
+	/**
+	 * @brief Sets the specified material for the uniforms of the specified handles in this Shader.
+	 * 
+	 * @param handles the handles of the material uniforms that will be set
+	 * @param material the new material for the uniforms
+	 * 
+	 * Shaders with the 'MaterialData' block only bind the buffer of the material, others receive the values as uniforms.
+	 * Textures, buffers and uniforms that already hold the current revision of the material are not set again.
+	 */
+	void setMaterial(const MaterialUniformHandles& handles, std::shared_ptr<Material> material);
+
 	/**
 	 * @brief Sets the specified value for the specified, named variable in this Shader.
 	 * 
@@ -174,6 +576,13 @@ public:
 	void setDebugName(const std::string name);
 	std::string getDebugName();
 
+	/**
+	 * @brief Returns whether this Shader is a variant that is specialized for the features of a material
+	 * (see ShaderManager::enableMaterialVariants).
+	 * 
+	 */
+	bool isMaterialVariant();
+
 private:
 	static const char period = '.';
 	const std::string value_default = "value_default";
@@ -181,60 +590,59 @@ private:
 	const std::string texture = "texture";
 	GLuint ID;
 	std::string debug_name;
-
-	unsigned int createShader(GLenum shader_type, const GLchar* shader_source, std::string shader_name);
+	bool uses_draw_block = false;
+	bool uses_material_block = false;
+	bool uses_instancing = false;
+	bool uses_draw_storage = false;
+	bool direct_state_access = false;
+	bool material_variant = false;
+	bool material_variants_enabled = false;
+	ShaderBuildRequest build_request;
+	std::unordered_map<std::string, GLint> uniform_locations;
+	std::unordered_map<UniformId, MaterialUniformHandles> material_uniforms;
+	static constexpr GLint UNRESOLVED_LOCATION = -2;
+	mutable std::vector<GLint> location_cache;
+	std::vector<uint64_t> uploaded_versions;
+
+	Shader();
 
 	/**
-	 * @brief Sets the specified material property for the specified, named variable in this Shader.
-	 *
-	 * @param name the name of the material property that will be set
-	 * @param material_property the new material property for the variable
-	 *
-	 * The 4-dimensional property will be set directly.
+	 * @brief Takes ownership of a successfully linked program, reflects its uniforms and registers this Shader.
+	 * 
+	 * @param program the identifier of the linked program
 	 */
-	void setMaterialProperty(const std::string& name, MaterialProperty<glm::vec4> material_property, GLuint texture_unit);
+	void adoptProgram(GLuint program);
 
 	/**
-	 * @brief Sets the specified material property for the specified, named variable in this Shader.
-	 *
-	 * @param name the name of the material property that will be set
-	 * @param material_property the new material property for the variable
-	 *
-	 * The 3-dimensional property will be set as 4-dimensional with an additional value of 1 at the end.
+	 * @brief Fills the uniform location table with all active uniforms of the linked program.
+	 * 
+	 * Elements of uniform arrays are registered individually (e.g. 'name[1]'),
+	 * the first element is additionally registered without a subscript.
 	 */
-	void setMaterialProperty(const std::string& name, MaterialProperty<glm::vec3> material_property, GLuint texture_unit);
+	void reflectUniforms();
 
-	/**
-	 * @brief Sets the specified material property for the specified, named variable in this Shader.
-	 *
-	 * @param name the name of the material property that will be set
-	 * @param material_property the new material property for the variable
-	 *
-	 * The 2-dimensional property will be set as 4-dimensional with two additional values of 1 at the end.
-	 */
-	void setMaterialProperty(const std::string& name, MaterialProperty<glm::vec2> material_property, GLuint texture_unit);
+	MaterialPropertyUniformHandles materialPropertyUniform(const std::string& name) const;
 
 	/**
-	 * @brief Sets the specified material property for the specified, named variable in this Shader.
+	 * @brief Sets the specified material property for the specified uniform handles in this Shader.
 	 *
-	 * @param name the name of the material property that will be set
+	 * @param handles the handles of the material property that will be set
 	 * @param material_property the new material property for the variable
-	 *
-	 * The 1-dimensional property will be copied to a 3-dimensional value and set as 4-dimensional
-	 * with an additional value of 1 at the end.
-	 */
-	void setMaterialProperty(const std::string& name, MaterialProperty<float> material_property, GLuint texture_unit);
-
-	/**
-	 * @brief Sets common aspects of material properties.
+	 * 
+	 * Material variants decide at compile time whether a texture is used, so they receive no 'use_texture' values.
 	 */
 	template <typename T>
-	void setMaterialPropertyCommons(const std::string& name, MaterialProperty<T> material_property, GLuint texture_unit) {
-		setBool(name + period + use_texture, material_property.texture.has_value());
-		setInt(name + period + texture, texture_unit);
+	void setMaterialProperty(const MaterialPropertyUniformHandles& handles, const MaterialProperty<T>& material_property) {
+		setMaterialPropertyValue(handles.value_default, material_property.value_default);
+		if (!this->material_variant) setBool(handles.use_texture, material_property.texture.has_value());
 	}
 
-	void loadShaderFile(const std::string shader_path, std::string * out);
+	void setMaterialPropertyValue(UniformHandle handle, const glm::vec4& value) const { setVec4(handle, value); }
+	void setMaterialPropertyValue(UniformHandle handle, const glm::vec3& value) const { setVec3(handle, value); }
+	void setMaterialPropertyValue(UniformHandle handle, const glm::vec2& value) const { setVec2(handle, value); }
+	void setMaterialPropertyValue(UniformHandle handle, float value) const { setFloat(handle, value); }
+
+	static void loadShaderFile(const std::string shader_path, std::string * out);
 };
 
 class GLRF::ShaderManager
@@ -249,17 +657,138 @@ public:
 
 	void registerShader(Shader * shader);
 
+	/**
+	 * @brief Enables the cache of linked program binaries for all shaders that are created afterwards.
+	 * 
+	 * @param directory the directory that holds the binaries (e.g. './shader_cache/')
+	 * 
+	 * The cache has no effect on drivers that do not support program binaries.
+	 */
+	void setBinaryCache(fs::path directory);
+
+	/**
+	 * @brief Returns the cache of linked program binaries or nullptr if it is not enabled.
+	 * 
+	 */
+	ShaderBinaryCache * getBinaryCache();
+
+	/**
+	 * @brief Starts building many shader programs at once without waiting for any of them.
+	 * 
+	 * @param requests the shader programs that will be built
+	 * @return std::shared_ptr<ShaderBatch> the batch that reports the results once the programs are built
+	 * 
+	 * All compiles and links are issued up front, so that the driver can process them in parallel
+	 * (see GL_KHR_parallel_shader_compile). Poll the batch every frame, e.g. while showing a loading screen.
+	 */
+	std::shared_ptr<ShaderBatch> submitBatch(const std::vector<ShaderBuildRequest>& requests);
+
 	void useShader(GLuint ID);
 
-	void configureShader(const ShaderConfiguration * configuration, GLuint ID, bool force);
+	/**
+	 * @brief Starts a new frame, must be called once per frame before anything is drawn (Scene::draw does this).
+	 * 
+	 * Materials are checked for changes once per frame and finished material variants become available.
+	 */
+	void beginFrame();
+
+	/**
+	 * @brief Returns the current frame (see beginFrame).
+	 * 
+	 */
+	uint64_t getFrame();
+
+	/**
+	 * @brief Returns a number that increases whenever a material variant becomes available,
+	 * so that the results of getMaterialVariant may have changed.
+	 * 
+	 */
+	uint64_t getVariantGeneration();
+
+	/**
+	 * @brief Allows a registered shader to be replaced by variants that are specialized for the features of a material.
+	 * 
+	 * @param ID the identifier of the shader program
+	 * 
+	 * Variants are built from the sources of the shader with the additional macro 'GLRF_MATERIAL_VARIANT'
+	 * and one macro per MaterialFeature (see Material::getFeatureDefines), e.g.:
+	 * 
+	 * #ifdef GLRF_MATERIAL_VARIANT
+	 *     #ifdef GLRF_ALBEDO_TEXTURE
+	 *     vec3 albedo = texture(material.albedo.texture, uv).rgb;
+	 *     #else
+	 *     vec3 albedo = material.albedo.value_default;
+	 *     #endif
+	 * #else
+	 *     vec3 albedo = material.albedo.use_texture ? texture(material.albedo.texture, uv).rgb : material.albedo.value_default;
+	 * #endif
+	 * 
+	 * @throws std::invalid_argument if no shader with the specified identifier is registered
+	 */
+	void enableMaterialVariants(GLuint ID);
+
+	/**
+	 * @brief Returns the shader program that draws the specified material best.
+	 * 
+	 * @param ID the identifier of the shader program the object was assigned to
+	 * @param material the material of the object
+	 * @return GLuint the identifier of the specialized variant, or ID if the variant is not available (yet)
+	 * 
+	 * Variants are built on demand in the background and cached by the feature mask of the material.
+	 * Until a variant is ready (see pollMaterialVariants) the unspecialized shader is used.
+	 */
+	GLuint getMaterialVariant(GLuint ID, Material * material);
+
+	/**
+	 * @brief Makes all material variants available whose build finished in the meantime.
+	 * 
+	 * Failed builds are reported once, the unspecialized shader keeps drawing those materials.
+	 */
+	void pollMaterialVariants();
+
+	/**
+	 * @brief Returns whether any registered shader lacks the 'SceneData' uniform block
+	 * and thus still needs the scene values as individual uniforms.
+	 * 
+	 */
+	bool requiresLegacySceneUniforms();
+
+	/**
+	 * @brief Uploads the values of a configuration into a registered shader, which must be in use unless direct state access is available (see GLCapabilities).
+	 * 
+	 * @param configuration the configuration that will be loaded
+	 * @param ID the identifier of the shader program
+	 * @param force whether values that the shader already received will be uploaded again
+	 * 
+	 * Only values that changed since the shader received them last are uploaded.
+	 */
+	void configureShader(const ShaderConfiguration * configuration, GLuint ID, bool force = false);
 
+	/**
+	 * @brief Forgets which values have been uploaded into the registered shaders.
+	 * 
+	 * Call this after uniforms have been modified outside of ShaderConfiguration.
+	 */
 	void clearDrawConfigurations();
 
 	Shader * getShader(GLuint ID);
 private:
 	std::map<GLuint, Shader *> registered_shaders;
-	std::set<GLuint> configured_shaders;
-	GLuint activeShaderID = 0;
+	std::set<GLuint> legacy_scene_shaders;
+	std::unique_ptr<ShaderBinaryCache> binary_cache;
+	uint64_t frame = 1;
+	uint64_t variant_generation = 0;
+
+	struct PendingMaterialVariant {
+		uint64_t key;
+		std::shared_ptr<ShaderBatch> batch;
+	};
+
+	std::unordered_map<uint64_t, GLuint> material_variants;
+	std::vector<PendingMaterialVariant> pending_material_variants;
+	std::vector<std::shared_ptr<Shader>> material_variant_shaders;
+
+	static uint64_t materialVariantKey(GLuint ID, uint32_t feature_mask);
 
 	ShaderManager();
 	ShaderManager(const ShaderManager&);
@@ -0,0 +1,100 @@
+#pragma once
+#include <glad/glad.h>
+#include <vector>
+#include <string>
+#include <memory>
+
+#include <GLRF/Shader.hpp>
+#include <GLRF/ShaderPreprocessor.hpp>
+
+namespace GLRF {
+	class ShaderBatch;
+}
+
+/**
+ * @brief A set of shader programs that are built concurrently by the driver.
+ * 
+ * All compiles and links are issued when the batch is created, without querying any status in between.
+ * If GL_KHR_parallel_shader_compile (or the ARB variant) is available, poll() only finishes programs
+ * whose GL_COMPLETION_STATUS_KHR is set and never stalls. Otherwise every status query blocks,
+ * so poll() finishes at most one program per call.
+ * Errors never terminate the application, they are reported through the results instead.
+ */
+class GLRF::ShaderBatch {
+	friend class Shader;
+	friend class ShaderManager;
+public:
+	~ShaderBatch();
+
+	ShaderBatch(const ShaderBatch&) = delete;
+	ShaderBatch& operator = (const ShaderBatch&) = delete;
+
+	/**
+	 * @brief Finishes all programs that the driver completed in the meantime.
+	 * 
+	 * @return true if all programs are finished
+	 * @return false else
+	 */
+	bool poll();
+
+	/**
+	 * @brief Blocks until all programs are finished.
+	 * 
+	 */
+	void wait();
+
+	/**
+	 * @brief Returns whether all programs are finished.
+	 * 
+	 */
+	bool isFinished();
+
+	/**
+	 * @brief Returns the number of finished programs, e.g. to display the progress of a loading screen.
+	 * 
+	 */
+	size_t getFinishedCount();
+
+	/**
+	 * @brief Returns the results of all programs in the order of the requests.
+	 * 
+	 */
+	const std::vector<ShaderBuildResult>& getResults();
+private:
+	enum class Stage {
+		LOADING_BINARY,
+		COMPILING,
+		FINISHED
+	};
+
+	struct Build {
+		ShaderBuildRequest request;
+		std::vector<std::string> sources;
+		std::vector<GLuint> shader_ids;
+		GLuint program = 0;
+		std::string binary_key;
+		Stage stage = Stage::COMPILING;
+		Shader * target = nullptr;
+	};
+
+	static const GLenum stage_types[3];
+	static const char * stage_names[3];
+
+	std::vector<Build> builds;
+	std::vector<ShaderBuildResult> results;
+	size_t finished_count = 0;
+
+	/**
+	 * @brief Construct a new ShaderBatch object and issues all builds.
+	 * 
+	 * @param requests the shader programs that will be built
+	 * @param target an existing Shader that adopts the program of a single request, or nullptr to create new shaders
+	 */
+	ShaderBatch(const std::vector<ShaderBuildRequest>& requests, Shader * target = nullptr);
+
+	void start(size_t index, const ShaderBuildRequest& request);
+	void issueCompile(Build & build);
+	bool isComplete(const Build & build);
+	void finish(size_t index);
+	void release(Build & build);
+};
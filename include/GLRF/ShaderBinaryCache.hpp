@@ -0,0 +1,72 @@
+#pragma once
+#include <glad/glad.h>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+namespace GLRF {
+	class ShaderBinaryCache;
+}
+
+/**
+ * @brief A directory of linked shader program binaries that skips shader compilation on later starts.
+ * 
+ * Binaries are stored under a key that is derived from the shader sources and the driver (vendor, renderer, version),
+ * so that changed sources or a driver update never load a stale binary.
+ * Drivers may still reject a stored binary, in which case the program has to be compiled from source again.
+ */
+class GLRF::ShaderBinaryCache {
+public:
+	/**
+	 * @brief Construct a new ShaderBinaryCache object.
+	 * 
+	 * @param directory the directory that holds the binaries, it will be created if it does not exist
+	 */
+	ShaderBinaryCache(fs::path directory);
+	~ShaderBinaryCache();
+
+	/**
+	 * @brief Creates the key of a program.
+	 * 
+	 * @param sources the sources of all stages of the program
+	 * @param driver a description of the driver that the binary will be created with
+	 * @return std::string the key as a hexadecimal string
+	 */
+	static std::string createKey(const std::vector<std::string>& sources, const std::string& driver);
+
+	/**
+	 * @brief Loads a stored binary.
+	 * 
+	 * @param key the key of the program
+	 * @param format the driver-specific format of the binary
+	 * @param binary the binary data
+	 * @return true if a valid binary was found
+	 * @return false else
+	 */
+	bool load(const std::string& key, GLenum * format, std::vector<unsigned char> * binary);
+
+	/**
+	 * @brief Stores a binary, replacing a previously stored binary with the same key.
+	 * 
+	 * @param key the key of the program
+	 * @param format the driver-specific format of the binary
+	 * @param binary the binary data
+	 */
+	void store(const std::string& key, GLenum format, const std::vector<unsigned char>& binary);
+
+	/**
+	 * @brief Retrieves the binary of a linked program object and stores it.
+	 * 
+	 * @param key the key of the program
+	 * @param program the linked program object, which should have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+	 */
+	void storeProgram(const std::string& key, GLuint program);
+private:
+	static const char magic[8];
+	fs::path directory;
+
+	fs::path getPath(const std::string& key);
+};
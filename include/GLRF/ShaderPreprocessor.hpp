@@ -0,0 +1,45 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <set>
+#include <sstream>
+#include <fstream>
+#include <stdexcept>
+
+namespace GLRF {
+	class ShaderPreprocessor;
+}
+
+/**
+ * @brief Prepares GLSL sources before they are compiled.
+ * 
+ * Resolves '#include "file"' directives relative to the shader library (every file is included at most once)
+ * and inserts '#define' directives directly after the '#version' directive.
+ * '#line' directives are emitted around included files, so that compiler errors still refer to the original lines.
+ */
+class GLRF::ShaderPreprocessor {
+public:
+	/**
+	 * @brief Construct a new ShaderPreprocessor object.
+	 * 
+	 * @param shader_lib the relative path to a collection of shaders that included files are searched in
+	 */
+	ShaderPreprocessor(std::string shader_lib);
+
+	/**
+	 * @brief Processes a GLSL source.
+	 * 
+	 * @param source the GLSL source
+	 * @param defines the names of the macros that will be defined (e.g. 'GLRF_ALBEDO_TEXTURE' or 'COUNT 4')
+	 * @return std::string the processed source
+	 * 
+	 * @throws std::runtime_error if an included file cannot be read
+	 */
+	std::string process(const std::string& source, const std::vector<std::string>& defines);
+private:
+	std::string shader_lib;
+	std::set<std::string> included_files;
+
+	void processLines(std::istream& input, std::ostringstream& output, int source_number, const std::vector<std::string> * defines);
+	static bool parseInclude(const std::string& line, std::string * path);
+};
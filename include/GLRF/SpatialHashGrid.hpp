@@ -0,0 +1,119 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+#include <GLRF/Bounds.hpp>
+#include <GLRF/Frustum.hpp>
+#include <GLRF/SpatialIndex.hpp>
+
+namespace GLRF {
+	class SpatialHashGrid;
+}
+
+/**
+ * @brief A spatial index that sorts the boxes into a loose uniform grid, for scenes in which most nodes move every frame.
+ *
+ * A box belongs to the cell that contains its center, as long as it is at most half as large as a cell in every
+ * direction. The boxes of a cell therefore stay within the cell enlarged by half a cell, which is the only
+ * extent that queries have to account for. Larger boxes are kept in a separate list that every query tests.
+ * Cells are not stored, they are hashed into a table of buckets that grows with the number of boxes,
+ * so the grid is unbounded and inserting, moving or removing a box takes constant time.
+ *
+ * Queries visit the cells that overlap the bounds of the query (the box around the corners of a frustum), or scan all
+ * buckets if they are fewer. A good cell size is about twice the size of a typical box.
+ */
+class GLRF::SpatialHashGrid : public SpatialIndex {
+public:
+	/**
+	 * @brief Construct a new SpatialHashGrid object.
+	 *
+	 * @param cell_size the edge length of a cell
+	 * @param bucket_count the initial number of buckets, rounded up to a power of two
+	 */
+	SpatialHashGrid(float cell_size = 4.f, size_t bucket_count = 1024);
+	~SpatialHashGrid();
+
+	int32_t insert(const BoundingBox & box);
+
+	void remove(int32_t proxy);
+
+	/**
+	 * @brief Moves a proxy to a new box.
+	 *
+	 * @return true if the proxy moved to another cell
+	 * @return false if it stayed in its cell
+	 */
+	bool update(int32_t proxy, const BoundingBox & box);
+
+	void clear();
+
+	const BoundingBox & getBox(int32_t proxy) const;
+
+	size_t getProxyCount() const;
+
+	size_t getProxyCapacity() const;
+
+	size_t getBucketCount() const;
+
+	/**
+	 * @brief Returns the number of boxes that are too large for a cell.
+	 *
+	 */
+	size_t getLargeCount() const;
+
+	float getCellSize() const;
+
+	void query(const Frustum & frustum, std::vector<int32_t> & proxies) const;
+
+	void query(const BoundingSphere & sphere, std::vector<int32_t> & proxies) const;
+
+	void query(const BoundingBox & box, std::vector<int32_t> & proxies) const;
+
+	void raycast(const glm::vec3 & origin, const glm::vec3 & direction, float max_distance, std::vector<int32_t> & proxies) const;
+
+	/**
+	 * @brief Checks whether every proxy is stored in the bucket of its cell at its slot.
+	 *
+	 */
+	bool validate() const;
+private:
+	/**
+	 * @brief The bucket of a proxy is NULL_PROXY if its box is too large for a cell, its slot is then inside the large list.
+	 *
+	 */
+	struct Proxy {
+		BoundingBox box;
+		glm::ivec3 cell = glm::ivec3(0);
+		int32_t bucket = NULL_PROXY;
+		uint32_t slot = 0;
+		int32_t next = NULL_PROXY;
+		bool allocated = false;
+	};
+
+	std::vector<Proxy> proxies;
+	std::vector<std::vector<int32_t>> buckets;
+	std::vector<int32_t> large;
+	int32_t free_list = NULL_PROXY;
+	size_t proxy_count = 0;
+	float cell_size;
+	float inverse_cell_size;
+
+	glm::ivec3 getCell(const glm::vec3 & position) const;
+	int32_t getBucket(const glm::ivec3 & cell) const;
+	bool fitsCell(const BoundingBox & box) const;
+	void link(int32_t proxy);
+	void unlink(int32_t proxy);
+	void rehash(size_t bucket_count);
+
+	/**
+	 * @brief Appends the proxies that pass a test, visiting either the cells that overlap a range or all buckets.
+	 *
+	 * @param range the box that contains everything the query can hit
+	 * @param bounded whether the range is finite, otherwise all buckets are visited
+	 * @param test returns whether a box (of a proxy or of an enlarged cell) is hit
+	 */
+	template <typename Test>
+	void query(const BoundingBox & range, bool bounded, const Test & test, std::vector<int32_t> & proxies) const;
+};
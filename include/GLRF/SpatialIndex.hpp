@@ -0,0 +1,97 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include <glm/glm.hpp>
+
+#include <GLRF/Bounds.hpp>
+#include <GLRF/Frustum.hpp>
+
+namespace GLRF {
+	class SpatialIndex;
+}
+
+/**
+ * @brief An index of axis-aligned boxes that answers frustum, sphere and ray queries without testing every box.
+ *
+ * Every inserted box is identified by a proxy, which stays valid until the box is removed. Proxies are small
+ * non-negative integers that are reused after a removal, so they can index arrays (see getProxyCapacity).
+ * Queries are conservative, they may return boxes that were enlarged by the index, but never miss a box.
+ * Queries do not modify the index, so they can run on several threads at once.
+ *
+ * The Scene keeps the boxes of its object nodes in an index (see Scene::setSpatialIndex).
+ */
+class GLRF::SpatialIndex {
+public:
+	static constexpr int32_t NULL_PROXY = -1;
+
+	virtual ~SpatialIndex() {};
+
+	/**
+	 * @brief Inserts a box.
+	 *
+	 * @return int32_t the proxy of the box
+	 */
+	virtual int32_t insert(const BoundingBox & box) = 0;
+
+	virtual void remove(int32_t proxy) = 0;
+
+	/**
+	 * @brief Moves a proxy to a new box.
+	 *
+	 * @return true if the structure of the index changed
+	 * @return false if only the box was stored, or not even that
+	 */
+	virtual bool update(int32_t proxy, const BoundingBox & box) = 0;
+
+	virtual void clear() = 0;
+
+	/**
+	 * @brief Returns the box that the index stores for a proxy, which may be enlarged.
+	 *
+	 */
+	virtual const BoundingBox & getBox(int32_t proxy) const = 0;
+
+	virtual size_t getProxyCount() const = 0;
+
+	/**
+	 * @brief Returns the upper bound of all proxies, e.g. to size arrays that are indexed by proxies.
+	 *
+	 */
+	virtual size_t getProxyCapacity() const = 0;
+
+	/**
+	 * @brief Appends the proxies of all boxes that intersect the frustum.
+	 *
+	 */
+	virtual void query(const Frustum & frustum, std::vector<int32_t> & proxies) const = 0;
+
+	/**
+	 * @brief Appends the proxies of all boxes that intersect the sphere.
+	 *
+	 */
+	virtual void query(const BoundingSphere & sphere, std::vector<int32_t> & proxies) const = 0;
+
+	/**
+	 * @brief Appends the proxies of all boxes that intersect the box.
+	 *
+	 */
+	virtual void query(const BoundingBox & box, std::vector<int32_t> & proxies) const = 0;
+
+	/**
+	 * @brief Appends the proxies of all boxes that are hit by a ray, in no particular order.
+	 *
+	 * @param origin the origin of the ray
+	 * @param direction the direction of the ray, which does not need to be normalized
+	 * @param max_distance the length of the ray in multiples of the direction
+	 */
+	virtual void raycast(const glm::vec3 & origin, const glm::vec3 & direction, float max_distance,
+		std::vector<int32_t> & proxies) const = 0;
+
+	/**
+	 * @brief Checks the internal invariants of the index.
+	 *
+	 */
+	virtual bool validate() const = 0;
+};
@@ -0,0 +1,105 @@
+#pragma once
+#include <glad/glad.h>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include <GLRF/GLStateCache.hpp>
+#include <GLRF/GLCapabilities.hpp>
+
+namespace GLRF {
+	struct StreamingAllocation;
+	class StreamingBuffer;
+}
+
+/**
+ * @brief A range of the current frame inside a StreamingBuffer.
+ *
+ */
+struct GLRF::StreamingAllocation {
+	GLuint buffer = 0;
+	GLintptr offset = 0;
+	void * data = nullptr;
+};
+
+/**
+ * @brief A persistently mapped buffer for data that is written by the CPU every frame (e.g. procedural meshes).
+ *
+ * The buffer has immutable storage that stays mapped (GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT), so data is written
+ * straight into memory that the GPU reads, without any copy by the driver or implicit synchronization.
+ * It is split into one region per frame in flight, the end of each frame is marked with a fence and a region is only
+ * written again after the GPU passed its fence. Allocations are only valid during the frame they were made in.
+ *
+ * AppFrame calls beginFrame before the scene is updated and endFrame after it was rendered.
+ * Persistent mapping requires GL 4.4 or ARB_buffer_storage (see isAvailable).
+ */
+class GLRF::StreamingBuffer {
+public:
+	static StreamingBuffer& getInstance() {
+		static StreamingBuffer instance;
+		return instance;
+	}
+
+	~StreamingBuffer();
+
+	/**
+	 * @brief Returns whether the context supports persistently mapped buffers.
+	 *
+	 */
+	static bool isAvailable();
+
+	/**
+	 * @brief Starts a new frame by switching to the next region, waiting for the GPU if it still reads this region.
+	 *
+	 */
+	void beginFrame();
+
+	/**
+	 * @brief Marks the end of the commands that read the region of the current frame.
+	 *
+	 */
+	void endFrame();
+
+	/**
+	 * @brief Allocates a range inside the region of the current frame.
+	 *
+	 * If the region is full, the buffer is replaced by a larger one. Previous allocations of the frame stay valid,
+	 * as the replaced buffer is only deleted at the beginning of the next frame.
+	 *
+	 * @param size the size in bytes
+	 * @param alignment the alignment of the offset in bytes
+	 * @return StreamingAllocation the buffer, the offset inside the buffer and the mapped memory of the range
+	 */
+	StreamingAllocation allocate(GLsizeiptr size, GLsizeiptr alignment = 16);
+
+	/**
+	 * @brief Returns a number that is incremented by every beginFrame, allocations of other frames are invalid.
+	 *
+	 */
+	uint64_t getFrame();
+
+	/**
+	 * @brief Returns the number of frames in which beginFrame had to wait for the GPU.
+	 *
+	 */
+	uint64_t getStallCount();
+private:
+	static constexpr GLuint REGION_COUNT = 3;
+	static constexpr GLsizeiptr INITIAL_REGION_SIZE = 1 << 20;
+
+	GLuint ID = 0;
+	unsigned char * mapped = nullptr;
+	GLsizeiptr region_size = INITIAL_REGION_SIZE;
+	GLuint region_index = 0;
+	GLsizeiptr cursor = 0;
+	GLsync fences[REGION_COUNT] = { 0 };
+	std::vector<GLuint> retired_buffers;
+	uint64_t frame = 0;
+	uint64_t stall_count = 0;
+
+	StreamingBuffer();
+	StreamingBuffer(const StreamingBuffer&);
+	StreamingBuffer& operator = (const StreamingBuffer&);
+
+	void create();
+};
@@ -2,6 +2,10 @@
 #include <glad/glad.h>
 #include <string>
 #include <iostream>
+#include <algorithm>
+
+#include <GLRF/GLStateCache.hpp>
+#include <GLRF/GLCapabilities.hpp>
 
 namespace GLRF {
 	static std::string defaultLibrary = "./textures/";
@@ -62,11 +66,19 @@ public:
 	 * @return false else
 	 */
 	bool isSuccessfullyLoaded();
+
+	/**
+	 * @brief Returns the texture identifier.
+	 * 
+	 */
+	GLuint getID();
 private:
 	GLuint ID;
 	int width, height, nrChannels;
 	unsigned char * data;
 	std::string library, relativePath;
 	bool successfullyLoaded = false;
+	bool storageAllocated = false;
 	void create(std::string library, std::string relativePath);
+	void createObject();
 };
@@ -0,0 +1,145 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+namespace GLRF {
+	/**
+	 * @brief The binding points of the uniform blocks that are shared between all shader programs.
+	 * 
+	 */
+	enum UniformBlockBinding : GLuint {
+		SCENE_BLOCK_BINDING = 0,
+		DRAW_BLOCK_BINDING = 1,
+		MATERIAL_BLOCK_BINDING = 2
+	};
+
+	/**
+	 * @brief The binding points of the shader storage blocks that are shared between all shader programs.
+	 * 
+	 */
+	enum StorageBlockBinding : GLuint {
+		DRAW_STORAGE_BINDING = 0
+	};
+
+	/**
+	 * @brief The maximum number of point lights that are provided through the SceneData block.
+	 * 
+	 */
+	static const GLuint MAX_POINT_LIGHTS = 16;
+
+	struct SceneUniformBlock;
+	struct DrawUniformBlock;
+	struct MaterialUniformBlock;
+}
+
+/**
+ * @brief The std140 layout of the uniform block 'SceneData', which is updated once per frame by the Scene.
+ * 
+ * Shaders access it by declaring the following block:
+ * 
+ *     layout(std140) uniform SceneData {
+ *         mat4 view;
+ *         mat4 projection;
+ *         vec4 camera_position;
+ *         vec4 camera_view_dir;
+ *         vec4 pointLight_position[16];
+ *         vec4 pointLight_color_power[16]; // rgb = color, a = power
+ *         vec4 directionalLight_direction_power; // xyz = direction, w = power
+ *         uint pointLight_count;
+ *         uint useDirectionalLight;
+ *     };
+ * 
+ * Shaders without this block still receive the same values as individual uniforms.
+ */
+struct GLRF::SceneUniformBlock {
+	static constexpr const char * name = "SceneData";
+
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::vec4 camera_position;
+	glm::vec4 camera_view_dir;
+	glm::vec4 pointLight_position[MAX_POINT_LIGHTS];
+	glm::vec4 pointLight_color_power[MAX_POINT_LIGHTS];
+	glm::vec4 directionalLight_direction_power;
+	GLuint pointLight_count;
+	GLuint useDirectionalLight;
+	GLuint padding[2];
+};
+
+static_assert(sizeof(GLRF::SceneUniformBlock) % 16 == 0, "std140 blocks must be padded to a multiple of 16 bytes");
+
+/**
+ * @brief The std140 layout of the uniform block 'DrawData', which holds the values of a single draw.
+ * 
+ * The values of all draws of a frame are uploaded at once (see DrawDataBuffer) and bound per draw.
+ * Shaders access it by declaring the following block:
+ * 
+ *     layout(std140) uniform DrawData {
+ *         mat4 model;
+ *         mat3 model_normal;
+ *         uint material_index;
+ *     };
+ * 
+ * Shaders without this block still receive 'model' and 'model_normal' as individual uniforms.
+ * 
+ * Shaders that are drawn with multi-draw indirect (see IndirectDrawBuffer) read the same values
+ * from the shader storage block 'DrawDataArray' instead, selecting their draw by the base instance:
+ * 
+ *     struct DrawData { mat4 model; mat3 model_normal; uint material_index; };
+ *     layout(std430) readonly buffer DrawDataArray { DrawData draws[]; };
+ *     ...
+ *     DrawData draw_data = draws[gl_BaseInstanceARB + gl_InstanceID]; // gl_BaseInstance in GLSL 4.60
+ */
+struct GLRF::DrawUniformBlock {
+	static constexpr const char * name = "DrawData";
+	static constexpr const char * storage_name = "DrawDataArray";
+
+	glm::mat4 model;
+	glm::vec4 model_normal[3]; // std140 stores each column of a mat3 like a vec4
+	GLuint material_index;
+	GLuint padding[3];
+
+	void setModelNormal(const glm::mat3 & model_normal) {
+		for (int i = 0; i < 3; i++) this->model_normal[i] = glm::vec4(model_normal[i], 0.f);
+	}
+};
+
+static_assert(sizeof(GLRF::DrawUniformBlock) % 16 == 0, "std140 blocks must be padded to a multiple of 16 bytes");
+
+/**
+ * @brief The std140 layout of the uniform block 'MaterialData', which every Material keeps in its own buffer.
+ * 
+ * The buffer is only updated when a property of the material changes and bound whenever the material is drawn.
+ * Shaders access it by declaring the following block:
+ * 
+ *     layout(std140) uniform MaterialData {
+ *         vec4 albedo; // rgb = default value
+ *         vec4 normal; // rgb = default value
+ *         float roughness;
+ *         float metallic;
+ *         float ao;
+ *         float height;
+ *         float opacity;
+ *         float height_scale;
+ *         uint feature_mask; // a bit per MaterialFeature, e.g. (feature_mask & 1u) != 0u if albedo uses a texture
+ *     };
+ * 
+ * Shaders without this block still receive the values as individual uniforms of the struct 'material'.
+ * Textures are always provided through the samplers 'material.<property>.texture'.
+ */
+struct GLRF::MaterialUniformBlock {
+	static constexpr const char * name = "MaterialData";
+
+	glm::vec4 albedo;
+	glm::vec4 normal;
+	float roughness;
+	float metallic;
+	float ao;
+	float height;
+	float opacity;
+	float height_scale;
+	GLuint feature_mask;
+	GLuint padding;
+};
+
+static_assert(sizeof(GLRF::MaterialUniformBlock) % 16 == 0, "std140 blocks must be padded to a multiple of 16 bytes");
@@ -0,0 +1,63 @@
+#pragma once
+#include <glad/glad.h>
+#include <string>
+
+#include <GLRF/GLStateCache.hpp>
+#include <GLRF/GLCapabilities.hpp>
+
+namespace GLRF {
+	class UniformBuffer;
+}
+
+/**
+ * @brief A buffer object on the GPU that provides the data of uniform blocks to shaders.
+ * 
+ * The buffer is bound to indexed binding points, which are shared between all shader programs.
+ * Shader programs connect their uniform blocks to those binding points (see ShaderManager).
+ */
+class GLRF::UniformBuffer {
+public:
+	/**
+	 * @brief Construct a new UniformBuffer object.
+	 * 
+	 * @param size the size of the buffer in bytes
+	 * @param usage the OpenGL usage hint of the buffer - e.g. GL_DYNAMIC_DRAW
+	 */
+	UniformBuffer(GLsizeiptr size, GLenum usage = GL_DYNAMIC_DRAW);
+	~UniformBuffer();
+
+	UniformBuffer(const UniformBuffer&) = delete;
+	UniformBuffer& operator = (const UniformBuffer&) = delete;
+
+	/**
+	 * @brief Uploads data into the buffer.
+	 * 
+	 * @param data the data that will be copied into the buffer
+	 * @param size the size of the data in bytes
+	 * @param offset the offset in bytes from the start of the buffer
+	 */
+	void upload(const void * data, GLsizeiptr size, GLintptr offset = 0);
+
+	/**
+	 * @brief Binds the whole buffer to an indexed uniform buffer binding point.
+	 * 
+	 * @param binding the index of the binding point
+	 */
+	void bindBase(GLuint binding);
+
+	/**
+	 * @brief Binds a range of the buffer to an indexed uniform buffer binding point.
+	 * 
+	 * @param binding the index of the binding point
+	 * @param offset the offset in bytes (must be a multiple of GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT)
+	 * @param size the size of the range in bytes
+	 */
+	void bindRange(GLuint binding, GLintptr offset, GLsizeiptr size);
+
+	GLuint getID();
+	GLsizeiptr getSize();
+private:
+	GLuint ID;
+	GLsizeiptr size;
+	bool direct_state_access = false;
+};
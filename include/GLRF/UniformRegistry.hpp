@@ -0,0 +1,70 @@
+#pragma once
+#include <glad/glad.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace GLRF {
+	/**
+	 * @brief The interned identifier of a uniform name.
+	 * 
+	 * Identifiers are dense, start at 0 and stay valid for the lifetime of the application.
+	 */
+	typedef GLuint UniformId;
+
+	class UniformRegistry;
+}
+
+/**
+ * @brief Interns uniform names, so that they can be referred to by small integer identifiers.
+ * 
+ * Resolve identifiers once (e.g. in a static variable) and use them on hot paths instead of strings.
+ */
+class GLRF::UniformRegistry {
+public:
+	static UniformRegistry& getInstance() {
+		static UniformRegistry instance;
+		return instance;
+	}
+
+	~UniformRegistry();
+
+	/**
+	 * @brief Returns the identifier of the specified uniform name and registers it if it is new.
+	 * 
+	 * @param name the name of the uniform (e.g. 'model')
+	 * @return UniformId the identifier of the name
+	 */
+	UniformId intern(const std::string& name);
+
+	/**
+	 * @brief Looks up the identifier of the specified uniform name without registering it.
+	 * 
+	 * @param name the name of the uniform
+	 * @param id receives the identifier of the name if it was interned before
+	 * @return true if the name was interned before
+	 * @return false else
+	 */
+	bool find(const std::string& name, UniformId * id) const;
+
+	/**
+	 * @brief Returns the name of the specified identifier.
+	 * 
+	 * @param id a previously interned identifier
+	 * @return const std::string& the name of the uniform
+	 */
+	const std::string& getName(UniformId id) const;
+
+	/**
+	 * @brief Returns the number of interned names, which is also the upper bound of all identifiers.
+	 * 
+	 */
+	size_t size() const;
+private:
+	std::unordered_map<std::string, UniformId> ids;
+	std::vector<std::string> names;
+
+	UniformRegistry();
+	UniformRegistry(const UniformRegistry&);
+	UniformRegistry& operator = (const UniformRegistry&);
+};
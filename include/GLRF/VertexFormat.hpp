@@ -28,5 +28,47 @@ public:
 	VertexFormat(const glm::vec3 &position, const glm::vec3 &normal, const glm::vec2 &uv, const glm::vec3 &tangent);
 	~VertexFormat();
 
+	/**
+	 * @brief Describes the attributes of this format for the bound vertex array, which reads them from the bound array buffer.
+	 * 
+	 */
 	static void registerFormat();
+
+	/**
+	 * @brief Describes the attributes of this format for a vertex array without binding it (direct state access).
+	 * 
+	 * @param vertex_array the vertex array that will read vertices of this format
+	 * @param binding_index the vertex buffer binding point that the attributes read from
+	 */
+	static void registerFormat(GLuint vertex_array, GLuint binding_index);
+
+	/**
+	 * @brief Describes the attributes of this format for the bound vertex array with separate attribute formats,
+	 * which read from a vertex buffer binding point instead of the bound array buffer (see glBindVertexBuffer).
+	 * 
+	 * @param binding_index the vertex buffer binding point that the attributes read from
+	 */
+	static void registerSeparateFormat(GLuint binding_index);
+
+	/**
+	 * @brief Describes the per-instance attributes (see InstanceData) for the bound vertex array,
+	 * which reads them from the bound array buffer.
+	 * 
+	 */
+	static void registerInstanceFormat();
+
+	/**
+	 * @brief Describes the per-instance attributes (see InstanceData) for a vertex array without binding it (direct state access).
+	 * 
+	 * @param vertex_array the vertex array that will read the instances
+	 * @param binding_index the vertex buffer binding point that the attributes read from
+	 */
+	static void registerInstanceFormat(GLuint vertex_array, GLuint binding_index);
+
+	/**
+	 * @brief Describes the per-instance attributes (see InstanceData) for the bound vertex array with separate attribute formats.
+	 * 
+	 * @param binding_index the vertex buffer binding point that the attributes read from
+	 */
+	static void registerSeparateInstanceFormat(GLuint binding_index);
 };
\ No newline at end of file
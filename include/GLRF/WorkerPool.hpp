@@ -0,0 +1,69 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+
+namespace GLRF {
+	class WorkerPool;
+}
+
+/**
+ * @brief A fixed set of threads that split CPU work of a frame (e.g. the preparation of draws) into ranges.
+ *
+ * The threads are started with the first job that is large enough to be split and sleep in between jobs.
+ * The calling thread works on ranges as well, so the pool never holds more threads than there are cores.
+ * Jobs must not issue GL calls, as the context is only current on the calling thread.
+ */
+class GLRF::WorkerPool {
+public:
+	static WorkerPool& getInstance() {
+		static WorkerPool instance;
+		return instance;
+	}
+
+	~WorkerPool();
+
+	/**
+	 * @brief Returns the maximum number of ranges of a job, which is the number of worker threads plus the calling thread.
+	 *
+	 */
+	size_t getThreadCount();
+
+	/**
+	 * @brief Splits the indices [0, count) into consecutive ranges and processes them in parallel, returns after all
+	 * ranges were processed.
+	 *
+	 * Must only be called by one thread at a time and not from inside a job. If a range throws, the first exception
+	 * is rethrown after all other ranges finished.
+	 *
+	 * @param count the number of indices
+	 * @param min_range_size the minimum number of indices per range, smaller jobs run on the calling thread only
+	 * @param job called with the begin and the end of a range and the index of the range, which is smaller than
+	 * getThreadCount() and increases with the begin
+	 */
+	void parallelFor(size_t count, size_t min_range_size, const std::function<void(size_t, size_t, size_t)> & job);
+private:
+	std::vector<std::thread> threads;
+	size_t thread_count;
+	std::mutex mutex;
+	std::condition_variable job_available;
+	std::condition_variable job_finished;
+	const std::function<void(size_t, size_t, size_t)> * job = nullptr;
+	size_t count = 0;
+	size_t range_count = 0;
+	size_t next_range = 0;
+	size_t pending_ranges = 0;
+	std::exception_ptr exception;
+	bool stopping = false;
+
+	WorkerPool();
+	WorkerPool(const WorkerPool&);
+	WorkerPool& operator = (const WorkerPool&);
+
+	void run();
+	void runRange(size_t range_index);
+};
@@ -52,7 +52,7 @@ AppFrame::~AppFrame() {
 }
 
 void AppFrame::framebufferSizeCallback(GLFWwindow * window, int width, int height) {
-    glViewport(0, 0, width, height);
+    GLStateCache::getInstance().viewport(0, 0, width, height);
 }
 
 void AppFrame::processInput(GLFWwindow * window) {
@@ -70,8 +70,11 @@ bool AppFrame::render() {
     while(!glfwWindowShouldClose(this->window)) {
         glfwSetCursorPosCallback(this->window, mouse_callback);
         this->app->processUserInput(this->window, Mouse::getInstance().getOffset());
+        StreamingBuffer::getInstance().beginFrame();
         this->app->updateScene();
+        GLStateCache::getInstance().beginFrame();
         this->app->render();
+        StreamingBuffer::getInstance().endFrame();
         glfwSwapBuffers(this->window);
     }
     glfwTerminate();
@@ -0,0 +1,562 @@
+#include <GLRF/BoundingVolumeHierarchy.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace GLRF;
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy(float margin)
+{
+	this->margin = margin;
+}
+
+BoundingVolumeHierarchy::~BoundingVolumeHierarchy()
+{
+
+}
+
+float BoundingVolumeHierarchy::area(const BoundingBox & box)
+{
+	glm::vec3 size = box.max - box.min;
+	return 2.f * (size.x * size.y + size.y * size.z + size.z * size.x);
+}
+
+BoundingBox BoundingVolumeHierarchy::merge(const BoundingBox & a, const BoundingBox & b)
+{
+	BoundingBox box;
+	box.min = glm::min(a.min, b.min);
+	box.max = glm::max(a.max, b.max);
+	return box;
+}
+
+bool BoundingVolumeHierarchy::contains(const BoundingBox & outer, const BoundingBox & inner)
+{
+	return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z
+		&& outer.max.x >= inner.max.x && outer.max.y >= inner.max.y && outer.max.z >= inner.max.z;
+}
+
+bool BoundingVolumeHierarchy::overlaps(const BoundingBox & a, const BoundingBox & b)
+{
+	return a.min.x <= b.max.x && a.min.y <= b.max.y && a.min.z <= b.max.z
+		&& b.min.x <= a.max.x && b.min.y <= a.max.y && b.min.z <= a.max.z;
+}
+
+int32_t BoundingVolumeHierarchy::allocateNode()
+{
+	int32_t index;
+	if (this->free_list != NULL_NODE)
+	{
+		index = this->free_list;
+		this->free_list = this->nodes[index].next;
+	}
+	else
+	{
+		index = static_cast<int32_t>(this->nodes.size());
+		this->nodes.emplace_back();
+	}
+	this->nodes[index] = Node();
+	this->nodes[index].allocated = true;
+	return index;
+}
+
+void BoundingVolumeHierarchy::freeNode(int32_t index)
+{
+	this->nodes[index].allocated = false;
+	this->nodes[index].next = this->free_list;
+	this->free_list = index;
+}
+
+int32_t BoundingVolumeHierarchy::insert(const BoundingBox & box)
+{
+	int32_t leaf = allocateNode();
+	this->nodes[leaf].box.min = box.min - glm::vec3(this->margin);
+	this->nodes[leaf].box.max = box.max + glm::vec3(this->margin);
+	insertLeaf(leaf);
+	this->leaf_count++;
+	return leaf;
+}
+
+void BoundingVolumeHierarchy::remove(int32_t proxy)
+{
+	removeLeaf(proxy);
+	freeNode(proxy);
+	this->leaf_count--;
+}
+
+bool BoundingVolumeHierarchy::update(int32_t proxy, const BoundingBox & box)
+{
+	if (contains(this->nodes[proxy].box, box)) return false;
+	removeLeaf(proxy);
+	this->nodes[proxy].box.min = box.min - glm::vec3(this->margin);
+	this->nodes[proxy].box.max = box.max + glm::vec3(this->margin);
+	insertLeaf(proxy);
+	return true;
+}
+
+int32_t BoundingVolumeHierarchy::findBestSibling(const BoundingBox & box)
+{
+	// the cost of a sibling is the area of the new parent plus the growth of all ancestors,
+	// a subtree is skipped if even a perfect fit inside of it cannot be cheaper than the best sibling
+	float box_area = area(box);
+	int32_t best = this->root;
+	float best_cost = area(merge(box, this->nodes[this->root].box));
+
+	std::vector<std::pair<int32_t, float>> candidates;
+	candidates.push_back({ this->root, 0.f });
+	while (!candidates.empty())
+	{
+		auto [index, inherited_cost] = candidates.back();
+		candidates.pop_back();
+		const Node & node = this->nodes[index];
+		float direct_cost = area(merge(box, node.box));
+		float cost = direct_cost + inherited_cost;
+		if (cost < best_cost)
+		{
+			best = index;
+			best_cost = cost;
+		}
+
+		float child_inherited_cost = inherited_cost + direct_cost - area(node.box);
+		if (!node.isLeaf() && box_area + child_inherited_cost < best_cost)
+		{
+			candidates.push_back({ node.child1, child_inherited_cost });
+			candidates.push_back({ node.child2, child_inherited_cost });
+		}
+	}
+	return best;
+}
+
+void BoundingVolumeHierarchy::insertLeaf(int32_t leaf)
+{
+	if (this->root == NULL_NODE)
+	{
+		this->root = leaf;
+		this->nodes[leaf].parent = NULL_NODE;
+		return;
+	}
+
+	int32_t sibling = findBestSibling(this->nodes[leaf].box);
+	int32_t old_parent = this->nodes[sibling].parent;
+	int32_t new_parent = allocateNode();
+	Node & parent = this->nodes[new_parent];
+	parent.parent = old_parent;
+	parent.box = merge(this->nodes[leaf].box, this->nodes[sibling].box);
+	parent.child1 = sibling;
+	parent.child2 = leaf;
+	this->nodes[sibling].parent = new_parent;
+	this->nodes[leaf].parent = new_parent;
+
+	if (old_parent == NULL_NODE)
+	{
+		this->root = new_parent;
+	}
+	else if (this->nodes[old_parent].child1 == sibling)
+	{
+		this->nodes[old_parent].child1 = new_parent;
+	}
+	else
+	{
+		this->nodes[old_parent].child2 = new_parent;
+	}
+	refit(old_parent);
+}
+
+void BoundingVolumeHierarchy::removeLeaf(int32_t leaf)
+{
+	if (leaf == this->root)
+	{
+		this->root = NULL_NODE;
+		return;
+	}
+
+	int32_t parent = this->nodes[leaf].parent;
+	int32_t grandparent = this->nodes[parent].parent;
+	int32_t sibling = this->nodes[parent].child1 == leaf ? this->nodes[parent].child2 : this->nodes[parent].child1;
+	freeNode(parent);
+	this->nodes[leaf].parent = NULL_NODE;
+
+	if (grandparent == NULL_NODE)
+	{
+		this->root = sibling;
+		this->nodes[sibling].parent = NULL_NODE;
+		return;
+	}
+	if (this->nodes[grandparent].child1 == parent)
+	{
+		this->nodes[grandparent].child1 = sibling;
+	}
+	else
+	{
+		this->nodes[grandparent].child2 = sibling;
+	}
+	this->nodes[sibling].parent = grandparent;
+	refit(grandparent);
+}
+
+void BoundingVolumeHierarchy::refit(int32_t index)
+{
+	while (index != NULL_NODE)
+	{
+		Node & node = this->nodes[index];
+		node.box = merge(this->nodes[node.child1].box, this->nodes[node.child2].box);
+		rotate(index);
+		index = node.parent;
+	}
+}
+
+void BoundingVolumeHierarchy::rotate(int32_t index)
+{
+	// a child is swapped with a grandchild of the other child, which only changes the box of that other child
+	Node & node = this->nodes[index];
+	int32_t b = node.child1;
+	int32_t c = node.child2;
+	const Node & node_b = this->nodes[b];
+	const Node & node_c = this->nodes[c];
+
+	enum { NONE, B_F, B_G, C_D, C_E } best_rotation = NONE;
+	float best_difference = 0.f;
+	if (!node_c.isLeaf())
+	{
+		float area_c = area(node_c.box);
+		float difference = area(merge(node_b.box, this->nodes[node_c.child2].box)) - area_c;
+		if (difference < best_difference) { best_rotation = B_F; best_difference = difference; }
+		difference = area(merge(node_b.box, this->nodes[node_c.child1].box)) - area_c;
+		if (difference < best_difference) { best_rotation = B_G; best_difference = difference; }
+	}
+	if (!node_b.isLeaf())
+	{
+		float area_b = area(node_b.box);
+		float difference = area(merge(node_c.box, this->nodes[node_b.child2].box)) - area_b;
+		if (difference < best_difference) { best_rotation = C_D; best_difference = difference; }
+		difference = area(merge(node_c.box, this->nodes[node_b.child1].box)) - area_b;
+		if (difference < best_difference) { best_rotation = C_E; best_difference = difference; }
+	}
+	if (best_rotation == NONE) return;
+
+	// swap 'child' of the node with 'grandchild', which is a child of 'other'
+	int32_t child, other, grandchild;
+	switch (best_rotation)
+	{
+	case B_F: child = b; other = c; grandchild = node_c.child1; break;
+	case B_G: child = b; other = c; grandchild = node_c.child2; break;
+	case C_D: child = c; other = b; grandchild = node_b.child1; break;
+	default: child = c; other = b; grandchild = node_b.child2; break;
+	}
+	if (node.child1 == child) node.child1 = grandchild; else node.child2 = grandchild;
+	this->nodes[grandchild].parent = index;
+
+	Node & other_node = this->nodes[other];
+	if (other_node.child1 == grandchild) other_node.child1 = child; else other_node.child2 = child;
+	this->nodes[child].parent = other;
+	other_node.box = merge(this->nodes[other_node.child1].box, this->nodes[other_node.child2].box);
+}
+
+void BoundingVolumeHierarchy::build(const std::vector<BoundingBox> & boxes, std::vector<int32_t> * proxies)
+{
+	clear();
+	proxies->resize(boxes.size());
+	std::vector<int32_t> leaves(boxes.size());
+	for (size_t i = 0; i < boxes.size(); i++)
+	{
+		int32_t leaf = allocateNode();
+		this->nodes[leaf].box.min = boxes[i].min - glm::vec3(this->margin);
+		this->nodes[leaf].box.max = boxes[i].max + glm::vec3(this->margin);
+		leaves[i] = leaf;
+		(*proxies)[i] = leaf;
+	}
+	this->leaf_count = boxes.size();
+	if (!leaves.empty())
+	{
+		this->root = buildRange(leaves, 0, leaves.size());
+		this->nodes[this->root].parent = NULL_NODE;
+	}
+}
+
+int32_t BoundingVolumeHierarchy::buildRange(std::vector<int32_t> & leaves, size_t begin, size_t end)
+{
+	if (end - begin == 1) return leaves[begin];
+
+	// the centroids are sorted into bins along the longest axis, the split between two bins with the lowest SAH cost wins
+	constexpr int BIN_COUNT = 16;
+	BoundingBox centroid_bounds;
+	centroid_bounds.min = glm::vec3(std::numeric_limits<float>::max());
+	centroid_bounds.max = glm::vec3(std::numeric_limits<float>::lowest());
+	for (size_t i = begin; i < end; i++)
+	{
+		glm::vec3 centroid = this->nodes[leaves[i]].box.getCenter();
+		centroid_bounds.min = glm::min(centroid_bounds.min, centroid);
+		centroid_bounds.max = glm::max(centroid_bounds.max, centroid);
+	}
+	glm::vec3 extent = centroid_bounds.max - centroid_bounds.min;
+	int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+
+	size_t middle = begin + (end - begin) / 2;
+	if (extent[axis] > 0.f)
+	{
+		BoundingBox bin_boxes[BIN_COUNT];
+		size_t bin_counts[BIN_COUNT] = { 0 };
+		float scale = BIN_COUNT / extent[axis];
+		auto binOf = [&](int32_t leaf) {
+			int bin = static_cast<int>((this->nodes[leaf].box.getCenter()[axis] - centroid_bounds.min[axis]) * scale);
+			return std::min(bin, BIN_COUNT - 1);
+		};
+		for (size_t i = begin; i < end; i++)
+		{
+			int bin = binOf(leaves[i]);
+			bin_boxes[bin] = bin_counts[bin] == 0 ? this->nodes[leaves[i]].box : merge(bin_boxes[bin], this->nodes[leaves[i]].box);
+			bin_counts[bin]++;
+		}
+
+		// sweep from the right to know the area and count of every right side, then from the left to evaluate every split
+		float right_areas[BIN_COUNT];
+		size_t right_counts[BIN_COUNT];
+		BoundingBox right_box;
+		size_t right_count = 0;
+		for (int bin = BIN_COUNT - 1; bin > 0; bin--)
+		{
+			if (bin_counts[bin] > 0) right_box = right_count == 0 ? bin_boxes[bin] : merge(right_box, bin_boxes[bin]);
+			right_count += bin_counts[bin];
+			right_areas[bin] = right_count > 0 ? area(right_box) : 0.f;
+			right_counts[bin] = right_count;
+		}
+		int best_split = -1;
+		float best_cost = std::numeric_limits<float>::max();
+		BoundingBox left_box;
+		size_t left_count = 0;
+		for (int bin = 0; bin < BIN_COUNT - 1; bin++)
+		{
+			if (bin_counts[bin] > 0) left_box = left_count == 0 ? bin_boxes[bin] : merge(left_box, bin_boxes[bin]);
+			left_count += bin_counts[bin];
+			if (left_count == 0 || right_counts[bin + 1] == 0) continue;
+			float cost = area(left_box) * left_count + right_areas[bin + 1] * right_counts[bin + 1];
+			if (cost < best_cost)
+			{
+				best_cost = cost;
+				best_split = bin;
+			}
+		}
+		if (best_split >= 0)
+		{
+			auto split = std::partition(leaves.begin() + begin, leaves.begin() + end,
+				[&](int32_t leaf) { return binOf(leaf) <= best_split; });
+			middle = static_cast<size_t>(split - leaves.begin());
+		}
+	}
+
+	int32_t child1 = buildRange(leaves, begin, middle);
+	int32_t child2 = buildRange(leaves, middle, end);
+	int32_t index = allocateNode();
+	Node & node = this->nodes[index];
+	node.child1 = child1;
+	node.child2 = child2;
+	node.box = merge(this->nodes[child1].box, this->nodes[child2].box);
+	this->nodes[child1].parent = index;
+	this->nodes[child2].parent = index;
+	return index;
+}
+
+void BoundingVolumeHierarchy::clear()
+{
+	this->nodes.clear();
+	this->root = NULL_NODE;
+	this->free_list = NULL_NODE;
+	this->leaf_count = 0;
+}
+
+const BoundingBox & BoundingVolumeHierarchy::getBox(int32_t proxy) const
+{
+	return this->nodes[proxy].box;
+}
+
+size_t BoundingVolumeHierarchy::getProxyCount() const
+{
+	return this->leaf_count;
+}
+
+int BoundingVolumeHierarchy::getHeight() const
+{
+	return this->root == NULL_NODE ? 0 : getHeight(this->root);
+}
+
+int BoundingVolumeHierarchy::getHeight(int32_t index) const
+{
+	const Node & node = this->nodes[index];
+	if (node.isLeaf()) return 1;
+	return 1 + std::max(getHeight(node.child1), getHeight(node.child2));
+}
+
+float BoundingVolumeHierarchy::getCost() const
+{
+	float cost = 0.f;
+	for (const Node & node : this->nodes)
+	{
+		if (node.allocated && !node.isLeaf()) cost += area(node.box);
+	}
+	return cost;
+}
+
+size_t BoundingVolumeHierarchy::getProxyCapacity() const
+{
+	return this->nodes.size();
+}
+
+void BoundingVolumeHierarchy::addLeaves(int32_t index, std::vector<int32_t> & proxies) const
+{
+	std::vector<int32_t> stack;
+	stack.push_back(index);
+	while (!stack.empty())
+	{
+		int32_t current = stack.back();
+		stack.pop_back();
+		const Node & node = this->nodes[current];
+		if (node.isLeaf())
+		{
+			proxies.push_back(current);
+			continue;
+		}
+		stack.push_back(node.child2);
+		stack.push_back(node.child1);
+	}
+}
+
+void BoundingVolumeHierarchy::query(const Frustum & frustum, std::vector<int32_t> & proxies) const
+{
+	if (this->root == NULL_NODE) return;
+
+	// every entry holds a node and the mask of the planes that still intersect its parent
+	std::vector<std::pair<int32_t, uint32_t>> candidates;
+	candidates.push_back({ this->root, (1u << Frustum::PLANE_COUNT) - 1 });
+	while (!candidates.empty())
+	{
+		auto [index, mask] = candidates.back();
+		candidates.pop_back();
+		const Node & node = this->nodes[index];
+
+		bool outside = false;
+		for (size_t p = 0; p < Frustum::PLANE_COUNT; p++)
+		{
+			if (!(mask & (1u << p))) continue;
+			const glm::vec4 & plane = frustum.getPlane(p);
+			glm::vec3 normal = glm::vec3(plane);
+			glm::vec3 center = node.box.getCenter();
+			glm::vec3 extent = node.box.getExtent();
+			float distance = glm::dot(normal, center) + plane.w;
+			float radius = glm::dot(glm::abs(normal), extent);
+			if (distance < -radius)
+			{
+				outside = true;
+				break;
+			}
+			if (distance >= radius) mask &= ~(1u << p);
+		}
+		if (outside) continue;
+		if (mask == 0)
+		{
+			addLeaves(index, proxies);
+			continue;
+		}
+		if (node.isLeaf())
+		{
+			proxies.push_back(index);
+			continue;
+		}
+		candidates.push_back({ node.child2, mask });
+		candidates.push_back({ node.child1, mask });
+	}
+}
+
+void BoundingVolumeHierarchy::query(const BoundingSphere & sphere, std::vector<int32_t> & proxies) const
+{
+	if (this->root == NULL_NODE) return;
+	float radius2 = sphere.radius * sphere.radius;
+	std::vector<int32_t> stack;
+	stack.push_back(this->root);
+	while (!stack.empty())
+	{
+		int32_t index = stack.back();
+		stack.pop_back();
+		const Node & node = this->nodes[index];
+		glm::vec3 closest = glm::clamp(sphere.center, node.box.min, node.box.max);
+		glm::vec3 offset = closest - sphere.center;
+		if (glm::dot(offset, offset) > radius2) continue;
+		if (node.isLeaf())
+		{
+			proxies.push_back(index);
+			continue;
+		}
+		stack.push_back(node.child2);
+		stack.push_back(node.child1);
+	}
+}
+
+void BoundingVolumeHierarchy::query(const BoundingBox & box, std::vector<int32_t> & proxies) const
+{
+	if (this->root == NULL_NODE) return;
+	std::vector<int32_t> stack;
+	stack.push_back(this->root);
+	while (!stack.empty())
+	{
+		int32_t index = stack.back();
+		stack.pop_back();
+		const Node & node = this->nodes[index];
+		if (!overlaps(node.box, box)) continue;
+		if (node.isLeaf())
+		{
+			proxies.push_back(index);
+			continue;
+		}
+		stack.push_back(node.child2);
+		stack.push_back(node.child1);
+	}
+}
+
+void BoundingVolumeHierarchy::raycast(const glm::vec3 & origin, const glm::vec3 & direction, float max_distance,
+	std::vector<int32_t> & proxies) const
+{
+	if (this->root == NULL_NODE) return;
+
+	// slab test, divisions by zero produce infinities that compare correctly
+	glm::vec3 inverse_direction = 1.f / direction;
+	std::vector<int32_t> stack;
+	stack.push_back(this->root);
+	while (!stack.empty())
+	{
+		int32_t index = stack.back();
+		stack.pop_back();
+		const Node & node = this->nodes[index];
+		glm::vec3 t1 = (node.box.min - origin) * inverse_direction;
+		glm::vec3 t2 = (node.box.max - origin) * inverse_direction;
+		glm::vec3 t_near = glm::min(t1, t2);
+		glm::vec3 t_far = glm::max(t1, t2);
+		float enter = std::max(std::max(t_near.x, t_near.y), std::max(t_near.z, 0.f));
+		float exit = std::min(std::min(t_far.x, t_far.y), std::min(t_far.z, max_distance));
+		if (!(enter <= exit)) continue;
+		if (node.isLeaf())
+		{
+			proxies.push_back(index);
+			continue;
+		}
+		stack.push_back(node.child2);
+		stack.push_back(node.child1);
+	}
+}
+
+bool BoundingVolumeHierarchy::validate() const
+{
+	if (this->root == NULL_NODE) return this->leaf_count == 0;
+	if (this->nodes[this->root].parent != NULL_NODE) return false;
+	return validate(this->root);
+}
+
+bool BoundingVolumeHierarchy::validate(int32_t index) const
+{
+	const Node & node = this->nodes[index];
+	if (!node.allocated) return false;
+	if (node.isLeaf()) return node.child2 == NULL_NODE;
+	const Node & child1 = this->nodes[node.child1];
+	const Node & child2 = this->nodes[node.child2];
+	if (child1.parent != index || child2.parent != index) return false;
+	if (!contains(node.box, child1.box) || !contains(node.box, child2.box)) return false;
+	return validate(node.child1) && validate(node.child2);
+}
@@ -0,0 +1,152 @@
+#include <GLRF/Bounds.hpp>
+
+#include <cmath>
+#include <algorithm>
+
+#ifdef GLRF_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace GLRF;
+
+namespace {
+	const glm::vec3 * positionAt(const glm::vec3 * positions, size_t index, size_t stride)
+	{
+		return reinterpret_cast<const glm::vec3 *>(reinterpret_cast<const unsigned char *>(positions) + index * stride);
+	}
+
+#ifdef GLRF_SSE2
+	// loads x, y and z without reading past the position, the last lane is zero
+	__m128 loadPosition(const glm::vec3 * position)
+	{
+		const float * p = &position->x;
+		__m128 xy = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double *>(p)));
+		return _mm_movelh_ps(xy, _mm_load_ss(p + 2));
+	}
+
+	float horizontalMin(__m128 v)
+	{
+		v = _mm_min_ps(v, _mm_movehl_ps(v, v));
+		v = _mm_min_ss(v, _mm_shuffle_ps(v, v, 1));
+		return _mm_cvtss_f32(v);
+	}
+
+	float horizontalMax(__m128 v)
+	{
+		v = _mm_max_ps(v, _mm_movehl_ps(v, v));
+		v = _mm_max_ss(v, _mm_shuffle_ps(v, v, 1));
+		return _mm_cvtss_f32(v);
+	}
+#endif
+}
+
+Bounds GLRF::computeBounds(const glm::vec3 * positions, size_t count, size_t stride)
+{
+	Bounds bounds;
+	if (count == 0) return bounds;
+
+	glm::vec3 min = *positions;
+	glm::vec3 max = *positions;
+	size_t i = 0;
+#ifdef GLRF_SSE2
+	// four positions are transposed into one register per axis, so every lane reduces its own positions
+	__m128 min_x = _mm_set1_ps(min.x), min_y = _mm_set1_ps(min.y), min_z = _mm_set1_ps(min.z);
+	__m128 max_x = min_x, max_y = min_y, max_z = min_z;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 x = loadPosition(positionAt(positions, i, stride));
+		__m128 y = loadPosition(positionAt(positions, i + 1, stride));
+		__m128 z = loadPosition(positionAt(positions, i + 2, stride));
+		__m128 w = loadPosition(positionAt(positions, i + 3, stride));
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+		min_x = _mm_min_ps(min_x, x); max_x = _mm_max_ps(max_x, x);
+		min_y = _mm_min_ps(min_y, y); max_y = _mm_max_ps(max_y, y);
+		min_z = _mm_min_ps(min_z, z); max_z = _mm_max_ps(max_z, z);
+	}
+	min = glm::vec3(horizontalMin(min_x), horizontalMin(min_y), horizontalMin(min_z));
+	max = glm::vec3(horizontalMax(max_x), horizontalMax(max_y), horizontalMax(max_z));
+#endif
+	for (; i < count; i++)
+	{
+		const glm::vec3 & p = *positionAt(positions, i, stride);
+		min = glm::min(min, p);
+		max = glm::max(max, p);
+	}
+	bounds.box.min = min;
+	bounds.box.max = max;
+
+	glm::vec3 center = bounds.box.getCenter();
+	float max_distance2 = 0.f;
+	i = 0;
+#ifdef GLRF_SSE2
+	__m128 center_x = _mm_set1_ps(center.x), center_y = _mm_set1_ps(center.y), center_z = _mm_set1_ps(center.z);
+	__m128 max_d2 = _mm_setzero_ps();
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 x = loadPosition(positionAt(positions, i, stride));
+		__m128 y = loadPosition(positionAt(positions, i + 1, stride));
+		__m128 z = loadPosition(positionAt(positions, i + 2, stride));
+		__m128 w = loadPosition(positionAt(positions, i + 3, stride));
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+		__m128 dx = _mm_sub_ps(x, center_x);
+		__m128 dy = _mm_sub_ps(y, center_y);
+		__m128 dz = _mm_sub_ps(z, center_z);
+		__m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+		max_d2 = _mm_max_ps(max_d2, d2);
+	}
+	max_distance2 = horizontalMax(max_d2);
+#endif
+	for (; i < count; i++)
+	{
+		glm::vec3 d = *positionAt(positions, i, stride) - center;
+		max_distance2 = std::max(max_distance2, glm::dot(d, d));
+	}
+	bounds.sphere.center = center;
+	bounds.sphere.radius = std::sqrt(max_distance2);
+	return bounds;
+}
+
+void GLRF::growBounds(Bounds * bounds, const glm::vec3 * positions, size_t count, size_t stride)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		const glm::vec3 & p = *positionAt(positions, i, stride);
+		bounds->box.min = glm::min(bounds->box.min, p);
+		bounds->box.max = glm::max(bounds->box.max, p);
+
+		// the new sphere touches the far side of the old sphere and the position
+		glm::vec3 offset = p - bounds->sphere.center;
+		float distance2 = glm::dot(offset, offset);
+		if (distance2 <= bounds->sphere.radius * bounds->sphere.radius) continue;
+		float distance = std::sqrt(distance2);
+		float radius = 0.5f * (bounds->sphere.radius + distance);
+		bounds->sphere.center += offset * ((radius - bounds->sphere.radius) / distance);
+		bounds->sphere.radius = radius;
+	}
+}
+
+BoundingBox BoundingBox::transform(const glm::mat4 & matrix) const
+{
+	// the extent along each axis is the sum of the absolute projections of the local extents
+	glm::vec3 center = glm::vec3(matrix * glm::vec4(getCenter(), 1.f));
+	glm::vec3 extent = getExtent();
+	glm::vec3 world_extent = glm::abs(glm::vec3(matrix[0])) * extent.x
+		+ glm::abs(glm::vec3(matrix[1])) * extent.y
+		+ glm::abs(glm::vec3(matrix[2])) * extent.z;
+
+	BoundingBox box;
+	box.min = center - world_extent;
+	box.max = center + world_extent;
+	return box;
+}
+
+BoundingSphere BoundingSphere::transform(const glm::mat4 & matrix) const
+{
+	float scale2 = std::max(glm::dot(glm::vec3(matrix[0]), glm::vec3(matrix[0])),
+		std::max(glm::dot(glm::vec3(matrix[1]), glm::vec3(matrix[1])), glm::dot(glm::vec3(matrix[2]), glm::vec3(matrix[2]))));
+
+	BoundingSphere sphere;
+	sphere.center = glm::vec3(matrix * glm::vec4(this->center, 1.f));
+	sphere.radius = this->radius * std::sqrt(scale2);
+	return sphere;
+}
@@ -0,0 +1,266 @@
+#include <GLRF/BufferAllocator.hpp>
+
+using namespace GLRF;
+
+BufferAllocator::BufferAllocator(uint64_t capacity)
+{
+	this->capacity = capacity;
+	for (uint32_t fl = 0; fl < FL_COUNT; fl++)
+	{
+		this->sl_bitmaps[fl] = 0;
+		for (uint32_t sl = 0; sl < SL_COUNT; sl++) this->free_heads[fl][sl] = NO_BLOCK;
+	}
+
+	this->first_block = createBlock(0, capacity);
+	if (capacity > 0) insertFree(this->first_block);
+}
+
+BufferAllocator::~BufferAllocator()
+{
+
+}
+
+uint32_t BufferAllocator::floorLog2(uint64_t value)
+{
+	uint32_t result = 0;
+	while (value >>= 1) result++;
+	return result;
+}
+
+void BufferAllocator::mapping(uint64_t size, uint32_t * fl, uint32_t * sl)
+{
+	if (size < SL_COUNT)
+	{
+		// small sizes are mapped linearly into the first level
+		*fl = 0;
+		*sl = static_cast<uint32_t>(size);
+		return;
+	}
+	uint32_t log2 = floorLog2(size);
+	*fl = log2 - SL_BITS + 1;
+	*sl = static_cast<uint32_t>(size >> (log2 - SL_BITS)) ^ SL_COUNT;
+}
+
+uint32_t BufferAllocator::createBlock(uint64_t offset, uint64_t size)
+{
+	Block block = { offset, size, NO_BLOCK, NO_BLOCK, NO_BLOCK, NO_BLOCK, false };
+	if (!this->unused_blocks.empty())
+	{
+		uint32_t index = this->unused_blocks.back();
+		this->unused_blocks.pop_back();
+		this->blocks[index] = block;
+		return index;
+	}
+	this->blocks.push_back(block);
+	return static_cast<uint32_t>(this->blocks.size() - 1);
+}
+
+void BufferAllocator::releaseBlock(uint32_t block)
+{
+	this->unused_blocks.push_back(block);
+}
+
+void BufferAllocator::insertFree(uint32_t index)
+{
+	Block & block = this->blocks[index];
+	uint32_t fl, sl;
+	mapping(block.size, &fl, &sl);
+
+	block.free = true;
+	block.prev_free = NO_BLOCK;
+	block.next_free = this->free_heads[fl][sl];
+	if (block.next_free != NO_BLOCK) this->blocks[block.next_free].prev_free = index;
+	this->free_heads[fl][sl] = index;
+	this->fl_bitmap |= 1ull << fl;
+	this->sl_bitmaps[fl] |= 1u << sl;
+}
+
+void BufferAllocator::removeFree(uint32_t index)
+{
+	Block & block = this->blocks[index];
+	uint32_t fl, sl;
+	mapping(block.size, &fl, &sl);
+
+	if (block.prev_free != NO_BLOCK) this->blocks[block.prev_free].next_free = block.next_free;
+	if (block.next_free != NO_BLOCK) this->blocks[block.next_free].prev_free = block.prev_free;
+	if (this->free_heads[fl][sl] == index)
+	{
+		this->free_heads[fl][sl] = block.next_free;
+		if (block.next_free == NO_BLOCK)
+		{
+			this->sl_bitmaps[fl] &= ~(1u << sl);
+			if (this->sl_bitmaps[fl] == 0) this->fl_bitmap &= ~(1ull << fl);
+		}
+	}
+	block.free = false;
+	block.prev_free = NO_BLOCK;
+	block.next_free = NO_BLOCK;
+}
+
+uint32_t BufferAllocator::findFree(uint64_t size)
+{
+	// round up to the next class, so that every block of the found class is large enough
+	uint64_t rounded_size = size;
+	if (size >= SL_COUNT) rounded_size += (1ull << (floorLog2(size) - SL_BITS)) - 1;
+	uint32_t fl, sl;
+	mapping(rounded_size, &fl, &sl);
+
+	uint32_t sl_map = (fl < FL_COUNT) ? this->sl_bitmaps[fl] & (~0u << sl) : 0;
+	uint64_t fl_map = (fl + 1 < FL_COUNT) ? this->fl_bitmap & (~0ull << (fl + 1)) : 0;
+	if (sl_map == 0 && fl_map != 0)
+	{
+		fl = floorLog2(fl_map & (~fl_map + 1));
+		sl_map = this->sl_bitmaps[fl];
+	}
+	if (sl_map != 0)
+	{
+		sl = floorLog2(sl_map & (~sl_map + 1));
+		return this->free_heads[fl][sl];
+	}
+
+	// only the class of the size itself is left, which may hold blocks that are just large enough
+	mapping(size, &fl, &sl);
+	if (fl >= FL_COUNT) return NO_BLOCK;
+	for (uint32_t index = this->free_heads[fl][sl]; index != NO_BLOCK; index = this->blocks[index].next_free)
+	{
+		if (this->blocks[index].size >= size) return index;
+	}
+	return NO_BLOCK;
+}
+
+void BufferAllocator::mergeWithNext(uint32_t index)
+{
+	Block & block = this->blocks[index];
+	uint32_t next = block.next_physical;
+	block.size += this->blocks[next].size;
+	block.next_physical = this->blocks[next].next_physical;
+	if (block.next_physical != NO_BLOCK) this->blocks[block.next_physical].prev_physical = index;
+	releaseBlock(next);
+}
+
+BufferAllocator::Handle BufferAllocator::allocate(uint64_t size)
+{
+	if (size == 0) return INVALID_HANDLE;
+	uint32_t index = findFree(size);
+	if (index == NO_BLOCK) return INVALID_HANDLE;
+	removeFree(index);
+
+	// split off the remainder as a new free block
+	if (this->blocks[index].size > size)
+	{
+		uint32_t remainder = createBlock(this->blocks[index].offset + size, this->blocks[index].size - size);
+		Block & block = this->blocks[index];
+		block.size = size;
+		this->blocks[remainder].prev_physical = index;
+		this->blocks[remainder].next_physical = block.next_physical;
+		if (block.next_physical != NO_BLOCK) this->blocks[block.next_physical].prev_physical = remainder;
+		block.next_physical = remainder;
+		insertFree(remainder);
+	}
+	return index;
+}
+
+void BufferAllocator::free(Handle handle)
+{
+	uint32_t index = handle;
+	uint32_t next = this->blocks[index].next_physical;
+	if (next != NO_BLOCK && this->blocks[next].free)
+	{
+		removeFree(next);
+		mergeWithNext(index);
+	}
+	uint32_t prev = this->blocks[index].prev_physical;
+	if (prev != NO_BLOCK && this->blocks[prev].free)
+	{
+		removeFree(prev);
+		mergeWithNext(prev);
+		index = prev;
+	}
+	insertFree(index);
+}
+
+uint64_t BufferAllocator::getOffset(Handle handle)
+{
+	return this->blocks[handle].offset;
+}
+
+uint64_t BufferAllocator::getSize(Handle handle)
+{
+	return this->blocks[handle].size;
+}
+
+uint64_t BufferAllocator::getCapacity()
+{
+	return this->capacity;
+}
+
+std::vector<BufferAllocator::Move> BufferAllocator::compact()
+{
+	std::vector<Move> moves;
+	uint64_t cursor = 0;
+	uint32_t last_used = NO_BLOCK;
+	uint32_t first_used = NO_BLOCK;
+
+	for (uint32_t index = this->first_block; index != NO_BLOCK;)
+	{
+		uint32_t next = this->blocks[index].next_physical;
+		Block & block = this->blocks[index];
+		if (block.free)
+		{
+			removeFree(index);
+			releaseBlock(index);
+		}
+		else
+		{
+			if (block.offset != cursor)
+			{
+				moves.push_back({ block.offset, cursor, block.size });
+				block.offset = cursor;
+			}
+			cursor += block.size;
+
+			block.prev_physical = last_used;
+			if (last_used != NO_BLOCK) this->blocks[last_used].next_physical = index;
+			if (first_used == NO_BLOCK) first_used = index;
+			last_used = index;
+		}
+		index = next;
+	}
+
+	uint32_t tail = NO_BLOCK;
+	if (cursor < this->capacity || first_used == NO_BLOCK)
+	{
+		tail = createBlock(cursor, this->capacity - cursor);
+		this->blocks[tail].prev_physical = last_used;
+		if (this->blocks[tail].size > 0) insertFree(tail);
+	}
+	if (last_used != NO_BLOCK) this->blocks[last_used].next_physical = tail;
+	this->first_block = (first_used != NO_BLOCK) ? first_used : tail;
+	return moves;
+}
+
+BufferAllocatorStatistics BufferAllocator::getStatistics()
+{
+	BufferAllocatorStatistics statistics;
+	statistics.capacity = this->capacity;
+	for (uint32_t index = this->first_block; index != NO_BLOCK; index = this->blocks[index].next_physical)
+	{
+		const Block & block = this->blocks[index];
+		if (block.free)
+		{
+			statistics.free += block.size;
+			statistics.free_block_count++;
+			if (block.size > statistics.largest_free_block) statistics.largest_free_block = block.size;
+		}
+		else if (block.size > 0)
+		{
+			statistics.used += block.size;
+			statistics.allocation_count++;
+		}
+	}
+	if (statistics.free > 0)
+	{
+		statistics.fragmentation = 1.f - static_cast<float>(statistics.largest_free_block) / static_cast<float>(statistics.free);
+	}
+	return statistics;
+}
@@ -0,0 +1,66 @@
+#include <GLRF/DirtyRanges.hpp>
+
+using namespace GLRF;
+
+DirtyRanges::DirtyRanges(size_t merge_distance)
+{
+	this->merge_distance = merge_distance;
+}
+
+DirtyRanges::~DirtyRanges()
+{
+
+}
+
+void DirtyRanges::mark(size_t first, size_t count)
+{
+	if (count == 0) return;
+	size_t begin = first;
+	size_t end = first + count;
+
+	// the first range that ends close enough to be merged, all following ranges start after it
+	auto merge_begin = std::lower_bound(this->ranges.begin(), this->ranges.end(), begin,
+		[this](const Range & range, size_t value) { return range.first + range.count + this->merge_distance < value; });
+	auto merge_end = merge_begin;
+	while (merge_end != this->ranges.end() && merge_end->first <= end + this->merge_distance)
+	{
+		begin = std::min(begin, merge_end->first);
+		end = std::max(end, merge_end->first + merge_end->count);
+		merge_end++;
+	}
+
+	if (merge_begin == merge_end)
+	{
+		this->ranges.insert(merge_begin, { begin, end - begin });
+		return;
+	}
+	*merge_begin = { begin, end - begin };
+	this->ranges.erase(merge_begin + 1, merge_end);
+}
+
+void DirtyRanges::clear()
+{
+	this->ranges.clear();
+}
+
+bool DirtyRanges::empty() const
+{
+	return this->ranges.empty();
+}
+
+const std::vector<DirtyRanges::Range>& DirtyRanges::getRanges() const
+{
+	return this->ranges;
+}
+
+size_t DirtyRanges::getEnd() const
+{
+	return this->ranges.empty() ? 0 : this->ranges.back().first + this->ranges.back().count;
+}
+
+size_t DirtyRanges::getCount() const
+{
+	size_t count = 0;
+	for (const Range & range : this->ranges) count += range.count;
+	return count;
+}
@@ -0,0 +1,66 @@
+#include <GLRF/DrawDataBuffer.hpp>
+
+using namespace GLRF;
+
+DrawDataBuffer::DrawDataBuffer(GLuint frames_in_flight, size_t initial_capacity)
+{
+	GLint alignment = 256;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	GLsizeiptr block_size = static_cast<GLsizeiptr>(sizeof(DrawUniformBlock));
+	this->stride = ((block_size + alignment - 1) / alignment) * alignment;
+
+	this->frames_in_flight = std::max(frames_in_flight, 1u);
+	this->capacity = std::max(initial_capacity, static_cast<size_t>(1));
+	this->buffer.reset(new UniformBuffer(this->stride * static_cast<GLsizeiptr>(this->capacity * this->frames_in_flight)));
+}
+
+DrawDataBuffer::~DrawDataBuffer()
+{
+	this->staging.clear();
+}
+
+void DrawDataBuffer::beginFrame()
+{
+	this->frame_index = (this->frame_index + 1) % this->frames_in_flight;
+	this->draw_count = 0;
+}
+
+void DrawDataBuffer::resize(size_t draw_count)
+{
+	this->draw_count = draw_count;
+	size_t staging_size = draw_count * static_cast<size_t>(this->stride);
+	if (this->staging.size() < staging_size) this->staging.resize(staging_size);
+}
+
+DrawUniformBlock & DrawDataBuffer::at(size_t draw_index)
+{
+	return *reinterpret_cast<DrawUniformBlock *>(&this->staging[draw_index * static_cast<size_t>(this->stride)]);
+}
+
+void DrawDataBuffer::upload()
+{
+	if (this->draw_count == 0) return;
+
+	if (this->draw_count > this->capacity)
+	{
+		while (this->capacity < this->draw_count) this->capacity *= 2;
+		this->buffer.reset(new UniformBuffer(this->stride * static_cast<GLsizeiptr>(this->capacity * this->frames_in_flight)));
+	}
+	this->buffer->upload(this->staging.data(), this->stride * static_cast<GLsizeiptr>(this->draw_count), getRegionOffset());
+}
+
+void DrawDataBuffer::bind(size_t draw_index)
+{
+	GLintptr offset = getRegionOffset() + this->stride * static_cast<GLintptr>(draw_index);
+	this->buffer->bindRange(DRAW_BLOCK_BINDING, offset, sizeof(DrawUniformBlock));
+}
+
+size_t DrawDataBuffer::size()
+{
+	return this->draw_count;
+}
+
+GLintptr DrawDataBuffer::getRegionOffset()
+{
+	return this->stride * static_cast<GLintptr>(this->capacity * this->frame_index);
+}
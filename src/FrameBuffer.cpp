@@ -2,17 +2,42 @@
 
 using namespace GLRF;
 
+namespace {
+    /**
+     * @brief Returns a sized internal format for an unsized one, since immutable storage requires sized formats.
+     */
+    GLenum getSizedFormat(GLenum format)
+    {
+        switch (format)
+        {
+        case GL_RED: return GL_R8;
+        case GL_RG: return GL_RG8;
+        case GL_RGB: return GL_RGB8;
+        case GL_RGBA: return GL_RGBA8;
+        case GL_DEPTH_COMPONENT: return GL_DEPTH_COMPONENT24;
+        default: return format;
+        }
+    }
+}
+
 FrameBuffer::FrameBuffer(FrameBufferConfiguration & config, ScreenResolution & screen_res)
 {
+    if (GLCapabilities::getInstance().direct_state_access)
+    {
+        createDirect(config, screen_res);
+        return;
+    }
+
+    GLStateCache & state = GLStateCache::getInstance();
     glGenFramebuffers(1, &(this->ID));
-    glBindFramebuffer(GL_FRAMEBUFFER, this->ID);
+    state.bindFramebuffer(GL_FRAMEBUFFER, this->ID);
 
     this->texture_color_buffer_IDs.reserve(config.num_color_buffers);
     for (GLuint i = 0; i < texture_color_buffer_IDs.capacity(); ++i)
     {
         GLuint textureID;
         glGenTextures(1, &textureID);
-        glBindTexture(GL_TEXTURE_2D, textureID);
+        state.bindTexture(GL_TEXTURE_2D, textureID);
         glTexImage2D(GL_TEXTURE_2D, 0, config.color_profile, screen_res.width, screen_res.height, 0, config.color_type, config.data_type, NULL);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -21,7 +46,7 @@ FrameBuffer::FrameBuffer(FrameBufferConfiguration & config, ScreenResolution & s
         glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, textureID, 0);
         this->texture_color_buffer_IDs.push_back(textureID);
     }
-    glBindTexture(GL_TEXTURE_2D, 0);
+    state.bindTexture(GL_TEXTURE_2D, 0);
 
     GLuint attachments[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
     glDrawBuffers(config.num_color_buffers, attachments);
@@ -43,15 +68,55 @@ FrameBuffer::FrameBuffer(FrameBufferConfiguration & config, ScreenResolution & s
         std::cerr << "ERROR::cannot initialize framebuffer" << std::endl;
         throw std::runtime_error("cannot initialize framebuffer");
     }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    state.bindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void FrameBuffer::createDirect(FrameBufferConfiguration & config, ScreenResolution & screen_res)
+{
+    glCreateFramebuffers(1, &(this->ID));
+
+    this->texture_color_buffer_IDs.reserve(config.num_color_buffers);
+    for (GLuint i = 0; i < texture_color_buffer_IDs.capacity(); ++i)
+    {
+        GLuint textureID;
+        glCreateTextures(GL_TEXTURE_2D, 1, &textureID);
+        glTextureStorage2D(textureID, 1, getSizedFormat(config.color_profile), screen_res.width, screen_res.height);
+        glTextureParameteri(textureID, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTextureParameteri(textureID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTextureParameteri(textureID, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(textureID, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glNamedFramebufferTexture(this->ID, GL_COLOR_ATTACHMENT0 + i, textureID, 0);
+        this->texture_color_buffer_IDs.push_back(textureID);
+    }
+
+    GLuint attachments[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glNamedFramebufferDrawBuffers(this->ID, config.num_color_buffers, attachments);
+
+    if (config.use_depth_buffer)
+    {
+        GLuint RBO;
+        glCreateRenderbuffers(1, &RBO);
+        this->RBO = RBO;
+        glNamedRenderbufferStorage(RBO, getSizedFormat(GL_DEPTH_COMPONENT), screen_res.width, screen_res.height);
+        glNamedFramebufferRenderbuffer(this->ID, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, RBO);
+    }
+
+    if (glCheckNamedFramebufferStatus(this->ID, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cerr << "ERROR::cannot initialize framebuffer" << std::endl;
+        throw std::runtime_error("cannot initialize framebuffer");
+    }
 }
 
 FrameBuffer::~FrameBuffer()
 {
+    GLStateCache & state = GLStateCache::getInstance();
     glDeleteFramebuffers(1, &(this->ID));
+    state.deletedFramebuffer(this->ID);
     for (GLuint i = 0; i < this->texture_color_buffer_IDs.size(); ++i)
     {
         glDeleteTextures(1, &(this->texture_color_buffer_IDs[i]));
+        state.deletedTexture(this->texture_color_buffer_IDs[i]);
     }
     this->texture_color_buffer_IDs.clear();
     this->texture_color_buffer_IDs.shrink_to_fit();
@@ -60,13 +125,7 @@ FrameBuffer::~FrameBuffer()
 
 void FrameBuffer::use()
 {
-    GLint id;
-    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &id);
-    if (id != this->ID)
-    {
-        glBindFramebuffer(GL_FRAMEBUFFER, this->ID);
-    }
-    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &id);
+    GLStateCache::getInstance().bindFramebuffer(GL_FRAMEBUFFER, this->ID);
 }
 
 GLuint FrameBuffer::getID()
@@ -0,0 +1,125 @@
+#include <GLRF/Frustum.hpp>
+
+#include <cmath>
+#include <limits>
+
+#ifdef GLRF_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace GLRF;
+
+Frustum::Frustum()
+{
+	for (glm::vec4 & plane : this->planes) plane = glm::vec4(0.f, 0.f, 0.f, 1.f);
+}
+
+Frustum::Frustum(const glm::mat4 & view_projection)
+{
+	// a point is inside if -w <= x, y, z <= w in clip space, each inequality is a plane (Gribb & Hartmann)
+	glm::vec4 rows[4];
+	for (int i = 0; i < 4; i++)
+	{
+		rows[i] = glm::vec4(view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i]);
+	}
+	this->planes[0] = rows[3] + rows[0];
+	this->planes[1] = rows[3] - rows[0];
+	this->planes[2] = rows[3] + rows[1];
+	this->planes[3] = rows[3] - rows[1];
+	this->planes[4] = rows[3] + rows[2];
+	this->planes[5] = rows[3] - rows[2];
+	for (glm::vec4 & plane : this->planes)
+	{
+		float length = glm::length(glm::vec3(plane));
+		if (length > 0.f) plane /= length;
+	}
+}
+
+const glm::vec4 & Frustum::getPlane(size_t index) const
+{
+	return this->planes[index];
+}
+
+bool Frustum::getBounds(BoundingBox * box) const
+{
+	// every corner is the intersection of a plane of each pair (left/right, bottom/top, near/far)
+	glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+	glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+	for (size_t corner = 0; corner < 8; corner++)
+	{
+		const glm::vec4 & p1 = this->planes[0 + (corner & 1)];
+		const glm::vec4 & p2 = this->planes[2 + ((corner >> 1) & 1)];
+		const glm::vec4 & p3 = this->planes[4 + ((corner >> 2) & 1)];
+		glm::vec3 n1 = glm::vec3(p1), n2 = glm::vec3(p2), n3 = glm::vec3(p3);
+		glm::vec3 c23 = glm::cross(n2, n3);
+		float determinant = glm::dot(n1, c23);
+		if (std::abs(determinant) < 1e-6f) return false;
+		glm::vec3 point = -(p1.w * c23 + p2.w * glm::cross(n3, n1) + p3.w * glm::cross(n1, n2)) / determinant;
+		if (!std::isfinite(point.x) || !std::isfinite(point.y) || !std::isfinite(point.z)) return false;
+		min = glm::min(min, point);
+		max = glm::max(max, point);
+	}
+	box->min = min;
+	box->max = max;
+	return true;
+}
+
+bool Frustum::intersects(const BoundingSphere & sphere) const
+{
+	for (const glm::vec4 & plane : this->planes)
+	{
+		if (glm::dot(glm::vec3(plane), sphere.center) + plane.w < -sphere.radius) return false;
+	}
+	return true;
+}
+
+bool Frustum::intersects(const BoundingBox & box) const
+{
+	// only the corner that is furthest along the normal has to be tested
+	for (const glm::vec4 & plane : this->planes)
+	{
+		glm::vec3 corner = glm::vec3(
+			plane.x >= 0.f ? box.max.x : box.min.x,
+			plane.y >= 0.f ? box.max.y : box.min.y,
+			plane.z >= 0.f ? box.max.z : box.min.z);
+		if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.f) return false;
+	}
+	return true;
+}
+
+void Frustum::intersects(const glm::vec4 * spheres, size_t count, uint8_t * visible) const
+{
+	size_t i = 0;
+#ifdef GLRF_SSE2
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 x = _mm_loadu_ps(&spheres[i].x);
+		__m128 y = _mm_loadu_ps(&spheres[i + 1].x);
+		__m128 z = _mm_loadu_ps(&spheres[i + 2].x);
+		__m128 r = _mm_loadu_ps(&spheres[i + 3].x);
+		_MM_TRANSPOSE4_PS(x, y, z, r);
+		__m128 negative_r = _mm_sub_ps(_mm_setzero_ps(), r);
+
+		__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		for (const glm::vec4 & plane : this->planes)
+		{
+			__m128 distance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.x)), _mm_mul_ps(y, _mm_set1_ps(plane.y))),
+				_mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+			inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negative_r));
+		}
+		int mask = _mm_movemask_ps(inside);
+		visible[i] = static_cast<uint8_t>(mask & 1);
+		visible[i + 1] = static_cast<uint8_t>((mask >> 1) & 1);
+		visible[i + 2] = static_cast<uint8_t>((mask >> 2) & 1);
+		visible[i + 3] = static_cast<uint8_t>((mask >> 3) & 1);
+	}
+#endif
+	for (; i < count; i++)
+	{
+		BoundingSphere sphere;
+		sphere.center = glm::vec3(spheres[i]);
+		sphere.radius = spheres[i].w;
+		visible[i] = intersects(sphere) ? 1 : 0;
+	}
+}
@@ -0,0 +1,50 @@
+#include <GLRF/GLCapabilities.hpp>
+
+using namespace GLRF;
+
+namespace {
+	std::string getString(GLenum name)
+	{
+		const GLubyte * value = glGetString(name);
+		return value ? std::string(reinterpret_cast<const char *>(value)) : std::string();
+	}
+}
+
+GLCapabilities::GLCapabilities()
+{
+	this->vendor = getString(GL_VENDOR);
+	this->renderer = getString(GL_RENDERER);
+	this->version = getString(GL_VERSION);
+
+	if (GLAD_GL_VERSION_4_1 || GLAD_GL_ARB_get_program_binary)
+	{
+		GLint binary_format_count = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binary_format_count);
+		this->program_binary = binary_format_count > 0;
+	}
+
+	// let the driver use as many compiler threads as it wants
+	if (GLAD_GL_KHR_parallel_shader_compile)
+	{
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+		this->parallel_shader_compile = true;
+	}
+	else if (GLAD_GL_ARB_parallel_shader_compile)
+	{
+		glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+		this->parallel_shader_compile = true;
+	}
+
+	this->direct_state_access = GLAD_GL_VERSION_4_5 || GLAD_GL_ARB_direct_state_access;
+	this->base_instance = GLAD_GL_VERSION_4_2 || GLAD_GL_ARB_base_instance;
+	this->buffer_storage = GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage;
+	this->multi_draw_indirect = GLAD_GL_VERSION_4_3
+		|| (GLAD_GL_ARB_multi_draw_indirect && GLAD_GL_ARB_shader_storage_buffer_object && this->base_instance);
+	this->vertex_attrib_binding = GLAD_GL_VERSION_4_3 || GLAD_GL_ARB_vertex_attrib_binding || this->direct_state_access;
+	this->conservative_occlusion_query = GLAD_GL_VERSION_4_3 || GLAD_GL_ARB_ES3_compatibility;
+}
+
+GLCapabilities::~GLCapabilities()
+{
+
+}
@@ -0,0 +1,278 @@
+#include <GLRF/GLStateCache.hpp>
+
+using namespace GLRF;
+
+GLStateCache::GLStateCache()
+{
+
+}
+
+GLStateCache::~GLStateCache()
+{
+
+}
+
+uint64_t GLStateCache::key(GLenum a, GLuint b)
+{
+	return (static_cast<uint64_t>(a) << 32) | b;
+}
+
+bool GLStateCache::change(bool redundant)
+{
+	if (redundant)
+	{
+		this->frame_counters.elided++;
+		return false;
+	}
+	this->frame_counters.issued++;
+	return true;
+}
+
+void GLStateCache::beginFrame()
+{
+	this->last_frame_counters = this->frame_counters;
+	this->frame_counters = GLStateCounters();
+}
+
+const GLStateCounters& GLStateCache::getFrameCounters()
+{
+	return this->frame_counters;
+}
+
+const GLStateCounters& GLStateCache::getLastFrameCounters()
+{
+	return this->last_frame_counters;
+}
+
+void GLStateCache::invalidate()
+{
+	this->program.reset();
+	this->vertex_array.reset();
+	this->buffers.clear();
+	this->indexed_buffers.clear();
+	this->active_texture.reset();
+	this->textures.clear();
+	this->samplers.clear();
+	this->draw_framebuffer.reset();
+	this->read_framebuffer.reset();
+	this->current_viewport.reset();
+	this->point_size.reset();
+	this->line_width.reset();
+	this->capabilities.clear();
+	this->blend_factors.reset();
+	this->depth_function.reset();
+	this->depth_write.reset();
+}
+
+void GLStateCache::useProgram(GLuint program)
+{
+	if (!change(this->program == program)) return;
+	glUseProgram(program);
+	this->program = program;
+}
+
+void GLStateCache::bindVertexArray(GLuint vertex_array)
+{
+	if (!change(this->vertex_array == vertex_array)) return;
+	glBindVertexArray(vertex_array);
+	this->vertex_array = vertex_array;
+}
+
+void GLStateCache::bindBuffer(GLenum target, GLuint buffer)
+{
+	if (target == GL_ELEMENT_ARRAY_BUFFER)
+	{
+		change(false);
+		glBindBuffer(target, buffer);
+		return;
+	}
+
+	auto it = this->buffers.find(target);
+	if (!change(it != this->buffers.end() && it->second == buffer)) return;
+	glBindBuffer(target, buffer);
+	this->buffers.insert_or_assign(target, buffer);
+}
+
+void GLStateCache::bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+	auto it = this->indexed_buffers.find(key(target, index));
+	bool redundant = it != this->indexed_buffers.end() && it->second.buffer == buffer && it->second.size < 0;
+	if (!change(redundant)) return;
+	glBindBufferBase(target, index, buffer);
+	// indexed binds also replace the generic binding point of the target
+	this->indexed_buffers.insert_or_assign(key(target, index), IndexedBufferBinding{ buffer, 0, -1 });
+	this->buffers.insert_or_assign(target, buffer);
+}
+
+void GLStateCache::bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+	auto it = this->indexed_buffers.find(key(target, index));
+	bool redundant = it != this->indexed_buffers.end() && it->second.buffer == buffer
+		&& it->second.offset == offset && it->second.size == size;
+	if (!change(redundant)) return;
+	glBindBufferRange(target, index, buffer, offset, size);
+	this->indexed_buffers.insert_or_assign(key(target, index), IndexedBufferBinding{ buffer, offset, size });
+	this->buffers.insert_or_assign(target, buffer);
+}
+
+void GLStateCache::activeTexture(GLenum texture_unit)
+{
+	if (!change(this->active_texture == texture_unit)) return;
+	glActiveTexture(texture_unit);
+	this->active_texture = texture_unit;
+}
+
+void GLStateCache::bindTexture(GLenum target, GLuint texture)
+{
+	if (!this->active_texture.has_value())
+	{
+		// the active unit is unknown, so the binding cannot be remembered
+		change(false);
+		glBindTexture(target, texture);
+		return;
+	}
+
+	uint64_t binding = key(this->active_texture.value(), target);
+	auto it = this->textures.find(binding);
+	if (!change(it != this->textures.end() && it->second == texture)) return;
+	glBindTexture(target, texture);
+	this->textures.insert_or_assign(binding, texture);
+}
+
+void GLStateCache::bindTexture(GLenum texture_unit, GLenum target, GLuint texture)
+{
+	auto it = this->textures.find(key(texture_unit, target));
+	if (it != this->textures.end() && it->second == texture)
+	{
+		// the texture is bound already, so the active unit does not matter either
+		change(true);
+		return;
+	}
+	activeTexture(texture_unit);
+	bindTexture(target, texture);
+}
+
+void GLStateCache::bindSampler(GLuint unit, GLuint sampler)
+{
+	auto it = this->samplers.find(unit);
+	if (!change(it != this->samplers.end() && it->second == sampler)) return;
+	glBindSampler(unit, sampler);
+	this->samplers.insert_or_assign(unit, sampler);
+}
+
+void GLStateCache::bindFramebuffer(GLenum target, GLuint framebuffer)
+{
+	bool draw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+	bool read = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+	bool redundant = (!draw || this->draw_framebuffer == framebuffer) && (!read || this->read_framebuffer == framebuffer);
+	if (!change(redundant)) return;
+	glBindFramebuffer(target, framebuffer);
+	if (draw) this->draw_framebuffer = framebuffer;
+	if (read) this->read_framebuffer = framebuffer;
+}
+
+void GLStateCache::viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+	bool redundant = this->current_viewport.has_value()
+		&& this->current_viewport->x == x && this->current_viewport->y == y
+		&& this->current_viewport->width == width && this->current_viewport->height == height;
+	if (!change(redundant)) return;
+	glViewport(x, y, width, height);
+	this->current_viewport = Viewport{ x, y, width, height };
+}
+
+void GLStateCache::pointSize(GLfloat size)
+{
+	if (!change(this->point_size == size)) return;
+	glPointSize(size);
+	this->point_size = size;
+}
+
+void GLStateCache::lineWidth(GLfloat width)
+{
+	if (!change(this->line_width == width)) return;
+	glLineWidth(width);
+	this->line_width = width;
+}
+
+void GLStateCache::setEnabled(GLenum capability, bool enabled)
+{
+	auto it = this->capabilities.find(capability);
+	if (!change(it != this->capabilities.end() && it->second == enabled)) return;
+	if (enabled)
+	{
+		glEnable(capability);
+	}
+	else
+	{
+		glDisable(capability);
+	}
+	this->capabilities.insert_or_assign(capability, enabled);
+}
+
+void GLStateCache::blendFunc(GLenum source_factor, GLenum destination_factor)
+{
+	std::pair<GLenum, GLenum> factors(source_factor, destination_factor);
+	if (!change(this->blend_factors == factors)) return;
+	glBlendFunc(source_factor, destination_factor);
+	this->blend_factors = factors;
+}
+
+void GLStateCache::depthFunc(GLenum function)
+{
+	if (!change(this->depth_function == function)) return;
+	glDepthFunc(function);
+	this->depth_function = function;
+}
+
+void GLStateCache::depthMask(GLboolean enabled)
+{
+	if (!change(this->depth_write == enabled)) return;
+	glDepthMask(enabled);
+	this->depth_write = enabled;
+}
+
+void GLStateCache::deletedProgram(GLuint program)
+{
+	// a deleted program stays in use until another program is used, but its identifier may be reused
+	if (this->program == program) this->program.reset();
+}
+
+void GLStateCache::deletedVertexArray(GLuint vertex_array)
+{
+	if (this->vertex_array == vertex_array) this->vertex_array = 0;
+}
+
+void GLStateCache::deletedBuffer(GLuint buffer)
+{
+	for (auto & binding : this->buffers)
+	{
+		if (binding.second == buffer) binding.second = 0;
+	}
+	for (auto & binding : this->indexed_buffers)
+	{
+		if (binding.second.buffer == buffer) binding.second = IndexedBufferBinding{ 0, 0, -1 };
+	}
+}
+
+void GLStateCache::deletedTexture(GLuint texture)
+{
+	for (auto & binding : this->textures)
+	{
+		if (binding.second == texture) binding.second = 0;
+	}
+}
+
+void GLStateCache::deletedSampler(GLuint sampler)
+{
+	for (auto & binding : this->samplers)
+	{
+		if (binding.second == sampler) binding.second = 0;
+	}
+}
+
+void GLStateCache::deletedFramebuffer(GLuint framebuffer)
+{
+	if (this->draw_framebuffer == framebuffer) this->draw_framebuffer = 0;
+	if (this->read_framebuffer == framebuffer) this->read_framebuffer = 0;
+}
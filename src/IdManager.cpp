@@ -2,6 +2,8 @@
 
 IdManager::IdManager() {
     this->next_node_id = 0;
+    this->next_material_id = 0;
+    this->next_object_id = 0;
 }
 
 IdManager::~IdManager() {
@@ -11,3 +13,11 @@ IdManager::~IdManager() {
 IdSpaceSize IdManager::getNodeId() {
     return this->next_node_id++;
 }
+
+IdSpaceSize IdManager::getMaterialId() {
+    return this->next_material_id++;
+}
+
+IdSpaceSize IdManager::getObjectId() {
+    return this->next_object_id++;
+}
\ No newline at end of file
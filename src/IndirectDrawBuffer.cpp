@@ -0,0 +1,138 @@
+#include <GLRF/IndirectDrawBuffer.hpp>
+
+using namespace GLRF;
+
+IndirectDrawBuffer::IndirectDrawBuffer(GLuint frames_in_flight, size_t initial_capacity)
+{
+	this->frames_in_flight = std::max(frames_in_flight, 1u);
+	this->capacity = std::max(initial_capacity, static_cast<size_t>(1));
+	create();
+}
+
+IndirectDrawBuffer::~IndirectDrawBuffer()
+{
+	destroy();
+}
+
+void IndirectDrawBuffer::create()
+{
+	GLsizeiptr command_size = static_cast<GLsizeiptr>(sizeof(DrawElementsIndirectCommand) * this->capacity * this->frames_in_flight);
+	GLsizeiptr storage_size = static_cast<GLsizeiptr>(sizeof(DrawUniformBlock) * this->capacity * this->frames_in_flight);
+	if (GLCapabilities::getInstance().direct_state_access)
+	{
+		glCreateBuffers(1, &(this->command_buffer));
+		glCreateBuffers(1, &(this->storage_buffer));
+		glNamedBufferStorage(this->command_buffer, command_size, NULL, GL_DYNAMIC_STORAGE_BIT);
+		glNamedBufferStorage(this->storage_buffer, storage_size, NULL, GL_DYNAMIC_STORAGE_BIT);
+	}
+	else
+	{
+		GLStateCache & state = GLStateCache::getInstance();
+		glGenBuffers(1, &(this->command_buffer));
+		glGenBuffers(1, &(this->storage_buffer));
+		state.bindBuffer(GL_DRAW_INDIRECT_BUFFER, this->command_buffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, command_size, NULL, GL_DYNAMIC_DRAW);
+		state.bindBuffer(GL_SHADER_STORAGE_BUFFER, this->storage_buffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, storage_size, NULL, GL_DYNAMIC_DRAW);
+	}
+}
+
+void IndirectDrawBuffer::destroy()
+{
+	GLStateCache & state = GLStateCache::getInstance();
+	glDeleteBuffers(1, &(this->command_buffer));
+	glDeleteBuffers(1, &(this->storage_buffer));
+	state.deletedBuffer(this->command_buffer);
+	state.deletedBuffer(this->storage_buffer);
+}
+
+void IndirectDrawBuffer::beginFrame()
+{
+	this->frame_index = (this->frame_index + 1) % this->frames_in_flight;
+	this->draws.clear();
+	this->commands.clear();
+}
+
+void IndirectDrawBuffer::resize(size_t draw_count)
+{
+	this->draws.resize(draw_count);
+}
+
+DrawUniformBlock & IndirectDrawBuffer::at(size_t draw_index)
+{
+	return this->draws[draw_index];
+}
+
+GLuint IndirectDrawBuffer::getBaseInstance(size_t draw_index)
+{
+	return static_cast<GLuint>(this->capacity * this->frame_index + draw_index);
+}
+
+size_t IndirectDrawBuffer::addCommand(const DrawElementsIndirectCommand & command)
+{
+	this->commands.push_back(command);
+	return this->commands.size() - 1;
+}
+
+DrawElementsIndirectCommand & IndirectDrawBuffer::getCommand(size_t command_index)
+{
+	return this->commands[command_index];
+}
+
+size_t IndirectDrawBuffer::getCommandCount()
+{
+	return this->commands.size();
+}
+
+void IndirectDrawBuffer::upload()
+{
+	if (this->commands.empty()) return;
+
+	size_t required_capacity = std::max(this->draws.size(), this->commands.size());
+	if (required_capacity > this->capacity)
+	{
+		size_t previous_capacity = this->capacity;
+		while (this->capacity < required_capacity) this->capacity *= 2;
+		destroy();
+		create();
+
+		// the base instances were computed for the previous capacity
+		for (DrawElementsIndirectCommand & command : this->commands)
+		{
+			command.base_instance -= static_cast<GLuint>(previous_capacity * this->frame_index);
+			command.base_instance += static_cast<GLuint>(this->capacity * this->frame_index);
+		}
+	}
+
+	upload(GL_DRAW_INDIRECT_BUFFER, this->command_buffer,
+		static_cast<GLintptr>(sizeof(DrawElementsIndirectCommand) * this->capacity * this->frame_index),
+		static_cast<GLsizeiptr>(sizeof(DrawElementsIndirectCommand) * this->commands.size()), this->commands.data());
+	upload(GL_SHADER_STORAGE_BUFFER, this->storage_buffer,
+		static_cast<GLintptr>(sizeof(DrawUniformBlock) * this->capacity * this->frame_index),
+		static_cast<GLsizeiptr>(sizeof(DrawUniformBlock) * this->draws.size()), this->draws.data());
+}
+
+void IndirectDrawBuffer::upload(GLenum target, GLuint buffer, GLintptr offset, GLsizeiptr size, const void * data)
+{
+	if (size == 0) return;
+	if (GLCapabilities::getInstance().direct_state_access)
+	{
+		glNamedBufferSubData(buffer, offset, size, data);
+		return;
+	}
+	GLStateCache::getInstance().bindBuffer(target, buffer);
+	glBufferSubData(target, offset, size, data);
+}
+
+void IndirectDrawBuffer::bind()
+{
+	GLStateCache & state = GLStateCache::getInstance();
+	state.bindBuffer(GL_DRAW_INDIRECT_BUFFER, this->command_buffer);
+	state.bindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_STORAGE_BINDING, this->storage_buffer);
+}
+
+void IndirectDrawBuffer::draw(GLenum mode, size_t first_command, GLsizei command_count)
+{
+	size_t offset = sizeof(DrawElementsIndirectCommand) * (this->capacity * this->frame_index + first_command);
+	glMultiDrawElementsIndirect(mode, GL_UNSIGNED_INT, reinterpret_cast<const void*>(offset), command_count, 0);
+}
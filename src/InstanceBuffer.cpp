@@ -0,0 +1,98 @@
+#include <GLRF/InstanceBuffer.hpp>
+
+using namespace GLRF;
+
+InstanceBuffer::InstanceBuffer(GLuint frames_in_flight, size_t initial_capacity)
+{
+	this->frames_in_flight = std::max(frames_in_flight, 1u);
+	this->capacity = std::max(initial_capacity, static_cast<size_t>(1));
+	create();
+}
+
+InstanceBuffer::~InstanceBuffer()
+{
+	glDeleteBuffers(1, &(this->ID));
+	GLStateCache::getInstance().deletedBuffer(this->ID);
+}
+
+void InstanceBuffer::create()
+{
+	if (this->ID != 0)
+	{
+		glDeleteBuffers(1, &(this->ID));
+		GLStateCache::getInstance().deletedBuffer(this->ID);
+	}
+
+	GLsizeiptr size = static_cast<GLsizeiptr>(sizeof(InstanceData) * this->capacity * this->frames_in_flight);
+	if (GLCapabilities::getInstance().direct_state_access)
+	{
+		glCreateBuffers(1, &(this->ID));
+		glNamedBufferStorage(this->ID, size, NULL, GL_DYNAMIC_STORAGE_BIT);
+	}
+	else
+	{
+		glGenBuffers(1, &(this->ID));
+		GLStateCache::getInstance().bindBuffer(GL_ARRAY_BUFFER, this->ID);
+		glBufferData(GL_ARRAY_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
+	}
+	this->generation++;
+}
+
+void InstanceBuffer::beginFrame()
+{
+	this->frame_index = (this->frame_index + 1) % this->frames_in_flight;
+	this->staging.clear();
+}
+
+void InstanceBuffer::resize(size_t instance_count)
+{
+	this->staging.resize(instance_count);
+}
+
+InstanceData & InstanceBuffer::at(size_t instance_index)
+{
+	return this->staging[instance_index];
+}
+
+void InstanceBuffer::upload()
+{
+	if (this->staging.empty()) return;
+
+	if (this->staging.size() > this->capacity)
+	{
+		while (this->capacity < this->staging.size()) this->capacity *= 2;
+		create();
+	}
+
+	GLintptr offset = static_cast<GLintptr>(sizeof(InstanceData) * this->capacity * this->frame_index);
+	GLsizeiptr size = static_cast<GLsizeiptr>(sizeof(InstanceData) * this->staging.size());
+	if (GLCapabilities::getInstance().direct_state_access)
+	{
+		glNamedBufferSubData(this->ID, offset, size, this->staging.data());
+	}
+	else
+	{
+		GLStateCache::getInstance().bindBuffer(GL_ARRAY_BUFFER, this->ID);
+		glBufferSubData(GL_ARRAY_BUFFER, offset, size, this->staging.data());
+	}
+}
+
+GLuint InstanceBuffer::getBaseInstance(size_t instance_index)
+{
+	return static_cast<GLuint>(this->capacity * this->frame_index + instance_index);
+}
+
+GLuint InstanceBuffer::getID()
+{
+	return this->ID;
+}
+
+GLuint InstanceBuffer::getGeneration()
+{
+	return this->generation;
+}
+
+size_t InstanceBuffer::size()
+{
+	return this->staging.size();
+}
@@ -2,6 +2,8 @@
 
 using namespace GLRF;
 
+uint64_t Material::draw_generation = 0;
+
 template<typename T>
 MaterialProperty<T>::MaterialProperty() {
 	this->value_default = (T)0.f;
@@ -29,6 +31,7 @@ void MaterialProperty<T>::loadTexture(std::string texture_name, std::string sepa
 }
 
 Material::Material() {
+	this->id = IdManager::getInstance().getMaterialId();
 	this->albedo = MaterialProperty<glm::vec3>(glm::vec3(1.f));
 	this->normal = MaterialProperty<glm::vec3>(glm::vec3(0.f, 0.f, 1.f));
 	this->roughness = MaterialProperty<float>(0.3f);
@@ -38,6 +41,9 @@ Material::Material() {
 	this->opacity = MaterialProperty<float>(1.f);
 
 	this->height_scale = 1.0f;
+
+	std::memset(static_cast<void*>(&this->uniform_block), 0, sizeof(MaterialUniformBlock));
+	std::memset(this->texture_ids, 0, sizeof(this->texture_ids));
 }
 
 void Material::loadTextures(std::string library, std::string name, std::string separator, std::string fileType)
@@ -62,6 +68,116 @@ void Material::loadTextures(std::string name, std::string separator, std::string
 	this->opacity.loadTexture(name, separator, "opacity", fileType);
 }
 
+IdSpaceSize Material::getID()
+{
+	return this->id;
+}
+
+void Material::packUniformBlock(MaterialUniformBlock * block, GLuint * texture_ids)
+{
+	std::memset(static_cast<void*>(block), 0, sizeof(MaterialUniformBlock));
+	block->albedo = glm::vec4(this->albedo.value_default, 0.f);
+	block->normal = glm::vec4(this->normal.value_default, 0.f);
+	block->roughness = this->roughness.value_default;
+	block->metallic = this->metallic.value_default;
+	block->ao = this->ao.value_default;
+	block->height = this->height.value_default;
+	block->opacity = this->opacity.value_default;
+	block->height_scale = this->height_scale;
+	block->feature_mask = getFeatureMask();
+
+	const std::optional<std::shared_ptr<Texture>> * textures[property_count] = {
+		&this->albedo.texture, &this->normal.texture, &this->roughness.texture, &this->metallic.texture,
+		&this->ao.texture, &this->height.texture, &this->opacity.texture
+	};
+	for (GLuint i = 0; i < property_count; i++)
+	{
+		texture_ids[i] = textures[i]->has_value() ? textures[i]->value()->getID() : 0;
+	}
+}
+
+void Material::sync(uint64_t frame)
+{
+	if (this->uniform_buffer && this->synced_frame == frame) return;
+	this->synced_frame = frame;
+
+	MaterialUniformBlock block;
+	GLuint texture_ids[property_count];
+	packUniformBlock(&block, texture_ids);
+
+	bool values_changed = std::memcmp(&block, &this->uniform_block, sizeof(MaterialUniformBlock)) != 0;
+	bool textures_changed = std::memcmp(texture_ids, this->texture_ids, sizeof(texture_ids)) != 0;
+
+	if (!this->uniform_buffer)
+	{
+		this->uniform_buffer.reset(new UniformBuffer(sizeof(MaterialUniformBlock), GL_STATIC_DRAW));
+		values_changed = true;
+	}
+	if (values_changed)
+	{
+		this->uniform_block = block;
+		this->uniform_buffer->upload(&this->uniform_block, sizeof(MaterialUniformBlock));
+	}
+	if (textures_changed)
+	{
+		std::memcpy(this->texture_ids, texture_ids, sizeof(texture_ids));
+	}
+	if (values_changed || textures_changed) this->revision++;
+
+	uint32_t feature_mask = getFeatureMask();
+	bool translucent = isTranslucent();
+	if (feature_mask != this->synced_feature_mask || translucent != this->synced_translucent)
+	{
+		this->synced_feature_mask = feature_mask;
+		this->synced_translucent = translucent;
+		draw_generation++;
+	}
+}
+
+uint64_t Material::getRevision()
+{
+	return this->revision;
+}
+
+uint64_t Material::getDrawGeneration()
+{
+	return draw_generation;
+}
+
+UniformBuffer * Material::getUniformBuffer()
+{
+	return this->uniform_buffer.get();
+}
+
+bool Material::isTranslucent() const
+{
+	return this->opacity.value_default < 1.f || this->opacity.texture.has_value();
+}
+
+uint32_t Material::getFeatureMask()
+{
+	uint32_t mask = 0;
+	if (this->albedo.texture.has_value())		mask |= MATERIAL_ALBEDO_TEXTURE;
+	if (this->normal.texture.has_value())		mask |= MATERIAL_NORMAL_TEXTURE;
+	if (this->roughness.texture.has_value())	mask |= MATERIAL_ROUGHNESS_TEXTURE;
+	if (this->metallic.texture.has_value())		mask |= MATERIAL_METALLIC_TEXTURE;
+	if (this->ao.texture.has_value())			mask |= MATERIAL_AO_TEXTURE;
+	if (this->height.texture.has_value())		mask |= MATERIAL_HEIGHT_TEXTURE;
+	if (this->opacity.texture.has_value())		mask |= MATERIAL_OPACITY_TEXTURE;
+	return mask;
+}
+
+std::vector<std::string> Material::getFeatureDefines(uint32_t feature_mask)
+{
+	static const char * feature_names[] = { "ALBEDO", "NORMAL", "ROUGHNESS", "METALLIC", "AO", "HEIGHT", "OPACITY" };
+	std::vector<std::string> defines;
+	for (uint32_t i = 0; i < 7; i++)
+	{
+		if (feature_mask & (1u << i)) defines.push_back(std::string("GLRF_") + feature_names[i] + "_TEXTURE");
+	}
+	return defines;
+}
+
 void Material::bindTextures(GLuint textureUnitsBegin)
 {
 	if (this->albedo.texture.has_value())		this->albedo.texture.value()->bind(GL_TEXTURE0 + textureUnitsBegin);
@@ -0,0 +1,335 @@
+#include <GLRF/OcclusionCuller.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+#ifdef GLRF_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace GLRF;
+
+namespace {
+	// the planes that triangles are clipped against in clip space, a point is inside if the dot product is positive
+	const glm::vec4 CLIP_PLANES[] = {
+		glm::vec4(0.f, 0.f, 1.f, 1.f),
+		glm::vec4(1.f, 0.f, 0.f, 1.f),
+		glm::vec4(-1.f, 0.f, 0.f, 1.f),
+		glm::vec4(0.f, 1.f, 0.f, 1.f),
+		glm::vec4(0.f, -1.f, 0.f, 1.f)
+	};
+	constexpr size_t CLIP_PLANE_COUNT = sizeof(CLIP_PLANES) / sizeof(CLIP_PLANES[0]);
+	constexpr size_t MAX_CLIPPED_VERTICES = 3 + CLIP_PLANE_COUNT;
+
+	double millisecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+OcclusionCuller::OcclusionCuller(int width, int height)
+{
+	this->width = std::max(4, (width + 3) / 4 * 4);
+	this->height = std::max(1, height);
+	this->depth.resize(static_cast<size_t>(this->width) * this->height, 1.f);
+}
+
+OcclusionCuller::~OcclusionCuller()
+{
+
+}
+
+void OcclusionCuller::beginFrame(const glm::mat4 & view_projection)
+{
+	this->view_projection = view_projection;
+	std::fill(this->depth.begin(), this->depth.end(), 1.f);
+	this->occluders.clear();
+	this->statistics = Statistics();
+}
+
+void OcclusionCuller::addOccluder(const OccluderGeometry & geometry, const glm::mat4 & model)
+{
+	this->occluders.push_back({ geometry, this->view_projection * model });
+	this->statistics.occluder_count++;
+}
+
+void OcclusionCuller::rasterize()
+{
+	auto start = std::chrono::steady_clock::now();
+	WorkerPool & worker_pool = WorkerPool::getInstance();
+
+	if (this->triangles.size() < this->occluders.size()) this->triangles.resize(this->occluders.size());
+	worker_pool.parallelFor(this->occluders.size(), MIN_OCCLUDERS_PER_RANGE, [&](size_t begin, size_t end, size_t) {
+		for (size_t i = begin; i < end; i++)
+		{
+			this->triangles[i].clear();
+			setupTriangles(this->occluders[i], this->triangles[i]);
+		}
+	});
+	for (size_t i = 0; i < this->occluders.size(); i++) this->statistics.triangle_count += this->triangles[i].size();
+
+	// every range owns the rows of its bands, so no pixel is written by two threads
+	size_t band_count = static_cast<size_t>((this->height + BAND_HEIGHT - 1) / BAND_HEIGHT);
+	worker_pool.parallelFor(band_count, 1, [&](size_t begin, size_t end, size_t) {
+		int first_row = static_cast<int>(begin) * BAND_HEIGHT;
+		int end_row = std::min(this->height, static_cast<int>(end) * BAND_HEIGHT);
+		for (size_t i = 0; i < this->occluders.size(); i++)
+		{
+			for (const ScreenTriangle & triangle : this->triangles[i])
+			{
+				if (triangle.last_row < first_row || triangle.first_row >= end_row) continue;
+				rasterizeTriangle(triangle, first_row, end_row);
+			}
+		}
+	});
+	this->statistics.rasterize_milliseconds += millisecondsSince(start);
+}
+
+void OcclusionCuller::setupTriangles(const Occluder & occluder, std::vector<ScreenTriangle> & triangles) const
+{
+	const OccluderGeometry & geometry = occluder.geometry;
+	const unsigned char * positions = reinterpret_cast<const unsigned char *>(geometry.positions);
+	size_t count = geometry.indices ? geometry.index_count : geometry.vertex_count;
+	for (size_t i = 0; i + 2 < count; i += 3)
+	{
+		glm::vec4 clip[MAX_CLIPPED_VERTICES];
+		unsigned int outside[3] = { 0, 0, 0 };
+		for (size_t k = 0; k < 3; k++)
+		{
+			size_t index = geometry.indices ? geometry.indices[i + k] : i + k;
+			if (index >= geometry.vertex_count) return;
+			const glm::vec3 & position = *reinterpret_cast<const glm::vec3 *>(positions + index * geometry.stride);
+			clip[k] = occluder.model_view_projection * glm::vec4(position, 1.f);
+			for (size_t p = 0; p < CLIP_PLANE_COUNT; p++)
+			{
+				if (glm::dot(CLIP_PLANES[p], clip[k]) < 0.f) outside[k] |= 1u << p;
+			}
+		}
+		if (outside[0] & outside[1] & outside[2]) continue;
+		if ((outside[0] | outside[1] | outside[2]) == 0)
+		{
+			addTriangle(clip, 3, triangles);
+			continue;
+		}
+
+		// Sutherland-Hodgman, every plane adds at most one vertex
+		glm::vec4 clipped[MAX_CLIPPED_VERTICES];
+		size_t vertex_count = 3;
+		for (size_t p = 0; p < CLIP_PLANE_COUNT && vertex_count >= 3; p++)
+		{
+			if (((outside[0] | outside[1] | outside[2]) & (1u << p)) == 0) continue;
+			size_t clipped_count = 0;
+			for (size_t v = 0; v < vertex_count; v++)
+			{
+				const glm::vec4 & a = clip[v];
+				const glm::vec4 & b = clip[(v + 1) % vertex_count];
+				float distance_a = glm::dot(CLIP_PLANES[p], a);
+				float distance_b = glm::dot(CLIP_PLANES[p], b);
+				if (distance_a >= 0.f) clipped[clipped_count++] = a;
+				if ((distance_a >= 0.f) != (distance_b >= 0.f))
+				{
+					clipped[clipped_count++] = a + (b - a) * (distance_a / (distance_a - distance_b));
+				}
+			}
+			std::copy(clipped, clipped + clipped_count, clip);
+			vertex_count = clipped_count;
+		}
+		if (vertex_count >= 3) addTriangle(clip, vertex_count, triangles);
+	}
+}
+
+void OcclusionCuller::addTriangle(const glm::vec4 * clip, size_t vertex_count, std::vector<ScreenTriangle> & triangles) const
+{
+	glm::vec3 screen[MAX_CLIPPED_VERTICES];
+	for (size_t v = 0; v < vertex_count; v++)
+	{
+		glm::vec3 ndc = glm::vec3(clip[v]) / clip[v].w;
+		screen[v] = glm::vec3(
+			(ndc.x * 0.5f + 0.5f) * this->width,
+			(ndc.y * 0.5f + 0.5f) * this->height,
+			std::min(std::max(ndc.z * 0.5f + 0.5f, 0.f), 1.f));
+	}
+
+	// the clipped polygon is convex, so it is split into a fan
+	for (size_t v = 1; v + 1 < vertex_count; v++)
+	{
+		ScreenTriangle triangle;
+		triangle.vertices[0] = screen[0];
+		triangle.vertices[1] = screen[v];
+		triangle.vertices[2] = screen[v + 1];
+		const glm::vec3 & a = triangle.vertices[0];
+		const glm::vec3 & b = triangle.vertices[1];
+		const glm::vec3 & c = triangle.vertices[2];
+		float determinant = (b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y);
+		if (std::abs(determinant) < 1e-6f) continue;
+		if (determinant < 0.f) std::swap(triangle.vertices[1], triangle.vertices[2]);
+
+		// the rows whose centers are covered
+		float min_y = std::min(a.y, std::min(b.y, c.y));
+		float max_y = std::max(a.y, std::max(b.y, c.y));
+		triangle.first_row = std::max(0, static_cast<int>(std::ceil(min_y - 0.5f)));
+		triangle.last_row = std::min(this->height - 1, static_cast<int>(std::floor(max_y - 0.5f)));
+		if (triangle.first_row > triangle.last_row) continue;
+		triangles.push_back(triangle);
+	}
+}
+
+void OcclusionCuller::rasterizeTriangle(const ScreenTriangle & triangle, int first_row, int end_row)
+{
+	const glm::vec3 & v0 = triangle.vertices[0];
+	const glm::vec3 & v1 = triangle.vertices[1];
+	const glm::vec3 & v2 = triangle.vertices[2];
+
+	// edge functions A * x + B * y + C, which are positive inside of the counter-clockwise triangle
+	float edge_a[3], edge_b[3], edge_c[3];
+	const glm::vec3 * edges[3][2] = { { &v0, &v1 }, { &v1, &v2 }, { &v2, &v0 } };
+	for (int e = 0; e < 3; e++)
+	{
+		const glm::vec3 & a = *edges[e][0];
+		const glm::vec3 & b = *edges[e][1];
+		edge_a[e] = a.y - b.y;
+		edge_b[e] = b.x - a.x;
+		edge_c[e] = a.x * b.y - a.y * b.x;
+	}
+
+	// the depth is linear in screen space, the farthest depth inside of a pixel is stored to stay conservative
+	float determinant = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+	float dz_dx = ((v1.z - v0.z) * (v2.y - v0.y) - (v2.z - v0.z) * (v1.y - v0.y)) / determinant;
+	float dz_dy = ((v2.z - v0.z) * (v1.x - v0.x) - (v1.z - v0.z) * (v2.x - v0.x)) / determinant;
+	float bias = 0.5f * (std::abs(dz_dx) + std::abs(dz_dy));
+	float max_z = std::max(v0.z, std::max(v1.z, v2.z));
+
+	float min_x = std::min(v0.x, std::min(v1.x, v2.x));
+	float max_x = std::max(v0.x, std::max(v1.x, v2.x));
+	int first_column = std::max(0, static_cast<int>(std::ceil(min_x - 0.5f))) & ~3;
+	int last_column = std::min(this->width - 1, static_cast<int>(std::floor(max_x - 0.5f)));
+	int row_begin = std::max(first_row, triangle.first_row);
+	int row_end = std::min(end_row - 1, triangle.last_row);
+
+	for (int y = row_begin; y <= row_end; y++)
+	{
+		float center_y = y + 0.5f;
+		float row_edges[3];
+		for (int e = 0; e < 3; e++) row_edges[e] = edge_b[e] * center_y + edge_c[e];
+		float row_z = v0.z + dz_dy * (center_y - v0.y) - dz_dx * v0.x + bias;
+		float * row = &this->depth[static_cast<size_t>(y) * this->width];
+
+		int x = first_column;
+#ifdef GLRF_SSE2
+		const __m128 lane_offsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+		const __m128 zero = _mm_setzero_ps();
+		for (; x <= last_column; x += 4)
+		{
+			__m128 center_x = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), lane_offsets);
+			__m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(edge_a[0]), center_x), _mm_set1_ps(row_edges[0])), zero);
+			inside = _mm_and_ps(inside,
+				_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(edge_a[1]), center_x), _mm_set1_ps(row_edges[1])), zero));
+			inside = _mm_and_ps(inside,
+				_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(edge_a[2]), center_x), _mm_set1_ps(row_edges[2])), zero));
+			if (_mm_movemask_ps(inside) == 0) continue;
+
+			__m128 z = _mm_min_ps(_mm_add_ps(_mm_set1_ps(row_z), _mm_mul_ps(_mm_set1_ps(dz_dx), center_x)), _mm_set1_ps(max_z));
+			__m128 old_z = _mm_loadu_ps(row + x);
+			__m128 new_z = _mm_min_ps(old_z, z);
+			_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, new_z), _mm_andnot_ps(inside, old_z)));
+		}
+#endif
+		for (; x <= last_column; x++)
+		{
+			float center_x = x + 0.5f;
+			bool inside = edge_a[0] * center_x + row_edges[0] >= 0.f
+				&& edge_a[1] * center_x + row_edges[1] >= 0.f
+				&& edge_a[2] * center_x + row_edges[2] >= 0.f;
+			if (!inside) continue;
+			float z = std::min(row_z + dz_dx * center_x, max_z);
+			row[x] = std::min(row[x], z);
+		}
+	}
+}
+
+bool OcclusionCuller::isVisible(const BoundingBox & box) const
+{
+	float min_x = std::numeric_limits<float>::max(), min_y = std::numeric_limits<float>::max();
+	float max_x = std::numeric_limits<float>::lowest(), max_y = std::numeric_limits<float>::lowest();
+	float min_depth = 1.f;
+	for (int corner = 0; corner < 8; corner++)
+	{
+		glm::vec4 position = glm::vec4(
+			(corner & 1) ? box.max.x : box.min.x,
+			(corner & 2) ? box.max.y : box.min.y,
+			(corner & 4) ? box.max.z : box.min.z,
+			1.f);
+		glm::vec4 clip = this->view_projection * position;
+
+		// the projection of a box that crosses the near plane is unbounded
+		if (clip.z + clip.w <= 0.f) return true;
+		float x = (clip.x / clip.w * 0.5f + 0.5f) * this->width;
+		float y = (clip.y / clip.w * 0.5f + 0.5f) * this->height;
+		min_x = std::min(min_x, x);
+		max_x = std::max(max_x, x);
+		min_y = std::min(min_y, y);
+		max_y = std::max(max_y, y);
+		min_depth = std::min(min_depth, clip.z / clip.w * 0.5f + 0.5f);
+	}
+
+	// all pixels that the box touches are tested, boxes outside of the screen are left to the frustum culling
+	if (max_x < 0.f || max_y < 0.f || min_x >= this->width || min_y >= this->height) return true;
+	int first_column = std::max(0, static_cast<int>(std::floor(min_x))) & ~3;
+	int last_column = std::min(this->width - 1, static_cast<int>(std::floor(max_x)));
+	int first_row = std::max(0, static_cast<int>(std::floor(min_y)));
+	int last_row = std::min(this->height - 1, static_cast<int>(std::floor(max_y)));
+
+	for (int y = first_row; y <= last_row; y++)
+	{
+		const float * row = &this->depth[static_cast<size_t>(y) * this->width];
+		int x = first_column;
+#ifdef GLRF_SSE2
+		// the columns are extended to multiples of four, which can only make the box more visible
+		__m128 box_depth = _mm_set1_ps(min_depth);
+		for (; x <= last_column; x += 4)
+		{
+			if (_mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(row + x), box_depth)) != 0) return true;
+		}
+#endif
+		for (; x <= last_column; x++)
+		{
+			if (row[x] > min_depth) return true;
+		}
+	}
+	return false;
+}
+
+void OcclusionCuller::testVisibility(const BoundingBox * boxes, size_t count, uint8_t * visible)
+{
+	auto start = std::chrono::steady_clock::now();
+	WorkerPool::getInstance().parallelFor(count, MIN_BOXES_PER_RANGE, [&](size_t begin, size_t end, size_t) {
+		for (size_t i = begin; i < end; i++) visible[i] = isVisible(boxes[i]) ? 1 : 0;
+	});
+	size_t visible_count = 0;
+	for (size_t i = 0; i < count; i++) visible_count += visible[i];
+	this->statistics.tested_count += count;
+	this->statistics.culled_count += count - visible_count;
+	this->statistics.test_milliseconds += millisecondsSince(start);
+}
+
+float OcclusionCuller::getDepth(int x, int y) const
+{
+	return this->depth[static_cast<size_t>(y) * this->width + x];
+}
+
+int OcclusionCuller::getWidth() const
+{
+	return this->width;
+}
+
+int OcclusionCuller::getHeight() const
+{
+	return this->height;
+}
+
+const OcclusionCuller::Statistics & OcclusionCuller::getStatistics() const
+{
+	return this->statistics;
+}
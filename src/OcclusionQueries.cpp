@@ -0,0 +1,252 @@
+#include <GLRF/OcclusionQueries.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+using namespace GLRF;
+
+namespace {
+	const char * BOX_VERTEX_SOURCE =
+		"#version 330 core\n"
+		"layout (location = 0) in vec3 position;\n"
+		"uniform mat4 box_to_clip;\n"
+		"void main() { gl_Position = box_to_clip * vec4(position, 1.0); }\n";
+
+	const char * BOX_FRAGMENT_SOURCE =
+		"#version 330 core\n"
+		"void main() {}\n";
+
+	const glm::vec3 CUBE_VERTICES[] = {
+		glm::vec3(0.f, 0.f, 0.f), glm::vec3(1.f, 0.f, 0.f), glm::vec3(1.f, 1.f, 0.f), glm::vec3(0.f, 1.f, 0.f),
+		glm::vec3(0.f, 0.f, 1.f), glm::vec3(1.f, 0.f, 1.f), glm::vec3(1.f, 1.f, 1.f), glm::vec3(0.f, 1.f, 1.f)
+	};
+
+	// counter-clockwise from the outside
+	const GLuint CUBE_INDICES[] = {
+		0, 3, 2, 0, 2, 1,
+		4, 5, 6, 4, 6, 7,
+		0, 1, 5, 0, 5, 4,
+		3, 7, 6, 3, 6, 2,
+		0, 4, 7, 0, 7, 3,
+		1, 2, 6, 1, 6, 5
+	};
+}
+
+OcclusionQueries::OcclusionQueries()
+{
+
+}
+
+OcclusionQueries::~OcclusionQueries()
+{
+	for (auto & entry : this->states)
+	{
+		if (entry.second.query != 0) this->free_queries.push_back(entry.second.query);
+	}
+	if (!this->free_queries.empty())
+	{
+		glDeleteQueries(static_cast<GLsizei>(this->free_queries.size()), this->free_queries.data());
+	}
+
+	GLStateCache & state = GLStateCache::getInstance();
+	if (this->program != 0)
+	{
+		glDeleteProgram(this->program);
+		state.deletedProgram(this->program);
+	}
+	if (this->vertex_array != 0)
+	{
+		glDeleteVertexArrays(1, &(this->vertex_array));
+		state.deletedVertexArray(this->vertex_array);
+		GLuint buffers[] = { this->vertex_buffer, this->index_buffer };
+		glDeleteBuffers(2, buffers);
+		state.deletedBuffer(this->vertex_buffer);
+		state.deletedBuffer(this->index_buffer);
+	}
+}
+
+GLuint OcclusionQueries::compile(GLenum type, const char * source)
+{
+	GLuint shader = glCreateShader(type);
+	glShaderSource(shader, 1, &source, NULL);
+	glCompileShader(shader);
+	GLint success = 0;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+	if (!success)
+	{
+		char log[1024];
+		glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+		glDeleteShader(shader);
+		throw std::runtime_error(std::string("cannot build occlusion query program: ") + log);
+	}
+	return shader;
+}
+
+void OcclusionQueries::create()
+{
+	GLuint vertex_shader = compile(GL_VERTEX_SHADER, BOX_VERTEX_SOURCE);
+	GLuint fragment_shader = compile(GL_FRAGMENT_SHADER, BOX_FRAGMENT_SOURCE);
+	this->program = glCreateProgram();
+	glAttachShader(this->program, vertex_shader);
+	glAttachShader(this->program, fragment_shader);
+	glLinkProgram(this->program);
+	glDeleteShader(vertex_shader);
+	glDeleteShader(fragment_shader);
+	GLint success = 0;
+	glGetProgramiv(this->program, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		char log[1024];
+		glGetProgramInfoLog(this->program, sizeof(log), NULL, log);
+		throw std::runtime_error(std::string("cannot build occlusion query program: ") + log);
+	}
+	this->box_to_clip_location = glGetUniformLocation(this->program, "box_to_clip");
+
+	GLStateCache & state = GLStateCache::getInstance();
+	glGenVertexArrays(1, &(this->vertex_array));
+	glGenBuffers(1, &(this->vertex_buffer));
+	glGenBuffers(1, &(this->index_buffer));
+	state.bindVertexArray(this->vertex_array);
+	state.bindBuffer(GL_ARRAY_BUFFER, this->vertex_buffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(CUBE_VERTICES), CUBE_VERTICES, GL_STATIC_DRAW);
+	state.bindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->index_buffer);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(CUBE_INDICES), CUBE_INDICES, GL_STATIC_DRAW);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+	state.bindVertexArray(0);
+}
+
+void OcclusionQueries::beginFrame()
+{
+	this->frame++;
+	this->statistics = Statistics();
+
+	// results are only read if they are available, so the CPU never waits for the GPU
+	for (auto & entry : this->states)
+	{
+		NodeState & node_state = entry.second;
+		if (!node_state.pending) continue;
+		GLuint available = GL_FALSE;
+		glGetQueryObjectuiv(node_state.query, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+		{
+			this->statistics.pending_count++;
+			continue;
+		}
+		GLuint result = 0;
+		glGetQueryObjectuiv(node_state.query, GL_QUERY_RESULT, &result);
+		node_state.pending = false;
+		node_state.visible = result != 0;
+		node_state.next_query_frame = node_state.visible ? this->frame + REQUERY_INTERVAL : this->frame;
+	}
+}
+
+void OcclusionQueries::request(IdSpaceSize node_id, const BoundingBox & box, FrameBuffer * framebuffer)
+{
+	NodeState & node_state = this->states[node_id];
+	node_state.request_frame = this->frame;
+	this->statistics.requested_count++;
+	if (node_state.pending || this->frame < node_state.next_query_frame) return;
+	this->requests.push_back({ node_id, box, framebuffer });
+}
+
+bool OcclusionQueries::isOccluded(IdSpaceSize node_id)
+{
+	auto it = this->states.find(node_id);
+	if (it == this->states.end() || it->second.pending || it->second.visible) return false;
+	this->statistics.occluded_count++;
+	return true;
+}
+
+GLuint OcclusionQueries::getCondition(IdSpaceSize node_id)
+{
+	auto it = this->states.find(node_id);
+	if (it == this->states.end() || !it->second.pending) return 0;
+	this->statistics.conditional_count++;
+	return it->second.query;
+}
+
+void OcclusionQueries::issueQueries(const glm::mat4 & view_projection)
+{
+	if (this->requests.empty()) return;
+	if (this->program == 0) create();
+
+	GLStateCache & state = GLStateCache::getInstance();
+	state.useProgram(this->program);
+	state.bindVertexArray(this->vertex_array);
+	state.setEnabled(GL_DEPTH_TEST, true);
+	state.depthMask(GL_FALSE);
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+	GLenum target = GLCapabilities::getInstance().conservative_occlusion_query
+		? GL_ANY_SAMPLES_PASSED_CONSERVATIVE : GL_ANY_SAMPLES_PASSED;
+
+	std::stable_sort(this->requests.begin(), this->requests.end(),
+		[](const Request & a, const Request & b) { return a.framebuffer < b.framebuffer; });
+	for (const Request & request : this->requests)
+	{
+		NodeState & node_state = this->states[request.node_id];
+
+		// a box that crosses the near plane is clipped and could hide the node although the camera is inside of it
+		glm::mat4 box_to_clip = view_projection
+			* glm::scale(glm::translate(glm::mat4(1.f), request.box.min), request.box.max - request.box.min);
+		bool crosses_near_plane = false;
+		for (const glm::vec3 & corner : CUBE_VERTICES)
+		{
+			glm::vec4 clip = box_to_clip * glm::vec4(corner, 1.f);
+			if (clip.z + clip.w <= 0.f) crosses_near_plane = true;
+		}
+		if (crosses_near_plane)
+		{
+			node_state.visible = true;
+			node_state.next_query_frame = this->frame + 1;
+			continue;
+		}
+
+		if (node_state.query == 0)
+		{
+			if (this->free_queries.empty())
+			{
+				glGenQueries(1, &(node_state.query));
+			}
+			else
+			{
+				node_state.query = this->free_queries.back();
+				this->free_queries.pop_back();
+			}
+		}
+		request.framebuffer->use();
+		glUniformMatrix4fv(this->box_to_clip_location, 1, GL_FALSE, glm::value_ptr(box_to_clip));
+		glBeginQuery(target, node_state.query);
+		glDrawElements(GL_TRIANGLES, sizeof(CUBE_INDICES) / sizeof(CUBE_INDICES[0]), GL_UNSIGNED_INT, (void*)0);
+		glEndQuery(target);
+		node_state.pending = true;
+		this->statistics.issued_count++;
+	}
+	this->requests.clear();
+
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	state.depthMask(GL_TRUE);
+}
+
+void OcclusionQueries::endFrame()
+{
+	for (auto it = this->states.begin(); it != this->states.end();)
+	{
+		if (this->frame - it->second.request_frame < RETAIN_FRAMES)
+		{
+			it++;
+			continue;
+		}
+		if (it->second.query != 0) this->free_queries.push_back(it->second.query);
+		it = this->states.erase(it);
+	}
+}
+
+const OcclusionQueries::Statistics & OcclusionQueries::getStatistics() const
+{
+	return this->statistics;
+}
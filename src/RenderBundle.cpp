@@ -0,0 +1,62 @@
+#include <GLRF/RenderBundle.hpp>
+
+using namespace GLRF;
+
+DrawList::DrawList(GLuint frames_in_flight)
+{
+	this->frames_in_flight = frames_in_flight;
+}
+
+void DrawList::clear()
+{
+	this->pending_draws.clear();
+	this->framebuffer_ranks.clear();
+	this->render_queue.clear();
+	this->indirect_batches.clear();
+}
+
+RenderBundle::RenderBundle(const std::vector<std::shared_ptr<SceneNode<SceneObject>>> & nodes) : draws(1)
+{
+	this->nodes = nodes;
+}
+
+RenderBundle::~RenderBundle()
+{
+
+}
+
+const std::vector<std::shared_ptr<SceneNode<SceneObject>>>& RenderBundle::getNodes()
+{
+	return this->nodes;
+}
+
+void RenderBundle::invalidate()
+{
+	this->recorded = false;
+}
+
+uint64_t RenderBundle::getRecordCount()
+{
+	return this->record_count;
+}
+
+bool RenderBundle::isValid(const std::map<GLuint, FrameBuffer*> & map_shader_fbs)
+{
+	if (!this->recorded) return false;
+	if (this->variant_generation != ShaderManager::getInstance().getVariantGeneration()) return false;
+	if (this->material_generation != Material::getDrawGeneration()) return false;
+	return this->framebuffers == map_shader_fbs;
+}
+
+void RenderBundle::finishRecording(const std::map<GLuint, FrameBuffer*> & map_shader_fbs)
+{
+	// synced materials only increase the draw generation again when they change after the recording
+	ShaderManager & shader_manager = ShaderManager::getInstance();
+	uint64_t frame = shader_manager.getFrame();
+	for (Material * material : this->materials) material->sync(frame);
+	this->framebuffers = map_shader_fbs;
+	this->variant_generation = shader_manager.getVariantGeneration();
+	this->material_generation = Material::getDrawGeneration();
+	this->recorded = true;
+	this->record_count++;
+}
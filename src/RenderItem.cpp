@@ -0,0 +1,95 @@
+#include <GLRF/RenderItem.hpp>
+
+using namespace GLRF;
+
+void RenderItem::bind() const
+{
+	RenderItemFormats::getInstance().getFormat(this->format).bind_vertex_array(this->geometry);
+	applyRasterState(this->mode);
+}
+
+void RenderItem::draw() const
+{
+	bind();
+	if (hasIndices())
+	{
+		void * index_offset = reinterpret_cast<void*>(sizeof(GLuint) * static_cast<size_t>(this->first_index));
+		glDrawElementsBaseVertex(this->mode, static_cast<GLsizei>(this->count), GL_UNSIGNED_INT, index_offset, this->base_vertex);
+	}
+	else
+	{
+		glDrawArrays(this->mode, this->base_vertex, static_cast<GLsizei>(this->count));
+	}
+}
+
+void RenderItem::drawInstanced(InstanceBuffer * instances, size_t first_instance, GLsizei instance_count) const
+{
+	RenderItemFormats::getInstance().getFormat(this->format).attach_instance_buffer(this->geometry, instances);
+	bind();
+
+	GLuint base_instance = instances->getBaseInstance(first_instance);
+	if (hasIndices())
+	{
+		void * index_offset = reinterpret_cast<void*>(sizeof(GLuint) * static_cast<size_t>(this->first_index));
+		glDrawElementsInstancedBaseVertexBaseInstance(this->mode, static_cast<GLsizei>(this->count), GL_UNSIGNED_INT,
+			index_offset, instance_count, this->base_vertex, base_instance);
+	}
+	else
+	{
+		glDrawArraysInstancedBaseInstance(this->mode, this->base_vertex, static_cast<GLsizei>(this->count),
+			instance_count, base_instance);
+	}
+}
+
+DrawElementsIndirectCommand RenderItem::getIndirectCommand() const
+{
+	return { this->count, 1, this->first_index, this->base_vertex, 0 };
+}
+
+void RenderItem::applyRasterState(GLenum mode)
+{
+	GLStateCache & state = GLStateCache::getInstance();
+	switch (mode)
+	{
+	case GL_POINTS:
+		state.pointSize(8.f);
+		break;
+	case GL_LINES:
+	case GL_LINE_STRIP:
+	case GL_LINES_ADJACENCY:
+	case GL_LINE_STRIP_ADJACENCY:
+		state.lineWidth(3.f);
+		break;
+	default:
+		break;
+	}
+}
+
+RenderItemFormats::RenderItemFormats()
+{
+
+}
+
+RenderItemFormats::~RenderItemFormats()
+{
+
+}
+
+const RenderItemFormat & RenderItemFormats::getFormat(GLuint format_id)
+{
+	return this->formats[format_id];
+}
+
+uint64_t RenderItemFormats::getGeneration()
+{
+	// the counters only increase, so their sum increases whenever one of them does
+	uint64_t generation = 0;
+	for (const RenderItemFormat & format : this->formats) generation += format.get_generation();
+	return generation;
+}
+
+GLuint RenderItemFormats::add(const RenderItemFormat & format)
+{
+	this->formats.push_back(format);
+	return static_cast<GLuint>(this->formats.size() - 1);
+}
@@ -0,0 +1,91 @@
+#include <GLRF/RenderQueue.hpp>
+
+using namespace GLRF;
+
+RenderQueue::RenderQueue()
+{
+
+}
+
+RenderQueue::~RenderQueue()
+{
+
+}
+
+uint32_t RenderQueue::quantizeDepth(float depth)
+{
+	// the bits of non-negative floats are ordered like their values, so the upper bits can be compared directly
+	if (!(depth > 0.f)) return 0;
+	uint32_t bits;
+	std::memcpy(&bits, &depth, sizeof(bits));
+	return bits >> (32 - DEPTH_BITS);
+}
+
+uint64_t RenderQueue::createKey(uint32_t framebuffer, bool translucent, uint32_t program, uint32_t material, uint32_t mesh, float depth)
+{
+	const uint64_t depth_mask = (1ull << DEPTH_BITS) - 1;
+	uint64_t state = (static_cast<uint64_t>(program & ((1u << PROGRAM_BITS) - 1)) << (MATERIAL_BITS + MESH_BITS))
+		| (static_cast<uint64_t>(material & ((1u << MATERIAL_BITS) - 1)) << MESH_BITS)
+		| static_cast<uint64_t>(mesh & ((1u << MESH_BITS) - 1));
+	uint64_t depth_bits = quantizeDepth(depth);
+
+	uint64_t key = static_cast<uint64_t>(framebuffer & ((1u << FRAMEBUFFER_BITS) - 1)) << 58;
+	if (translucent)
+	{
+		key |= 1ull << 57;
+		key |= ((~depth_bits) & depth_mask) << (PROGRAM_BITS + MATERIAL_BITS + MESH_BITS);
+		key |= state;
+	}
+	else
+	{
+		key |= state << DEPTH_BITS;
+		key |= depth_bits;
+	}
+	return key;
+}
+
+void RenderQueue::clear()
+{
+	this->items.clear();
+}
+
+void RenderQueue::push(uint64_t key, uint32_t index)
+{
+	this->items.push_back({ key, index });
+}
+
+void RenderQueue::sort()
+{
+	const size_t count = this->items.size();
+	if (count < 2) return;
+	this->scratch.resize(count);
+
+	for (unsigned int shift = 0; shift < 64; shift += 8)
+	{
+		size_t histogram[256] = { 0 };
+		for (const RenderQueueItem & item : this->items) histogram[(item.key >> shift) & 0xFF]++;
+
+		// all keys share this byte, so the pass would not change the order
+		if (histogram[(this->items[0].key >> shift) & 0xFF] == count) continue;
+
+		size_t offset = 0;
+		for (size_t & bucket : histogram)
+		{
+			size_t bucket_count = bucket;
+			bucket = offset;
+			offset += bucket_count;
+		}
+		for (const RenderQueueItem & item : this->items) this->scratch[histogram[(item.key >> shift) & 0xFF]++] = item;
+		this->items.swap(this->scratch);
+	}
+}
+
+size_t RenderQueue::size()
+{
+	return this->items.size();
+}
+
+const std::vector<RenderQueueItem>& RenderQueue::getItems()
+{
+	return this->items;
+}
@@ -2,6 +2,20 @@
 
 using namespace GLRF;
 
+namespace {
+	const UniformId ID_VIEW = UniformRegistry::getInstance().intern("view");
+	const UniformId ID_CAMERA_POSITION = UniformRegistry::getInstance().intern("camera_position");
+	const UniformId ID_CAMERA_VIEW_DIR = UniformRegistry::getInstance().intern("camera_view_dir");
+	const UniformId ID_POINT_LIGHT_COUNT = UniformRegistry::getInstance().intern("pointLight_count");
+	const UniformId ID_DIRECTIONAL_LIGHT_DIRECTION = UniformRegistry::getInstance().intern("directionalLight_direction");
+	const UniformId ID_DIRECTIONAL_LIGHT_POWER = UniformRegistry::getInstance().intern("directionalLight_power");
+	const UniformId ID_USE_DIRECTIONAL_LIGHT = UniformRegistry::getInstance().intern("useDirectionalLight");
+	const UniformId ID_PROJECTION = UniformRegistry::getInstance().intern("projection");
+	const UniformId ID_MODEL = UniformRegistry::getInstance().intern("model");
+	const UniformId ID_MODEL_NORMAL = UniformRegistry::getInstance().intern("model_normal");
+	const UniformId ID_MATERIAL = UniformRegistry::getInstance().intern("material");
+}
+
 Scene::Scene(std::shared_ptr<Camera> camera) {
 	addObject(camera);
 	setActiveCamera(camera);
@@ -13,6 +27,174 @@ Scene::Scene() {
 	);
 }
 
+Scene::~Scene() {
+	// nodes and objects may outlive the scene, so they must not report into its lists anymore
+	for (NodeSlot & node_slot : this->node_slots) {
+		if (!node_slot.node) continue;
+		node_slot.node->trackMoves(nullptr, 0);
+		node_slot.object->untrackChanges(&this->changed_objects);
+	}
+}
+
+void Scene::registerNode(const std::shared_ptr<SceneNode<SceneObject>> & node, RenderBundle * bundle) {
+	if (node->isTracked()) throw std::invalid_argument("node is already drawn by another scene");
+	uint32_t slot;
+	if (this->free_slots.empty()) {
+		slot = static_cast<uint32_t>(this->node_slots.size());
+		this->node_slots.emplace_back();
+		this->render_items.emplace_back();
+	} else {
+		slot = this->free_slots.back();
+		this->free_slots.pop_back();
+	}
+
+	NodeSlot & node_slot = this->node_slots[slot];
+	node_slot.node = node;
+	node_slot.object = node->getObject().get();
+	node_slot.bundle = bundle;
+	node_slot.proxy = SpatialIndex::NULL_PROXY;
+	refreshSlot(slot);
+	if (this->object_slots.count(node_slot.object) == 0) node_slot.object->trackChanges(&this->changed_objects);
+	node->trackMoves(&this->moved_nodes, slot);
+	this->object_slots.insert({ node_slot.object, slot });
+	insertProxy(slot);
+}
+
+void Scene::unregisterNode(uint32_t slot) {
+	// the lists of changes may still point to the node and its object
+	processChanges();
+	removeProxy(slot);
+
+	SceneObject * obj = this->node_slots[slot].object;
+	auto range = this->object_slots.equal_range(obj);
+	for (auto it = range.first; it != range.second; it++) {
+		if (it->second != slot) continue;
+		this->object_slots.erase(it);
+		break;
+	}
+	if (this->object_slots.count(obj) == 0) obj->untrackChanges(&this->changed_objects);
+	this->node_slots[slot].node->trackMoves(nullptr, 0);
+
+	this->node_slots[slot] = NodeSlot();
+	this->render_items[slot] = RenderItem();
+	this->free_slots.push_back(slot);
+}
+
+void Scene::insertProxy(uint32_t slot) {
+	NodeSlot & node_slot = this->node_slots[slot];
+	if (!node_slot.object->hasBounds()) {
+		if (!node_slot.bundle) this->unbounded_slots.push_back(slot);
+		return;
+	}
+
+	node_slot.proxy = this->spatial_index->insert(
+		node_slot.object->getBounds().box.transform(node_slot.node->calculateModelMatrix()));
+	if (this->proxy_slots.size() < this->spatial_index->getProxyCapacity()) {
+		this->proxy_slots.resize(this->spatial_index->getProxyCapacity());
+	}
+	this->proxy_slots[node_slot.proxy] = slot;
+}
+
+void Scene::removeProxy(uint32_t slot) {
+	NodeSlot & node_slot = this->node_slots[slot];
+	if (node_slot.proxy == SpatialIndex::NULL_PROXY) {
+		auto it = std::find(this->unbounded_slots.begin(), this->unbounded_slots.end(), slot);
+		if (it != this->unbounded_slots.end()) this->unbounded_slots.erase(it);
+		return;
+	}
+	this->spatial_index->remove(node_slot.proxy);
+	node_slot.proxy = SpatialIndex::NULL_PROXY;
+}
+
+void Scene::refreshSlot(uint32_t slot) {
+	NodeSlot & node_slot = this->node_slots[slot];
+	RenderItem & item = this->render_items[slot];
+	item = RenderItem();
+	node_slot.has_item = node_slot.object->getRenderItem(&item);
+
+	// objects without an item are drawn by themselves, but their program is still selected through the item
+	node_slot.material = node_slot.object->getMaterial();
+	item.shader_id = node_slot.object->getShaderID();
+	item.material = node_slot.material.get();
+	item.material_index = item.material ? static_cast<GLuint>(item.material->getID()) : 0;
+}
+
+void Scene::processChanges() {
+	// bundles are recorded again if any of their nodes moved or objects changed
+	for (SceneNode<SceneObject> * node : this->moved_nodes) {
+		node->clearMoved();
+		const NodeSlot & node_slot = this->node_slots[node->getSlot()];
+		if (node_slot.bundle) node_slot.bundle->invalidate();
+		if (node_slot.proxy == SpatialIndex::NULL_PROXY) continue;
+		this->spatial_index->update(node_slot.proxy, node_slot.object->getBounds().box.transform(node->calculateModelMatrix()));
+	}
+	this->moved_nodes.clear();
+
+	// a compaction of a GeometryPool changes the base vertices and first indices of many items at once
+	uint64_t geometry_generation = RenderItemFormats::getInstance().getGeneration();
+	if (geometry_generation != this->geometry_generation) {
+		this->geometry_generation = geometry_generation;
+		for (uint32_t slot = 0; slot < this->node_slots.size(); slot++) {
+			if (this->node_slots[slot].node) refreshSlot(slot);
+		}
+		for (auto & bundle : this->bundles) bundle->invalidate();
+	}
+
+	for (SceneObject * obj : this->changed_objects) {
+		obj->clearChanged(&this->changed_objects);
+		auto range = this->object_slots.equal_range(obj);
+		for (auto it = range.first; it != range.second; it++) {
+			refreshSlot(it->second);
+			const NodeSlot & node_slot = this->node_slots[it->second];
+			if (node_slot.bundle) node_slot.bundle->invalidate();
+			if (node_slot.proxy == SpatialIndex::NULL_PROXY) continue;
+			this->spatial_index->update(node_slot.proxy, obj->getBounds().box.transform(node_slot.node->calculateModelMatrix()));
+		}
+	}
+	this->changed_objects.clear();
+}
+
+void Scene::setSpatialIndex(std::unique_ptr<SpatialIndex> index) {
+	processChanges();
+	this->spatial_index = std::move(index);
+	this->proxy_slots.clear();
+	this->unbounded_slots.clear();
+	for (uint32_t slot = 0; slot < this->node_slots.size(); slot++) {
+		NodeSlot & node_slot = this->node_slots[slot];
+		node_slot.proxy = SpatialIndex::NULL_PROXY;
+		if (node_slot.node) insertProxy(slot);
+	}
+}
+
+std::vector<std::shared_ptr<SceneNode<SceneObject>>> Scene::queryNodes(const Frustum & frustum) {
+	processChanges();
+	std::vector<int32_t> proxies;
+	this->spatial_index->query(frustum, proxies);
+	return getProxyNodes(proxies);
+}
+
+std::vector<std::shared_ptr<SceneNode<SceneObject>>> Scene::queryNodes(const BoundingSphere & sphere) {
+	processChanges();
+	std::vector<int32_t> proxies;
+	this->spatial_index->query(sphere, proxies);
+	return getProxyNodes(proxies);
+}
+
+std::vector<std::shared_ptr<SceneNode<SceneObject>>> Scene::raycast(const glm::vec3 & origin, const glm::vec3 & direction,
+	float max_distance) {
+	processChanges();
+	std::vector<int32_t> proxies;
+	this->spatial_index->raycast(origin, direction, max_distance, proxies);
+	return getProxyNodes(proxies);
+}
+
+std::vector<std::shared_ptr<SceneNode<SceneObject>>> Scene::getProxyNodes(const std::vector<int32_t> & proxies) {
+	std::vector<std::shared_ptr<SceneNode<SceneObject>>> nodes;
+	nodes.reserve(proxies.size());
+	for (int32_t proxy : proxies) nodes.push_back(this->node_slots[this->proxy_slots[proxy]].node);
+	return nodes;
+}
+
 std::shared_ptr<SceneNode<PointLight>> Scene::addObject(std::shared_ptr<PointLight> light) {
 	std::shared_ptr<SceneNode<PointLight>> node(new SceneNode<PointLight>(light));
 	this->pointLights.push_back(node);
@@ -37,50 +219,522 @@ void Scene::setActiveCamera(std::shared_ptr<Camera> camera) {
 	this->activeCamera = camera;
 }
 
-void Scene::draw(ShaderConfiguration * configuration, std::map<GLuint, FrameBuffer*> & map_shader_fbs) {
-	ShaderManager & shader_manager = ShaderManager::getInstance();
-	shader_manager.clearDrawConfigurations();
+void Scene::updateSceneUniforms(const glm::mat4 & projection) {
+	SceneUniformBlock block;
+	block.view = this->activeCamera->getViewMatrix();
+	block.projection = projection;
+	block.camera_position = glm::vec4(this->activeCamera->getPosition(), 1.f);
+	block.camera_view_dir = glm::vec4(- this->activeCamera->getW(), 0.f);
 
+	GLuint point_light_count = static_cast<GLuint>(std::min<size_t>(this->pointLights.size(), MAX_POINT_LIGHTS));
+	for (GLuint i = 0; i < point_light_count; i++) {
+		auto light = this->pointLights[i]->getObject();
+		block.pointLight_position[i] = glm::vec4(this->pointLights[i]->getPosition(), 1.f);
+		block.pointLight_color_power[i] = glm::vec4(light->getColor(), light->getPower());
+	}
+	block.pointLight_count = point_light_count;
+
+	if (this->directionalLights.size() > 0) {
+		glm::vec3 light_dir = glm::vec3(this->directionalLights[0]->calculateModelMatrix()
+			* glm::vec4(this->directionalLights[0]->getObject()->getDirection(), 0.f));
+		block.directionalLight_direction_power = glm::vec4(light_dir, this->directionalLights[0]->getObject()->getPower());
+		block.useDirectionalLight = GL_TRUE;
+	} else {
+		block.directionalLight_direction_power = glm::vec4(0.f);
+		block.useDirectionalLight = GL_FALSE;
+	}
+
+	if (!this->scene_uniform_buffer) {
+		this->scene_uniform_buffer.reset(new UniformBuffer(sizeof(SceneUniformBlock)));
+	}
+	this->scene_uniform_buffer->upload(&block, sizeof(SceneUniformBlock));
+	this->scene_uniform_buffer->bindBase(SCENE_BLOCK_BINDING);
+}
+
+void Scene::writeLegacySceneUniforms(ShaderConfiguration * configuration) {
 	glm::mat4 view = this->activeCamera->getViewMatrix();
-	configuration->setMat4("view", view);
-	configuration->setVec3("camera_position", this->activeCamera->getPosition());
-	configuration->setVec3("camera_view_dir", - this->activeCamera->getW());
+	configuration->setMat4(ID_VIEW, view);
+	configuration->setVec3(ID_CAMERA_POSITION, this->activeCamera->getPosition());
+	configuration->setVec3(ID_CAMERA_VIEW_DIR, - this->activeCamera->getW());
+
+	// the names of the light array elements are interned once: position, color and power per light
+	UniformRegistry & registry = UniformRegistry::getInstance();
+	for (size_t i = this->point_light_uniform_ids.size() / 3; i < this->pointLights.size(); i++) {
+		std::string index = "[" + std::to_string(i) + "]";
+		this->point_light_uniform_ids.push_back(registry.intern("pointLight_position" + index));
+		this->point_light_uniform_ids.push_back(registry.intern("pointLight_color" + index));
+		this->point_light_uniform_ids.push_back(registry.intern("pointLight_power" + index));
+	}
 
 	for (unsigned int i = 0; i < this->pointLights.size(); i++) {
-		configuration->setVec3("pointLight_position[" + std::to_string(i) + "]", pointLights[i]->getPosition());
-		configuration->setVec3("pointLight_color[" + std::to_string(i) + "]", this->pointLights[i]->getObject()->getColor());
-		configuration->setFloat("pointLight_power[" + std::to_string(i) + "]", this->pointLights[i]->getObject()->getPower());
+		const UniformId * ids = &this->point_light_uniform_ids[3 * static_cast<size_t>(i)];
+		configuration->setVec3(ids[0], pointLights[i]->getPosition());
+		configuration->setVec3(ids[1], this->pointLights[i]->getObject()->getColor());
+		configuration->setFloat(ids[2], this->pointLights[i]->getObject()->getPower());
 	}
-	configuration->setUInt("pointLight_count", static_cast<unsigned int>(this->pointLights.size()));
+	configuration->setUInt(ID_POINT_LIGHT_COUNT, static_cast<unsigned int>(this->pointLights.size()));
 
 	if (this->directionalLights.size() > 0) {
 		glm::vec3 light_dir = glm::vec3(this->directionalLights[0]->calculateModelMatrix()
 			* glm::vec4(this->directionalLights[0]->getObject()->getDirection(), 0.f));
-		configuration->setVec3("directionalLight_direction", light_dir);
-		configuration->setFloat("directionalLight_power", this->directionalLights[0]->getObject()->getPower());
-		configuration->setBool("useDirectionalLight", true);
+		configuration->setVec3(ID_DIRECTIONAL_LIGHT_DIRECTION, light_dir);
+		configuration->setFloat(ID_DIRECTIONAL_LIGHT_POWER, this->directionalLights[0]->getObject()->getPower());
+		configuration->setBool(ID_USE_DIRECTIONAL_LIGHT, true);
 	} else {
-		configuration->setBool("useDirectionalLight", false);
+		configuration->setBool(ID_USE_DIRECTIONAL_LIGHT, false);
 	}
+}
 
-	for (unsigned int i = 0; i < this->objectNodes.size(); i++) {
-		auto obj = this->objectNodes[i]->getObject();
-		GLuint shader_id = obj->getShaderID();
-		auto it = map_shader_fbs.find(shader_id);
-		if (it == map_shader_fbs.end()) continue;
+std::shared_ptr<RenderBundle> Scene::createBundle(const std::vector<std::shared_ptr<SceneNode<SceneObject>>> & nodes) {
+	// nodes are checked first, so that a rejected bundle leaves the scene unchanged
+	for (auto & node : nodes) {
+		uint32_t slot = node->getSlot();
+		bool registered = slot < this->node_slots.size() && this->node_slots[slot].node == node;
+		if (!registered && node->isTracked()) throw std::invalid_argument("node is already drawn by another scene");
+	}
 
-		auto fb = it->second;
-		fb->use();
+	std::shared_ptr<RenderBundle> bundle(new RenderBundle(std::vector<std::shared_ptr<SceneNode<SceneObject>>>()));
+	for (auto & node : nodes) {
+		uint32_t slot = node->getSlot();
+		if (slot >= this->node_slots.size() || this->node_slots[slot].node != node) {
+			registerNode(node, bundle.get());
+			slot = node->getSlot();
+		} else if (this->node_slots[slot].bundle) {
+			// a node is drawn by one bundle only, so nodes of other bundles and repeated nodes are skipped
+			continue;
+		} else {
+			// the node stays in the spatial index, but no longer counts as unbounded node of the frame
+			this->objectNodes.erase(std::find(this->objectNodes.begin(), this->objectNodes.end(), node));
+			bundle->taken_nodes.push_back(node);
+			NodeSlot & node_slot = this->node_slots[slot];
+			if (node_slot.proxy == SpatialIndex::NULL_PROXY) removeProxy(slot);
+			node_slot.bundle = bundle.get();
+		}
+		bundle->nodes.push_back(node);
+		bundle->slots.push_back(slot);
+	}
+	this->bundles.push_back(bundle);
+	return bundle;
+}
+
+void Scene::removeBundle(std::shared_ptr<RenderBundle> bundle) {
+	auto it = std::find(this->bundles.begin(), this->bundles.end(), bundle);
+	if (it == this->bundles.end()) return;
+	this->bundles.erase(it);
 
-		// load object-specific values into the internal shader
-		ShaderConfiguration object_configuration;
-		glm::mat4 modelMat = this->objectNodes[i]->calculateModelMatrix();
-		glm::mat3 modelNormalMat = glm::mat3(glm::transpose(glm::inverse(modelMat)));
-		object_configuration.setMat4("model", modelMat);
-		object_configuration.setMat3("model_normal", modelNormalMat);
-		
-		obj->draw(configuration, &object_configuration);
+	// only the nodes that were taken from the scene stay in it, the others were just registered for the bundle
+	for (auto & node : bundle->taken_nodes) {
+		this->objectNodes.push_back(node);
+		NodeSlot & node_slot = this->node_slots[node->getSlot()];
+		node_slot.bundle = nullptr;
+		if (node_slot.proxy == SpatialIndex::NULL_PROXY) insertProxy(node->getSlot());
 	}
+	for (uint32_t slot : bundle->slots) {
+		if (this->node_slots[slot].bundle == bundle.get()) unregisterNode(slot);
+	}
+}
+
+void Scene::setFrustumCulling(bool enabled) {
+	this->frustum_culling = enabled;
+}
+
+void Scene::setOcclusionCulling(bool enabled) {
+	this->occlusion_culling = enabled;
+}
+
+const OcclusionCuller::Statistics & Scene::getOcclusionStatistics() {
+	return this->occlusion_culler.getStatistics();
+}
+
+void Scene::setOcclusionQueries(bool enabled) {
+	this->occlusion_queries_enabled = enabled;
+}
+
+const OcclusionQueries::Statistics & Scene::getOcclusionQueryStatistics() {
+	return this->occlusion_queries.getStatistics();
+}
+
+void Scene::cullOccluded(const std::vector<uint32_t> & occluder_slots, const std::vector<uint32_t> & slots,
+	const glm::mat4 & view_projection, std::vector<uint32_t> & visible_slots) {
+	this->occlusion_culler.beginFrame(view_projection);
+	for (uint32_t slot : occluder_slots) {
+		const NodeSlot & node_slot = this->node_slots[slot];
+		OccluderGeometry geometry;
+		if (node_slot.object->getOccluderGeometry(&geometry)) {
+			this->occlusion_culler.addOccluder(geometry, node_slot.node->calculateModelMatrix());
+		}
+	}
+
+	visible_slots.clear();
+	if (this->occlusion_culler.getStatistics().occluder_count == 0) {
+		visible_slots.insert(visible_slots.end(), slots.begin(), slots.end());
+		return;
+	}
+	this->occlusion_culler.rasterize();
+
+	// occluders and nodes without bounds are always drawn, the boxes of all other nodes are tested at once
+	this->occludee_boxes.clear();
+	for (uint32_t slot : slots) {
+		const NodeSlot & node_slot = this->node_slots[slot];
+		if (node_slot.node->isOccluder() || !node_slot.object->hasBounds()) continue;
+		this->occludee_boxes.push_back(node_slot.object->getBounds().box.transform(node_slot.node->calculateModelMatrix()));
+	}
+	this->occludee_visible.resize(this->occludee_boxes.size());
+	this->occlusion_culler.testVisibility(this->occludee_boxes.data(), this->occludee_boxes.size(), this->occludee_visible.data());
+
+	size_t occludee_index = 0;
+	for (uint32_t slot : slots) {
+		const NodeSlot & node_slot = this->node_slots[slot];
+		if (node_slot.node->isOccluder() || !node_slot.object->hasBounds() || this->occludee_visible[occludee_index++]) {
+			visible_slots.push_back(slot);
+		}
+	}
+}
+
+void Scene::draw(ShaderConfiguration * configuration, std::map<GLuint, FrameBuffer*> & map_shader_fbs) {
+	ShaderManager & shader_manager = ShaderManager::getInstance();
+	shader_manager.beginFrame();
+
+	glm::mat4 projection = configuration->getMat4(ID_PROJECTION);
+	glm::mat4 view_projection = projection * this->activeCamera->getViewMatrix();
+	this->frustum = Frustum(view_projection);
+	updateSceneUniforms(projection);
+	if (shader_manager.requiresLegacySceneUniforms()) {
+		writeLegacySceneUniforms(configuration);
+	}
+	processChanges();
+
+	// materials are edited directly, so those of the bundles are synced before a changed feature mask or translucency
+	// is replayed (see Material::getDrawGeneration), invalidated bundles may hold replaced materials and record anyway
+	uint64_t frame = shader_manager.getFrame();
+	for (auto & bundle : this->bundles) {
+		if (!bundle->recorded) continue;
+		for (Material * material : bundle->materials) material->sync(frame);
+	}
+
+	// bundles are only recorded again if one of their nodes changed
+	for (auto & bundle : this->bundles) {
+		if (bundle->isValid(map_shader_fbs)) continue;
+		bundle->draws.clear();
+		bundle->translucent_slots.clear();
+		collectDraws(bundle->draws, bundle->slots, map_shader_fbs, &bundle->translucent_slots, nullptr, nullptr);
+		prepareDraws(bundle->draws);
+		bundle->materials.clear();
+		for (uint32_t slot : bundle->slots) {
+			if (this->node_slots[slot].material) bundle->materials.push_back(this->node_slots[slot].material.get());
+		}
+		std::sort(bundle->materials.begin(), bundle->materials.end());
+		bundle->materials.erase(std::unique(bundle->materials.begin(), bundle->materials.end()), bundle->materials.end());
+		bundle->finishRecording(map_shader_fbs);
+	}
+
+	// the dynamic nodes and the translucent nodes of all bundles are resolved every frame
+	this->frame_draws.clear();
+	OcclusionQueries * queries = this->occlusion_queries_enabled ? &this->occlusion_queries : nullptr;
+	if (queries) queries->beginFrame();
+	const Frustum * frustum = this->frustum_culling ? &this->frustum : nullptr;
+	if (this->frustum_culling) {
+		// only the visible nodes are collected, in the order of their slots so that the draws do not depend on the index,
+		// the nodes of bundles are indexed for queries but drawn by their bundles
+		this->visible_proxies.clear();
+		this->spatial_index->query(this->frustum, this->visible_proxies);
+		this->visible_slots.clear();
+		this->occluder_slots.clear();
+		for (int32_t proxy : this->visible_proxies) {
+			uint32_t slot = this->proxy_slots[proxy];
+			const NodeSlot & node_slot = this->node_slots[slot];
+			// bundled walls and floors are typical occluders, so they hide the dynamic nodes behind them
+			if (this->occlusion_culling && node_slot.node->isOccluder()) this->occluder_slots.push_back(slot);
+			if (!node_slot.bundle) this->visible_slots.push_back(slot);
+		}
+		std::sort(this->visible_slots.begin(), this->visible_slots.end());
+		if (this->occlusion_culling) {
+			cullOccluded(this->occluder_slots, this->visible_slots, view_projection, this->unoccluded_slots);
+			collectDraws(this->frame_draws, this->unoccluded_slots, map_shader_fbs, nullptr, nullptr, queries);
+		} else {
+			collectDraws(this->frame_draws, this->visible_slots, map_shader_fbs, nullptr, nullptr, queries);
+		}
+		collectDraws(this->frame_draws, this->unbounded_slots, map_shader_fbs, nullptr, nullptr, queries);
+	} else {
+		this->dynamic_slots.clear();
+		for (auto & node : this->objectNodes) this->dynamic_slots.push_back(node->getSlot());
+		if (this->occlusion_culling) {
+			this->occluder_slots.clear();
+			for (uint32_t slot = 0; slot < this->node_slots.size(); slot++) {
+				const NodeSlot & node_slot = this->node_slots[slot];
+				if (node_slot.node && node_slot.node->isOccluder()) this->occluder_slots.push_back(slot);
+			}
+			cullOccluded(this->occluder_slots, this->dynamic_slots, view_projection, this->unoccluded_slots);
+			collectDraws(this->frame_draws, this->unoccluded_slots, map_shader_fbs, nullptr, nullptr, queries);
+		} else {
+			collectDraws(this->frame_draws, this->dynamic_slots, map_shader_fbs, nullptr, nullptr, queries);
+		}
+	}
+	for (auto & bundle : this->bundles) {
+		collectDraws(this->frame_draws, bundle->translucent_slots, map_shader_fbs, nullptr, frustum, nullptr);
+	}
+	prepareDraws(this->frame_draws);
+
+	for (auto & bundle : this->bundles) submitDraws(bundle->draws, configuration);
+	submitDraws(this->frame_draws, configuration);
+
+	// the boxes are tested against the depth of this frame, their results decide about the next frames
+	if (queries) {
+		queries->issueQueries(view_projection);
+		queries->endFrame();
+	}
+}
+
+void Scene::collectDraws(DrawList & list, const std::vector<uint32_t> & slots, std::map<GLuint, FrameBuffer*> & map_shader_fbs,
+	std::vector<uint32_t> * translucent_slots, const Frustum * frustum, OcclusionQueries * queries) {
+	// the values of every draw are computed by worker threads from the slots and items, without asking the objects
+	WorkerPool & worker_pool = WorkerPool::getInstance();
+	list.ranges.resize(worker_pool.getThreadCount());
+	for (auto & range : list.ranges) range.draws.clear();
+	glm::vec3 camera_position = this->activeCamera->getPosition();
+	worker_pool.parallelFor(slots.size(), MIN_NODES_PER_RANGE, [&](size_t begin, size_t end, size_t range_index) {
+		DrawList::DrawRange & range = list.ranges[range_index];
+		std::vector<DrawList::PendingDraw> & draws = range.draws;
+		range.spheres.clear();
+		for (size_t i = begin; i < end; i++) {
+			const NodeSlot & node_slot = this->node_slots[slots[i]];
+			auto it = map_shader_fbs.find(this->render_items[slots[i]].shader_id);
+			if (it == map_shader_fbs.end()) continue;
+
+			DrawList::PendingDraw draw;
+			draw.object = node_slot.object;
+			draw.slot = slots[i];
+			draw.framebuffer = it->second;
+			draw.model = node_slot.node->calculateModelMatrix();
+			draws.push_back(draw);
+
+			if (!frustum) continue;
+			if (node_slot.object->hasBounds()) {
+				BoundingSphere sphere = node_slot.object->getBounds().sphere.transform(draw.model);
+				range.spheres.push_back(glm::vec4(sphere.center, sphere.radius));
+			} else {
+				range.spheres.push_back(glm::vec4(glm::vec3(draw.model[3]), std::numeric_limits<float>::infinity()));
+			}
+		}
+
+		// culled draws are removed before any other value is computed
+		if (frustum) {
+			range.visible.resize(range.spheres.size());
+			frustum->intersects(range.spheres.data(), range.spheres.size(), range.visible.data());
+			size_t visible_count = 0;
+			for (size_t d = 0; d < draws.size(); d++) {
+				if (range.visible[d]) draws[visible_count++] = draws[d];
+			}
+			draws.resize(visible_count);
+		}
+
+		for (DrawList::PendingDraw & draw : draws) {
+			draw.item = this->render_items[draw.slot];
+			draw.has_item = this->node_slots[draw.slot].has_item;
+			const Material * material = draw.item.material;
+			draw.program = 0;
+			draw.model_normal = glm::mat3(glm::transpose(glm::inverse(draw.model)));
+			draw.material_index = draw.item.material_index;
+			glm::vec3 offset = glm::vec3(draw.model[3]) - camera_position;
+			draw.depth = glm::dot(offset, offset);
+			draw.translucent = material && material->isTranslucent();
+			draw.instanced = false;
+			draw.indirect = false;
+			draw.condition_query = 0;
+		}
+	});
+
+	// resolving programs may request material variants, so the ranges are merged on this thread in the order of the nodes
+	ShaderManager & shader_manager = ShaderManager::getInstance();
+	bool base_instance = GLCapabilities::getInstance().base_instance;
+	for (auto & range : list.ranges) {
+		for (DrawList::PendingDraw & draw : range.draws) {
+			if (draw.translucent && translucent_slots) {
+				translucent_slots->push_back(draw.slot);
+				continue;
+			}
+
+			// nodes found hidden by their last query are skipped until a new query finds them visible
+			SceneNode<SceneObject> * node = this->node_slots[draw.slot].node.get();
+			if (queries && node->usesOcclusionQuery() && draw.object->hasBounds()) {
+				queries->request(node->id, draw.object->getBounds().box.transform(draw.model), draw.framebuffer);
+				if (queries->isOccluded(node->id)) continue;
+				draw.condition_query = queries->getCondition(node->id);
+			}
+
+			auto rank = std::find(list.framebuffer_ranks.begin(), list.framebuffer_ranks.end(), draw.framebuffer);
+			if (rank == list.framebuffer_ranks.end()) rank = list.framebuffer_ranks.insert(rank, draw.framebuffer);
+
+			draw.program = shader_manager.getMaterialVariant(draw.item.shader_id, draw.item.material);
+			Shader * shader = shader_manager.getShader(draw.program);
+			draw.indirect = draw.has_item && draw.item.hasIndices() && shader->usesDrawStorage();
+			// only objects without a render item are asked through a virtual call
+			bool supports_instancing = draw.has_item ? base_instance : draw.object->supportsInstancing();
+			draw.instanced = !draw.indirect && supports_instancing && shader->usesInstancing();
+			// a conditional render covers a single draw, so conditioned draws are not batched
+			if (draw.condition_query != 0) {
+				draw.indirect = false;
+				draw.instanced = false;
+			}
+
+			uint64_t key = RenderQueue::createKey(
+				static_cast<uint32_t>(rank - list.framebuffer_ranks.begin()),
+				draw.translucent,
+				draw.program,
+				draw.material_index,
+				static_cast<uint32_t>(draw.object->getObjectID()),
+				draw.depth);
+			list.render_queue.push(key, static_cast<uint32_t>(list.pending_draws.size()));
+			list.pending_draws.push_back(draw);
+		}
+	}
+}
+
+void Scene::prepareDraws(DrawList & list) {
+	list.render_queue.sort();
+	const std::vector<RenderQueueItem> & queue = list.render_queue.getItems();
+
+	// prepare the values of all draws in one pass, in the order of submission
+	if (!list.draw_data) {
+		list.draw_data.reset(new DrawDataBuffer(list.frames_in_flight));
+		list.instance_data.reset(new InstanceBuffer(list.frames_in_flight));
+	}
+	if (!list.indirect_data && GLCapabilities::getInstance().multi_draw_indirect) {
+		list.indirect_data.reset(new IndirectDrawBuffer(list.frames_in_flight));
+	}
+	list.draw_data->beginFrame();
+	list.draw_data->resize(queue.size());
+	list.instance_data->beginFrame();
+	list.instance_data->resize(queue.size());
+	if (list.indirect_data) {
+		list.indirect_data->beginFrame();
+		list.indirect_data->resize(queue.size());
+	}
+	list.indirect_batches.clear();
+	size_t indirect_draw_count = 0;
+	bool has_instances = false;
+	for (size_t d = 0; d < queue.size(); d++) {
+		const DrawList::PendingDraw & pending_draw = list.pending_draws[queue[d].index];
+		DrawUniformBlock & block = list.draw_data->at(d);
+		block.model = pending_draw.model;
+		block.setModelNormal(pending_draw.model_normal);
+		block.material_index = pending_draw.material_index;
+		if (pending_draw.instanced) {
+			InstanceData & instance = list.instance_data->at(d);
+			instance.model = pending_draw.model;
+			instance.setModelNormal(pending_draw.model_normal);
+			has_instances = true;
+		}
+		if (pending_draw.indirect) {
+			list.indirect_data->at(indirect_draw_count) = block;
+			addIndirectDraw(list, d, indirect_draw_count++);
+		}
+	}
+	list.draw_data->upload();
+	if (has_instances) list.instance_data->upload();
+	if (indirect_draw_count > 0) {
+		list.indirect_data->resize(indirect_draw_count);
+		list.indirect_data->upload();
+	}
+}
+
+void Scene::submitDraws(DrawList & list, ShaderConfiguration * configuration) {
+	ShaderManager & shader_manager = ShaderManager::getInstance();
+	const std::vector<RenderQueueItem> & queue = list.render_queue.getItems();
+	size_t next_indirect_batch = 0;
+	for (size_t d = 0; d < queue.size();) {
+		const DrawList::PendingDraw & pending_draw = list.pending_draws[queue[d].index];
+		SceneObject * obj = pending_draw.object;
+		pending_draw.framebuffer->use();
+
+		if (pending_draw.indirect) {
+			const DrawList::IndirectBatch & batch = list.indirect_batches[next_indirect_batch++];
+			useRenderItem(pending_draw, configuration);
+			pending_draw.item.bind();
+			list.indirect_data->bind();
+			list.indirect_data->draw(batch.mode, batch.first_command, batch.command_count);
+			d += batch.draw_count;
+			continue;
+		}
+
+		// consecutive draws of the same object share mesh, material and program, so they become instances of one draw
+		size_t instance_count = 1;
+		while (pending_draw.instanced && d + instance_count < queue.size()) {
+			const DrawList::PendingDraw & next_draw = list.pending_draws[queue[d + instance_count].index];
+			if (next_draw.object != obj || next_draw.framebuffer != pending_draw.framebuffer
+				|| next_draw.program != pending_draw.program || next_draw.condition_query != 0) break;
+			instance_count++;
+		}
+
+		Shader * shader = shader_manager.getShader(pending_draw.program);
+		if (shader->usesDrawBlock()) {
+			list.draw_data->bind(d);
+		} else {
+			// load object-specific values into the internal shader
+			const DrawUniformBlock & block = list.draw_data->at(d);
+			this->object_configuration.setMat4(ID_MODEL, block.model);
+			this->object_configuration.setMat3(ID_MODEL_NORMAL, glm::mat3(
+				glm::vec3(block.model_normal[0]), glm::vec3(block.model_normal[1]), glm::vec3(block.model_normal[2])));
+		}
+
+		if (pending_draw.condition_query != 0) glBeginConditionalRender(pending_draw.condition_query, GL_QUERY_NO_WAIT);
+		if (pending_draw.has_item) {
+			useRenderItem(pending_draw, configuration);
+			if (pending_draw.instanced) {
+				pending_draw.item.drawInstanced(list.instance_data.get(), d, static_cast<GLsizei>(instance_count));
+			} else {
+				pending_draw.item.draw();
+			}
+		} else if (pending_draw.instanced) {
+			obj->drawInstanced(configuration, &this->object_configuration, list.instance_data.get(), d,
+				static_cast<GLsizei>(instance_count));
+		} else {
+			obj->draw(configuration, &this->object_configuration);
+		}
+		if (pending_draw.condition_query != 0) glEndConditionalRender();
+		d += instance_count;
+	}
+}
+
+void Scene::useRenderItem(const DrawList::PendingDraw & pending_draw, ShaderConfiguration * configuration) {
+	ShaderManager & shader_manager = ShaderManager::getInstance();
+	this->object_configuration.setMaterial(ID_MATERIAL, this->node_slots[pending_draw.slot].material);
+	shader_manager.useShader(pending_draw.program);
+	shader_manager.configureShader(configuration, pending_draw.program);
+	shader_manager.configureShader(&this->object_configuration, pending_draw.program);
+}
+
+void Scene::addIndirectDraw(DrawList & list, size_t queue_index, size_t draw_index) {
+	const std::vector<RenderQueueItem> & queue = list.render_queue.getItems();
+	const DrawList::PendingDraw & pending_draw = list.pending_draws[queue[queue_index].index];
+	const RenderItem & item = pending_draw.item;
+
+	// the draw joins the batch of the previous draw if both can be issued by the same call
+	if (queue_index > 0) {
+		const DrawList::PendingDraw & previous_draw = list.pending_draws[queue[queue_index - 1].index];
+		const RenderItem & previous_item = previous_draw.item;
+		if (previous_draw.indirect && previous_draw.framebuffer == pending_draw.framebuffer
+			&& previous_draw.program == pending_draw.program && previous_item.material == item.material
+			&& previous_item.vertex_buffer == item.vertex_buffer && previous_item.mode == item.mode) {
+			DrawList::IndirectBatch & batch = list.indirect_batches.back();
+			batch.draw_count++;
+
+			// draws of the same object become instances of one command, which read consecutive values
+			if (previous_draw.object == pending_draw.object) {
+				list.indirect_data->getCommand(batch.first_command + batch.command_count - 1).instance_count++;
+				return;
+			}
+			DrawElementsIndirectCommand command = item.getIndirectCommand();
+			command.base_instance = list.indirect_data->getBaseInstance(draw_index);
+			list.indirect_data->addCommand(command);
+			batch.command_count++;
+			return;
+		}
+	}
+
+	DrawElementsIndirectCommand command = item.getIndirectCommand();
+	command.base_instance = list.indirect_data->getBaseInstance(draw_index);
+	list.indirect_batches.push_back({ 1, list.indirect_data->addCommand(command), 1, item.mode });
 }
 
 void Scene::processInput(GLFWwindow * window) {
@@ -1,4 +1,5 @@
 #include <GLRF/Shader.hpp>
+#include <GLRF/ShaderBatch.hpp>
 
 #include <glm/gtx/string_cast.hpp>
 #define PRINT(text) std::cout << text << std::endl;
@@ -6,8 +7,6 @@
 
 using namespace GLRF;
 
-unsigned int createShader(GLenum shaderType, const GLchar * shaderSource);
-
 ShaderConfiguration::ShaderConfiguration()
 {
 	
@@ -15,228 +14,352 @@ ShaderConfiguration::ShaderConfiguration()
 
 ShaderConfiguration::~ShaderConfiguration()
 {
-	this->v_bool.clear();
-	this->v_float.clear();
-	this->v_int.clear();
-	this->v_uint.clear();
-	this->v_mat4.clear();
-	this->v_mat3.clear();
-	this->v_vec4.clear();
-	this->v_vec3.clear();
-	this->v_vec2.clear();
-	this->v_material.clear();
+	this->entries.clear();
+	this->entry_indices.clear();
+	this->arena.clear();
+	this->materials.clear();
 }
 
-void ShaderConfiguration::loadIntoShader(Shader * shader) const
+uint64_t ShaderConfiguration::nextVersion()
 {
-	for (auto pair : this->v_bool)
-	{
-		shader->setBool(pair.first, pair.second);
-	}
-	for (auto pair : this->v_int)
-	{
-		shader->setInt(pair.first, pair.second);
-	}
-	for (auto pair : this->v_uint)
-	{
-		shader->setUInt(pair.first, pair.second);
-	}
-	for (auto pair : this->v_float)
-	{
-		shader->setFloat(pair.first, pair.second);
-	}
-	for (auto pair : this->v_mat4)
-	{
-		shader->setMat4(pair.first, pair.second);
-	}
-	for (auto pair : this->v_mat3)
+	static uint64_t version = 0;
+	return ++version;
+}
+
+const ShaderConfiguration::Entry * ShaderConfiguration::findEntry(UniformId id, ValueType type) const
+{
+	if (id >= this->entry_indices.size() || this->entry_indices[id] == NO_ENTRY) return nullptr;
+	const Entry & entry = this->entries[this->entry_indices[id]];
+	return (entry.type == type) ? &entry : nullptr;
+}
+
+ShaderConfiguration::Entry & ShaderConfiguration::findOrCreateEntry(UniformId id, ValueType type, size_t size)
+{
+	if (id >= this->entry_indices.size())
 	{
-		shader->setMat3(pair.first, pair.second);
+		this->entry_indices.resize(static_cast<size_t>(id) + 1, NO_ENTRY);
 	}
-	for (auto pair : this->v_vec4)
+	int32_t index = this->entry_indices[id];
+	if (index != NO_ENTRY)
 	{
-		shader->setVec4(pair.first, pair.second);
+		Entry & entry = this->entries[index];
+		if (entry.type != type)
+		{
+			throw std::invalid_argument("uniform '" + UniformRegistry::getInstance().getName(id) + "' was set with a different type before");
+		}
+		return entry;
 	}
-	for (auto pair : this->v_vec3)
+
+	Entry entry;
+	entry.id = id;
+	entry.type = type;
+	entry.version = nextVersion();
+	if (type == ValueType::MATERIAL)
 	{
-		shader->setVec3(pair.first, pair.second);
+		entry.offset = static_cast<uint32_t>(this->materials.size());
+		this->materials.push_back(nullptr);
 	}
-	for (auto pair : this->v_vec2)
+	else
 	{
-		shader->setVec2(pair.first, pair.second);
+		entry.offset = static_cast<uint32_t>(this->arena.size());
+		this->arena.resize(this->arena.size() + size);
 	}
-	for (auto pair : this->v_material)
+	this->entry_indices[id] = static_cast<int32_t>(this->entries.size());
+	this->entries.push_back(entry);
+	return this->entries.back();
+}
+
+void ShaderConfiguration::loadIntoShader(Shader * shader, bool force) const
+{
+	for (const Entry & entry : this->entries)
 	{
-		shader->setMaterial(pair.first, pair.second);
+		// materials can be modified in place, so the shader checks their revision itself
+		if (!force && entry.type != ValueType::MATERIAL && shader->getUploadedVersion(entry.id) == entry.version) continue;
+
+		switch (entry.type)
+		{
+		case ValueType::BOOL:
+			shader->setBool(shader->uniform(entry.id), readValue<bool>(entry));
+			break;
+		case ValueType::INT:
+			shader->setInt(shader->uniform(entry.id), readValue<GLint>(entry));
+			break;
+		case ValueType::UINT:
+			shader->setUInt(shader->uniform(entry.id), readValue<GLuint>(entry));
+			break;
+		case ValueType::FLOAT:
+			shader->setFloat(shader->uniform(entry.id), readValue<float>(entry));
+			break;
+		case ValueType::MAT4:
+			shader->setMat4(shader->uniform(entry.id), readValue<glm::mat4>(entry));
+			break;
+		case ValueType::MAT3:
+			shader->setMat3(shader->uniform(entry.id), readValue<glm::mat3>(entry));
+			break;
+		case ValueType::VEC4:
+			shader->setVec4(shader->uniform(entry.id), readValue<glm::vec4>(entry));
+			break;
+		case ValueType::VEC3:
+			shader->setVec3(shader->uniform(entry.id), readValue<glm::vec3>(entry));
+			break;
+		case ValueType::VEC2:
+			shader->setVec2(shader->uniform(entry.id), readValue<glm::vec2>(entry));
+			break;
+		case ValueType::MATERIAL:
+		{
+			const std::shared_ptr<Material> & material = this->materials[entry.offset];
+			if (material) shader->setMaterial(shader->materialUniform(entry.id), material);
+			break;
+		}
+		}
+		shader->setUploadedVersion(entry.id, entry.version);
 	}
 }
 
+void ShaderConfiguration::setBool(UniformId id, bool value)
+{
+	setValue(id, ValueType::BOOL, value);
+}
+
+void ShaderConfiguration::setInt(UniformId id, GLint value)
+{
+	setValue(id, ValueType::INT, value);
+}
+
+void ShaderConfiguration::setUInt(UniformId id, GLuint value)
+{
+	setValue(id, ValueType::UINT, value);
+}
+
+void ShaderConfiguration::setFloat(UniformId id, float value)
+{
+	setValue(id, ValueType::FLOAT, value);
+}
+
+void ShaderConfiguration::setMat4(UniformId id, const glm::mat4& value)
+{
+	setValue(id, ValueType::MAT4, value);
+}
+
+void ShaderConfiguration::setMat3(UniformId id, const glm::mat3& value)
+{
+	setValue(id, ValueType::MAT3, value);
+}
+
+void ShaderConfiguration::setVec4(UniformId id, const glm::vec4& value)
+{
+	setValue(id, ValueType::VEC4, value);
+}
+
+void ShaderConfiguration::setVec3(UniformId id, const glm::vec3& value)
+{
+	setValue(id, ValueType::VEC3, value);
+}
+
+void ShaderConfiguration::setVec2(UniformId id, const glm::vec2& value)
+{
+	setValue(id, ValueType::VEC2, value);
+}
+
+void ShaderConfiguration::setMaterial(UniformId id, const std::shared_ptr<Material> & material)
+{
+	size_t entry_count = this->entries.size();
+	Entry & entry = findOrCreateEntry(id, ValueType::MATERIAL, 0);
+	std::shared_ptr<Material> & stored = this->materials[entry.offset];
+	if (entry_count == this->entries.size() && stored == material) return;
+	stored = material;
+	entry.version = nextVersion();
+}
+
 void ShaderConfiguration::setBool(const std::string& name, bool value)
 {
-	this->v_bool.insert_or_assign(name, value);
+	setBool(UniformRegistry::getInstance().intern(name), value);
 }
 
 void ShaderConfiguration::setInt(const std::string& name, GLint value)
 {
-	this->v_int.insert_or_assign(name, value);
+	setInt(UniformRegistry::getInstance().intern(name), value);
 }
 
 void ShaderConfiguration::setUInt(const std::string & name, GLuint value)
 {
-	this->v_uint.insert_or_assign(name, value);
+	setUInt(UniformRegistry::getInstance().intern(name), value);
 }
 
 void ShaderConfiguration::setFloat(const std::string & name, float value)
 {
-	this->v_float.insert_or_assign(name, value);
+	setFloat(UniformRegistry::getInstance().intern(name), value);
 }
 
 void ShaderConfiguration::setMat4(const std::string & name, glm::mat4 value)
 {
-	this->v_mat4.insert_or_assign(name, value);
+	setMat4(UniformRegistry::getInstance().intern(name), value);
 }
 
 void ShaderConfiguration::setMat3(const std::string & name, glm::mat3 value)
 {
-	this->v_mat3.insert_or_assign(name, value);
+	setMat3(UniformRegistry::getInstance().intern(name), value);
 }
 
 void ShaderConfiguration::setVec4(const std::string & name, glm::vec4 value)
 {
-	this->v_vec4.insert_or_assign(name, value);
+	setVec4(UniformRegistry::getInstance().intern(name), value);
 }
 
 void ShaderConfiguration::setVec3(const std::string & name, glm::vec3 value)
 {
-	this->v_vec3.insert_or_assign(name, value);
+	setVec3(UniformRegistry::getInstance().intern(name), value);
 }
 
 void ShaderConfiguration::setVec2(const std::string & name, glm::vec2 value)
 {
-	this->v_vec2.insert_or_assign(name, value);
+	setVec2(UniformRegistry::getInstance().intern(name), value);
 }
 
 void ShaderConfiguration::setMaterial(const std::string & name, std::shared_ptr<Material> material)
 {
-	this->v_material.insert_or_assign(name, material);
+	setMaterial(UniformRegistry::getInstance().intern(name), material);
+}
+
+bool ShaderConfiguration::getBool(UniformId id)
+{
+	return getValue(id, ValueType::BOOL, false);
+}
+
+GLint ShaderConfiguration::getInt(UniformId id)
+{
+	return getValue<GLint>(id, ValueType::INT, 0);
+}
+
+GLuint ShaderConfiguration::getUInt(UniformId id)
+{
+	return getValue<GLuint>(id, ValueType::UINT, 0);
+}
+
+float ShaderConfiguration::getFloat(UniformId id)
+{
+	return getValue(id, ValueType::FLOAT, 0.f);
+}
+
+glm::mat4 ShaderConfiguration::getMat4(UniformId id)
+{
+	return getValue(id, ValueType::MAT4, glm::mat4(1.f));
+}
+
+glm::mat3 ShaderConfiguration::getMat3(UniformId id)
+{
+	return getValue(id, ValueType::MAT3, glm::mat3(1.f));
+}
+
+glm::vec4 ShaderConfiguration::getVec4(UniformId id)
+{
+	return getValue(id, ValueType::VEC4, glm::vec4(0.f));
+}
+
+glm::vec3 ShaderConfiguration::getVec3(UniformId id)
+{
+	return getValue(id, ValueType::VEC3, glm::vec3(0.f));
+}
+
+glm::vec2 ShaderConfiguration::getVec2(UniformId id)
+{
+	return getValue(id, ValueType::VEC2, glm::vec2(0.f));
+}
+
+std::shared_ptr<Material> ShaderConfiguration::getMaterial(UniformId id)
+{
+	const Entry * entry = findEntry(id, ValueType::MATERIAL);
+	return (entry == nullptr) ? nullptr : this->materials[entry->offset];
 }
 
 bool ShaderConfiguration::getBool(const std::string& name)
 {
-	auto it = this->v_bool.find(name);
-	return (it == this->v_bool.end()) ? false : it->second;
+	return getValue(name, ValueType::BOOL, false);
 }
 
 GLint ShaderConfiguration::getInt(const std::string& name)
 {
-	auto it = this->v_int.find(name);
-	return (it == this->v_int.end()) ? 0 : it->second;
+	return getValue<GLint>(name, ValueType::INT, 0);
 }
 
 GLuint ShaderConfiguration::getUInt(const std::string& name)
 {
-	auto it = this->v_uint.find(name);
-	return (it == this->v_uint.end()) ? 0 : it->second;
+	return getValue<GLuint>(name, ValueType::UINT, 0);
 }
 
 float ShaderConfiguration::getFloat(const std::string& name)
 {
-	auto it = this->v_float.find(name);
-	return (it == this->v_float.end()) ? 0.f : it->second;
+	return getValue(name, ValueType::FLOAT, 0.f);
 }
 
-
 glm::mat4 ShaderConfiguration::getMat4(const std::string& name)
 {
-	auto it = this->v_mat4.find(name);
-	return (it == this->v_mat4.end()) ? glm::mat4(1.f) : it->second;
+	return getValue(name, ValueType::MAT4, glm::mat4(1.f));
 }
 
 glm::mat3 ShaderConfiguration::getMat3(const std::string& name)
 {
-	auto it = this->v_mat3.find(name);
-	return (it == this->v_mat3.end()) ? glm::mat3(1.f) : it->second;
+	return getValue(name, ValueType::MAT3, glm::mat3(1.f));
 }
 
 glm::vec4 ShaderConfiguration::getVec4(const std::string& name)
 {
-	auto it = this->v_vec4.find(name);
-	return (it == this->v_vec4.end()) ? glm::vec4(0.f) : it->second;
+	return getValue(name, ValueType::VEC4, glm::vec4(0.f));
 }
 
 glm::vec3 ShaderConfiguration::getVec3(const std::string& name)
 {
-	auto it = this->v_vec3.find(name);
-	return (it == this->v_vec3.end()) ? glm::vec3(0.f) : it->second;
+	return getValue(name, ValueType::VEC3, glm::vec3(0.f));
 }
 
 glm::vec2 ShaderConfiguration::getVec2(const std::string& name)
 {
-	auto it = this->v_vec2.find(name);
-	return (it == this->v_vec2.end()) ? glm::vec2(0.f) : it->second;
+	return getValue(name, ValueType::VEC2, glm::vec2(0.f));
 }
 
 std::shared_ptr<Material> ShaderConfiguration::getMaterial(const std::string& name)
 {
-	auto it = this->v_material.find(name);
-	return (it == this->v_material.end()) ? nullptr : it->second;
+	UniformId id;
+	if (!UniformRegistry::getInstance().find(name, &id)) return nullptr;
+	return getMaterial(id);
+}
+
+uint64_t ShaderConfiguration::getVersion(UniformId id) const
+{
+	if (id >= this->entry_indices.size() || this->entry_indices[id] == NO_ENTRY) return 0;
+	return this->entries[this->entry_indices[id]].version;
 }
 
 Shader::Shader(const std::string shader_lib, const std::string vertex_path, std::optional<const std::string> geometry_path,
 		const std::string fragment_path)
 {
-	const bool has_geometry_shader = geometry_path.has_value();
+	ShaderBuildRequest request;
+	request.shader_lib = shader_lib;
+	request.vertex_path = vertex_path;
+	if (geometry_path.has_value()) request.geometry_path = geometry_path.value();
+	request.fragment_path = fragment_path;
 
-	// 1. retrieve the GLSL source code from paths
-	std::string vertex_lib_path = shader_lib + vertex_path;
-	std::string vertex_code_str;
-	loadShaderFile(vertex_lib_path, &vertex_code_str);
-	const char* vertex_code = vertex_code_str.c_str();
+	ShaderBatch batch({ request }, this);
+	batch.wait();
 
-	std::string geometry_lib_path;
-	std::string geometry_code_str;
-	const char* geometry_code;
-	if (has_geometry_shader)
+	const ShaderBuildResult & result = batch.getResults()[0];
+	if (result.status == ShaderBuildStatus::FAILED)
 	{
-		geometry_lib_path = shader_lib + geometry_path.value();
-		loadShaderFile(geometry_lib_path, &geometry_code_str);
-		geometry_code = geometry_code_str.c_str();
+		std::cout << "ERROR::SHADER::" << result.failed_stage << "::BUILD_FAILED\n" << result.log << std::endl;
+		throw std::runtime_error("cannot build shader: " + result.failed_stage + " failed");
 	}
+}
 
-	std::string fragment_lib_path = shader_lib + fragment_path;
-	std::string fragment_code_str;
-	loadShaderFile(fragment_lib_path, &fragment_code_str);
-	const char* fragment_code = fragment_code_str.c_str();
-
-	// 2. compile shaders
-	GLuint vertex_id, geometry_id, fragment_id;
-	int success;
-	char infoLog[512];
-
-	vertex_id = createShader(GL_VERTEX_SHADER, vertex_code, "VERTEX");
-	if (has_geometry_shader) geometry_id = createShader(GL_GEOMETRY_SHADER, geometry_code, "GEOMETRY");
-	fragment_id = createShader(GL_FRAGMENT_SHADER, fragment_code, "FRAGMENT");
-
-	// shader Program
-	ID = glCreateProgram();
-	glAttachShader(ID, vertex_id);
-	if (has_geometry_shader) glAttachShader(ID, geometry_id);
-	glAttachShader(ID, fragment_id);
-	glLinkProgram(ID);
-
-	// print linking errors if any
-	glGetProgramiv(ID, GL_LINK_STATUS, &success);
-	if (!success)
-	{
-		glGetProgramInfoLog(ID, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
-		exit(1);
-	}
+Shader::Shader()
+{
 
-	// delete the shaders as they're linked into our program now and no longer necessery
-	glDeleteShader(vertex_id);
-	if (has_geometry_shader) glDeleteShader(geometry_id);
-	glDeleteShader(fragment_id);
+}
+
+void Shader::adoptProgram(GLuint program)
+{
+	this->ID = program;
+	this->direct_state_access = GLCapabilities::getInstance().direct_state_access;
+	reflectUniforms();
 
 	// ======= REGISTER SHADER ======= //
 	ShaderManager::getInstance().registerShader(this);
@@ -269,92 +392,299 @@ unsigned int Shader::getID() {
 	return this->ID;
 }
 
+void Shader::reflectUniforms()
+{
+	GLint uniform_count = 0, max_name_length = 0;
+	glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &uniform_count);
+	glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_name_length);
+
+	this->uniform_locations.clear();
+	this->uniform_locations.reserve(static_cast<size_t>(uniform_count));
+	this->material_uniforms.clear();
+	this->location_cache.clear();
+	this->uploaded_versions.clear();
+
+	std::vector<GLchar> name_buffer(static_cast<size_t>(max_name_length) + 1);
+	for (GLint i = 0; i < uniform_count; i++)
+	{
+		GLsizei name_length = 0;
+		GLint array_size = 0;
+		GLenum type;
+		glGetActiveUniform(ID, static_cast<GLuint>(i), static_cast<GLsizei>(name_buffer.size()), &name_length, &array_size, &type, name_buffer.data());
+		std::string name(name_buffer.data(), static_cast<size_t>(name_length));
+
+		// members of uniform blocks have no location
+		GLint location = glGetUniformLocation(ID, name.c_str());
+		if (location < 0) continue;
+
+		const std::string array_suffix = "[0]";
+		bool is_array = name.size() > array_suffix.size()
+			&& name.compare(name.size() - array_suffix.size(), array_suffix.size(), array_suffix) == 0;
+		if (!is_array)
+		{
+			this->uniform_locations.insert_or_assign(name, location);
+			continue;
+		}
+
+		std::string base_name = name.substr(0, name.size() - array_suffix.size());
+		this->uniform_locations.insert_or_assign(base_name, location);
+		this->uniform_locations.insert_or_assign(name, location);
+		for (GLint element = 1; element < array_size; element++)
+		{
+			std::string element_name = base_name + "[" + std::to_string(element) + "]";
+			GLint element_location = glGetUniformLocation(ID, element_name.c_str());
+			if (element_location >= 0) this->uniform_locations.insert_or_assign(element_name, element_location);
+		}
+	}
+}
+
+UniformHandle Shader::uniform(const std::string& name) const
+{
+	UniformHandle handle;
+	auto it = this->uniform_locations.find(name);
+	if (it != this->uniform_locations.end()) handle.location = it->second;
+	return handle;
+}
+
+UniformHandle Shader::uniform(UniformId id) const
+{
+	if (id >= this->location_cache.size())
+	{
+		this->location_cache.resize(UniformRegistry::getInstance().size(), UNRESOLVED_LOCATION);
+	}
+	GLint & location = this->location_cache[id];
+	if (location == UNRESOLVED_LOCATION)
+	{
+		location = uniform(UniformRegistry::getInstance().getName(id)).location;
+	}
+	UniformHandle handle;
+	handle.location = location;
+	return handle;
+}
+
+uint64_t Shader::getUploadedVersion(UniformId id) const
+{
+	return (id < this->uploaded_versions.size()) ? this->uploaded_versions[id] : 0;
+}
+
+void Shader::setUploadedVersion(UniformId id, uint64_t version)
+{
+	if (id >= this->uploaded_versions.size())
+	{
+		this->uploaded_versions.resize(UniformRegistry::getInstance().size(), 0);
+	}
+	this->uploaded_versions[id] = version;
+}
+
+void Shader::clearUploadedVersions()
+{
+	std::fill(this->uploaded_versions.begin(), this->uploaded_versions.end(), 0);
+	for (auto & material_uniform : this->material_uniforms)
+	{
+		material_uniform.second.samplers_assigned = false;
+		material_uniform.second.uploaded_revision = 0;
+	}
+}
+
+MaterialPropertyUniformHandles Shader::materialPropertyUniform(const std::string& name) const
+{
+	MaterialPropertyUniformHandles handles;
+	handles.value_default = uniform(name + period + value_default);
+	handles.use_texture = uniform(name + period + use_texture);
+	handles.texture = uniform(name + period + texture);
+	return handles;
+}
+
+const MaterialUniformHandles& Shader::materialUniform(const std::string& name)
+{
+	return materialUniform(UniformRegistry::getInstance().intern(name));
+}
+
+const MaterialUniformHandles& Shader::materialUniform(UniformId id)
+{
+	auto it = this->material_uniforms.find(id);
+	if (it != this->material_uniforms.end()) return it->second;
+
+	const std::string & name = UniformRegistry::getInstance().getName(id);
+
+	MaterialUniformHandles handles;
+	handles.albedo		= materialPropertyUniform(name + period + "albedo");
+	handles.normal		= materialPropertyUniform(name + period + "normal");
+	handles.roughness	= materialPropertyUniform(name + period + "roughness");
+	handles.metallic	= materialPropertyUniform(name + period + "metallic");
+	handles.ao			= materialPropertyUniform(name + period + "ao");
+	handles.height		= materialPropertyUniform(name + period + "height");
+	handles.opacity		= materialPropertyUniform(name + period + "opacity");
+	handles.height_scale = uniform(name + period + "height_scale");
+	return this->material_uniforms.insert_or_assign(id, handles).first->second;
+}
+
+bool Shader::bindUniformBlock(const std::string& name, GLuint binding)
+{
+	GLuint block_index = glGetUniformBlockIndex(ID, name.c_str());
+	if (block_index == GL_INVALID_INDEX) return false;
+	glUniformBlockBinding(ID, block_index, binding);
+	return true;
+}
+
+bool Shader::bindStorageBlock(const std::string& name, GLuint binding)
+{
+	if (!GLCapabilities::getInstance().multi_draw_indirect) return false;
+	GLuint block_index = glGetProgramResourceIndex(ID, GL_SHADER_STORAGE_BLOCK, name.c_str());
+	if (block_index == GL_INVALID_INDEX) return false;
+	glShaderStorageBlockBinding(ID, block_index, binding);
+	return true;
+}
+
+bool Shader::isMaterialVariant()
+{
+	return this->material_variant;
+}
+
+bool Shader::usesInstancing()
+{
+	return this->uses_instancing;
+}
+
+bool Shader::usesDrawStorage()
+{
+	return this->uses_draw_storage;
+}
+
+bool Shader::usesDrawBlock()
+{
+	return this->uses_draw_block;
+}
+
 void Shader::setBool(const std::string & name, bool value) const {
-	glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+	setBool(uniform(name), value);
 }
 
 void Shader::setInt(const std::string & name, GLint value) const {
-	glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+	setInt(uniform(name), value);
 }
 
 void Shader::setUInt(const std::string & name, GLuint value) const {
-	glUniform1ui(glGetUniformLocation(ID, name.c_str()), value);
+	setUInt(uniform(name), value);
 }
 
 void Shader::setFloat(const std::string & name, float value) const {
-	glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+	setFloat(uniform(name), value);
 }
 
 void Shader::setMat4(const std::string & name, glm::mat4 value) const {
-	glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(value));
+	setMat4(uniform(name), value);
 }
 
 void Shader::setMat3(const std::string & name, glm::mat3 value) const {
-	glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(value));
+	setMat3(uniform(name), value);
 }
 
 void Shader::setVec4(const std::string & name, glm::vec4 value) const {
-	glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value));
+	setVec4(uniform(name), value);
 }
 
 void Shader::setVec3(const std::string & name, glm::vec3 value) const {
-	glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value));
+	setVec3(uniform(name), value);
 }
 
 void Shader::setVec2(const std::string& name, glm::vec2 value) const {
-	glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value));
+	setVec2(uniform(name), value);
 }
 
-void Shader::setMaterialProperty(const std::string& name, MaterialProperty<glm::vec4> material_property, GLuint texture_unit) {
-	setVec4(name + period + value_default,	material_property.value_default);
-	setMaterialPropertyCommons(name, material_property, texture_unit);
+void Shader::setMaterial(const std::string & name, std::shared_ptr<Material> material) {
+	setMaterial(materialUniform(name), material);
 }
 
-void Shader::setMaterialProperty(const std::string& name, MaterialProperty<glm::vec3> material_property, GLuint texture_unit) {
-	setVec3(name + period + value_default,	material_property.value_default);
-	setMaterialPropertyCommons(name, material_property, texture_unit);
+void Shader::setBool(UniformHandle handle, bool value) const {
+	if (!handle.isValid()) return;
+	if (this->direct_state_access) glProgramUniform1i(ID, handle.location, (int)value);
+	else glUniform1i(handle.location, (int)value);
 }
 
-void Shader::setMaterialProperty(const std::string& name, MaterialProperty<glm::vec2> material_property, GLuint texture_unit) {
-	setVec2(name + period + value_default,	material_property.value_default);
-	setMaterialPropertyCommons(name, material_property, texture_unit);
+void Shader::setInt(UniformHandle handle, GLint value) const {
+	if (!handle.isValid()) return;
+	if (this->direct_state_access) glProgramUniform1i(ID, handle.location, value);
+	else glUniform1i(handle.location, value);
 }
 
-void Shader::setMaterialProperty(const std::string& name, MaterialProperty<float> material_property, GLuint texture_unit) {
-	setFloat(name + period + value_default, material_property.value_default);
-	setMaterialPropertyCommons(name, material_property, texture_unit);
+void Shader::setUInt(UniformHandle handle, GLuint value) const {
+	if (!handle.isValid()) return;
+	if (this->direct_state_access) glProgramUniform1ui(ID, handle.location, value);
+	else glUniform1ui(handle.location, value);
 }
 
-void Shader::setMaterial(const std::string & name, std::shared_ptr<Material> material) {
+void Shader::setFloat(UniformHandle handle, float value) const {
+	if (!handle.isValid()) return;
+	if (this->direct_state_access) glProgramUniform1f(ID, handle.location, value);
+	else glUniform1f(handle.location, value);
+}
+
+void Shader::setMat4(UniformHandle handle, const glm::mat4& value) const {
+	if (!handle.isValid()) return;
+	if (this->direct_state_access) glProgramUniformMatrix4fv(ID, handle.location, 1, GL_FALSE, glm::value_ptr(value));
+	else glUniformMatrix4fv(handle.location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void Shader::setMat3(UniformHandle handle, const glm::mat3& value) const {
+	if (!handle.isValid()) return;
+	if (this->direct_state_access) glProgramUniformMatrix3fv(ID, handle.location, 1, GL_FALSE, glm::value_ptr(value));
+	else glUniformMatrix3fv(handle.location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void Shader::setVec4(UniformHandle handle, const glm::vec4& value) const {
+	if (!handle.isValid()) return;
+	if (this->direct_state_access) glProgramUniform4fv(ID, handle.location, 1, glm::value_ptr(value));
+	else glUniform4fv(handle.location, 1, glm::value_ptr(value));
+}
+
+void Shader::setVec3(UniformHandle handle, const glm::vec3& value) const {
+	if (!handle.isValid()) return;
+	if (this->direct_state_access) glProgramUniform3fv(ID, handle.location, 1, glm::value_ptr(value));
+	else glUniform3fv(handle.location, 1, glm::value_ptr(value));
+}
+
+void Shader::setVec2(UniformHandle handle, const glm::vec2& value) const {
+	if (!handle.isValid()) return;
+	if (this->direct_state_access) glProgramUniform2fv(ID, handle.location, 1, glm::value_ptr(value));
+	else glUniform2fv(handle.location, 1, glm::value_ptr(value));
+}
+
+void Shader::setMaterial(const MaterialUniformHandles& handles, std::shared_ptr<Material> material) {
+	ShaderManager & shader_manager = ShaderManager::getInstance();
+	material->sync(shader_manager.getFrame());
 	material->bindTextures(0);
-	setMaterialProperty(name + period + "albedo",		material->albedo,		0);
-	setMaterialProperty(name + period + "normal",		material->normal,		1);
-	setMaterialProperty(name + period + "roughness",	material->roughness,	2);
-	setMaterialProperty(name + period + "metallic",		material->metallic,		3);
-	setMaterialProperty(name + period + "ao",			material->ao,			4);
-	setMaterialProperty(name + period + "height",		material->height,		5);
-	setMaterialProperty(name + period + "opacity",		material->opacity,		6);
-
-	setFloat(name + period + "height_scale", material->height_scale);
-}
-
-unsigned int Shader::createShader(GLenum shader_type, const GLchar * shader_source, std::string shader_name) {
-	unsigned int shader;
-	shader = glCreateShader(shader_type);
-	glShaderSource(shader, 1, &shader_source, NULL);
-	glCompileShader(shader);
-
-	int  success;
-	char infoLog[512];
-	glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-	if (!success)
-	{
-		glGetShaderInfoLog(shader, 512, NULL, infoLog);
-		std::cout << "ERROR::SHADER::" << shader_name << "::COMPILATION_FAILED\n" << infoLog << std::endl;
-		exit(1);
+
+	if (!handles.samplers_assigned) {
+		setInt(handles.albedo.texture,		0);
+		setInt(handles.normal.texture,		1);
+		setInt(handles.roughness.texture,	2);
+		setInt(handles.metallic.texture,	3);
+		setInt(handles.ao.texture,			4);
+		setInt(handles.height.texture,		5);
+		setInt(handles.opacity.texture,		6);
+		handles.samplers_assigned = true;
 	}
 
-	return shader;
+	if (this->uses_material_block) {
+		material->getUniformBuffer()->bindBase(MATERIAL_BLOCK_BINDING);
+		return;
+	}
+
+	// the uniforms of this program still hold the values of an unchanged material
+	if (handles.uploaded_material == material->getID() && handles.uploaded_revision == material->getRevision()) return;
+	handles.uploaded_material = material->getID();
+	handles.uploaded_revision = material->getRevision();
+
+	setMaterialProperty(handles.albedo,		material->albedo);
+	setMaterialProperty(handles.normal,		material->normal);
+	setMaterialProperty(handles.roughness,	material->roughness);
+	setMaterialProperty(handles.metallic,	material->metallic);
+	setMaterialProperty(handles.ao,			material->ao);
+	setMaterialProperty(handles.height,		material->height);
+	setMaterialProperty(handles.opacity,	material->opacity);
+
+	setFloat(handles.height_scale, material->height_scale);
 }
 
 ShaderManager::ShaderManager()
@@ -367,41 +697,159 @@ ShaderManager::~ShaderManager()
 
 }
 
-void ShaderManager::registerShader(Shader * shader)
+void ShaderManager::setBinaryCache(fs::path directory)
 {
-	this->registered_shaders.insert_or_assign(shader->getID(), shader);
+	this->binary_cache.reset(new ShaderBinaryCache(directory));
 }
 
-void ShaderManager::useShader(GLuint ID)
+ShaderBinaryCache * ShaderManager::getBinaryCache()
+{
+	return this->binary_cache.get();
+}
+
+std::shared_ptr<ShaderBatch> ShaderManager::submitBatch(const std::vector<ShaderBuildRequest>& requests)
+{
+	return std::shared_ptr<ShaderBatch>(new ShaderBatch(requests));
+}
+
+void ShaderManager::beginFrame()
 {
-	if (this->activeShaderID != ID)
+	this->frame++;
+	pollMaterialVariants();
+}
+
+uint64_t ShaderManager::getFrame()
+{
+	return this->frame;
+}
+
+uint64_t ShaderManager::getVariantGeneration()
+{
+	return this->variant_generation;
+}
+
+uint64_t ShaderManager::materialVariantKey(GLuint ID, uint32_t feature_mask)
+{
+	return (static_cast<uint64_t>(ID) << 32) | feature_mask;
+}
+
+void ShaderManager::enableMaterialVariants(GLuint ID)
+{
+	getShader(ID)->material_variants_enabled = true;
+}
+
+GLuint ShaderManager::getMaterialVariant(GLuint ID, Material * material)
+{
+	if (!material) return ID;
+	Shader * shader = getShader(ID);
+	if (!shader->material_variants_enabled) return ID;
+
+	uint32_t feature_mask = material->getFeatureMask();
+	uint64_t key = materialVariantKey(ID, feature_mask);
+	auto it = this->material_variants.find(key);
+	if (it != this->material_variants.end()) return it->second;
+
+	// build the variant in the background, the unspecialized shader draws until it is ready
+	ShaderBuildRequest request = shader->build_request;
+	request.defines.push_back("GLRF_MATERIAL_VARIANT");
+	for (const std::string & define : Material::getFeatureDefines(feature_mask)) request.defines.push_back(define);
+	request.debug_name += "#" + std::to_string(feature_mask);
+
+	this->pending_material_variants.push_back({ key, submitBatch({ request }) });
+	this->material_variants.insert_or_assign(key, ID);
+	return ID;
+}
+
+void ShaderManager::pollMaterialVariants()
+{
+	for (size_t i = 0; i < this->pending_material_variants.size();)
 	{
-		glUseProgram(ID);
-		this->activeShaderID = ID;
+		PendingMaterialVariant & pending = this->pending_material_variants[i];
+		if (!pending.batch->poll())
+		{
+			i++;
+			continue;
+		}
+
+		const ShaderBuildResult & result = pending.batch->getResults()[0];
+		if (result.status == ShaderBuildStatus::SUCCEEDED)
+		{
+			result.shader->material_variant = true;
+			this->material_variant_shaders.push_back(result.shader);
+			this->material_variants.insert_or_assign(pending.key, result.shader->getID());
+			this->variant_generation++;
+		}
+		else
+		{
+			std::cout << "ERROR::SHADER::" << result.failed_stage << "::VARIANT_BUILD_FAILED (" << result.debug_name << ")\n"
+				<< result.log << std::endl;
+		}
+
+		this->pending_material_variants.erase(this->pending_material_variants.begin() + static_cast<std::ptrdiff_t>(i));
+	}
+}
+
+void ShaderManager::registerShader(Shader * shader)
+{
+	GLuint ID = shader->getID();
+	this->registered_shaders.insert_or_assign(ID, shader);
+
+	shader->uses_draw_block = shader->bindUniformBlock(DrawUniformBlock::name, DRAW_BLOCK_BINDING);
+	shader->uses_material_block = shader->bindUniformBlock(MaterialUniformBlock::name, MATERIAL_BLOCK_BINDING);
+	shader->uses_draw_storage = shader->bindStorageBlock(DrawUniformBlock::storage_name, DRAW_STORAGE_BINDING);
+	GLint instance_location = glGetAttribLocation(ID, InstanceData::attribute_name);
+	shader->uses_instancing = instance_location == static_cast<GLint>(INSTANCE_ATTRIBUTE_LOCATION);
+	if (instance_location >= 0 && !shader->uses_instancing)
+	{
+		std::cout << "WARNING::SHADER::INSTANCE_ATTRIBUTE_LOCATION (" << shader->getDebugName() << ")\n"
+			<< "'" << InstanceData::attribute_name << "' must be bound to location " << INSTANCE_ATTRIBUTE_LOCATION << std::endl;
+	}
+	if (shader->bindUniformBlock(SceneUniformBlock::name, SCENE_BLOCK_BINDING))
+	{
+		this->legacy_scene_shaders.erase(ID);
 	}
+	else
+	{
+		this->legacy_scene_shaders.insert(ID);
+	}
+}
+
+bool ShaderManager::requiresLegacySceneUniforms()
+{
+	return !this->legacy_scene_shaders.empty();
+}
+
+void ShaderManager::useShader(GLuint ID)
+{
+	GLStateCache::getInstance().useProgram(ID);
 }
 
 void ShaderManager::configureShader(const ShaderConfiguration * configuration, GLuint ID, bool force)
 {
-	if (force || this->configured_shaders.find(ID) == this->configured_shaders.end())
+	auto it = this->registered_shaders.find(ID);
+	if (it == this->registered_shaders.end())
 	{
-		auto it = this->registered_shaders.find(ID);
-		if (it == this->registered_shaders.end())
-		{
-			throw std::invalid_argument("shader was used but never registered");
-		}
-		configuration->loadIntoShader(it->second);
+		throw std::invalid_argument("shader was used but never registered");
 	}
+	configuration->loadIntoShader(it->second, force);
 }
 
 void ShaderManager::clearDrawConfigurations()
 {
-	this->configured_shaders.clear();
+	for (auto & pair : this->registered_shaders)
+	{
+		pair.second->clearUploadedVersions();
+	}
 }
 
 Shader * ShaderManager::getShader(GLuint ID)
 {
-	return this->registered_shaders.find(ID)->second;
+	auto it = this->registered_shaders.find(ID);
+	if (it == this->registered_shaders.end())
+	{
+		throw std::invalid_argument("shader was used but never registered");
+	}
+	return it->second;
 }
 
 void Shader::setDebugName(const std::string name)
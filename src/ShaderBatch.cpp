@@ -0,0 +1,247 @@
+#include <GLRF/ShaderBatch.hpp>
+
+using namespace GLRF;
+
+const GLenum ShaderBatch::stage_types[3] = { GL_VERTEX_SHADER, GL_GEOMETRY_SHADER, GL_FRAGMENT_SHADER };
+const char * ShaderBatch::stage_names[3] = { "VERTEX", "GEOMETRY", "FRAGMENT" };
+
+namespace {
+	std::string getShaderLog(GLuint shader)
+	{
+		GLint length = 0;
+		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+		std::string log(static_cast<size_t>(std::max(length, 1)), '\0');
+		glGetShaderInfoLog(shader, static_cast<GLsizei>(log.size()), NULL, &log[0]);
+		log.resize(std::char_traits<char>::length(log.c_str()));
+		return log;
+	}
+
+	std::string getProgramLog(GLuint program)
+	{
+		GLint length = 0;
+		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+		std::string log(static_cast<size_t>(std::max(length, 1)), '\0');
+		glGetProgramInfoLog(program, static_cast<GLsizei>(log.size()), NULL, &log[0]);
+		log.resize(std::char_traits<char>::length(log.c_str()));
+		return log;
+	}
+}
+
+ShaderBatch::ShaderBatch(const std::vector<ShaderBuildRequest>& requests, Shader * target)
+{
+	this->builds.resize(requests.size());
+	this->results.resize(requests.size());
+	for (size_t i = 0; i < requests.size(); i++)
+	{
+		this->builds[i].target = target;
+		start(i, requests[i]);
+	}
+}
+
+ShaderBatch::~ShaderBatch()
+{
+	for (Build & build : this->builds)
+	{
+		if (build.stage != Stage::FINISHED) release(build);
+	}
+}
+
+void ShaderBatch::start(size_t index, const ShaderBuildRequest& request)
+{
+	Build & build = this->builds[index];
+	build.request = request;
+	this->results[index].debug_name = request.debug_name;
+
+	// retrieve the GLSL source code from paths, a missing geometry shader is kept as empty source
+	build.sources.resize(3);
+	Shader::loadShaderFile(request.shader_lib + request.vertex_path, &build.sources[0]);
+	if (request.geometry_path.has_value()) Shader::loadShaderFile(request.shader_lib + request.geometry_path.value(), &build.sources[1]);
+	Shader::loadShaderFile(request.shader_lib + request.fragment_path, &build.sources[2]);
+
+	// resolve includes and inject the defines of the requested permutation
+	ShaderPreprocessor preprocessor(request.shader_lib);
+	try
+	{
+		for (std::string & source : build.sources)
+		{
+			if (!source.empty()) source = preprocessor.process(source, request.defines);
+		}
+	}
+	catch (const std::runtime_error & e)
+	{
+		this->results[index].status = ShaderBuildStatus::FAILED;
+		this->results[index].failed_stage = "PREPROCESS";
+		this->results[index].log = e.what();
+		build.sources.clear();
+		build.stage = Stage::FINISHED;
+		this->finished_count++;
+		return;
+	}
+
+	build.program = glCreateProgram();
+
+	ShaderBinaryCache * binary_cache = ShaderManager::getInstance().getBinaryCache();
+	GLCapabilities & capabilities = GLCapabilities::getInstance();
+	if (binary_cache != nullptr && capabilities.program_binary)
+	{
+		build.binary_key = ShaderBinaryCache::createKey(build.sources, capabilities.vendor + "\n" + capabilities.renderer + "\n" + capabilities.version);
+		GLenum format;
+		std::vector<unsigned char> binary;
+		if (binary_cache->load(build.binary_key, &format, &binary))
+		{
+			glProgramBinary(build.program, format, binary.data(), static_cast<GLsizei>(binary.size()));
+			build.stage = Stage::LOADING_BINARY;
+			return;
+		}
+	}
+
+	issueCompile(build);
+}
+
+void ShaderBatch::issueCompile(Build & build)
+{
+	for (size_t i = 0; i < 3; i++)
+	{
+		if (build.sources[i].empty() && stage_types[i] == GL_GEOMETRY_SHADER) continue;
+
+		const GLchar * source = build.sources[i].c_str();
+		GLuint shader = glCreateShader(stage_types[i]);
+		glShaderSource(shader, 1, &source, NULL);
+		glCompileShader(shader);
+		glAttachShader(build.program, shader);
+		build.shader_ids.push_back(shader);
+	}
+
+	if (!build.binary_key.empty()) glProgramParameteri(build.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	glLinkProgram(build.program);
+	build.stage = Stage::COMPILING;
+}
+
+bool ShaderBatch::isComplete(const Build & build)
+{
+	GLint complete = GL_TRUE;
+	glGetProgramiv(build.program, GL_COMPLETION_STATUS_KHR, &complete);
+	return complete == GL_TRUE;
+}
+
+void ShaderBatch::finish(size_t index)
+{
+	Build & build = this->builds[index];
+	ShaderBuildResult & result = this->results[index];
+
+	GLint linked = GL_FALSE;
+	glGetProgramiv(build.program, GL_LINK_STATUS, &linked);
+
+	if (!linked && build.stage == Stage::LOADING_BINARY)
+	{
+		// the driver rejected the stored binary, so fall back to the sources
+		issueCompile(build);
+		return;
+	}
+
+	if (!linked)
+	{
+		result.status = ShaderBuildStatus::FAILED;
+		result.failed_stage = "PROGRAM";
+		for (size_t i = 0; i < build.shader_ids.size(); i++)
+		{
+			GLint compiled = GL_FALSE;
+			glGetShaderiv(build.shader_ids[i], GL_COMPILE_STATUS, &compiled);
+			if (!compiled)
+			{
+				GLint type = 0;
+				glGetShaderiv(build.shader_ids[i], GL_SHADER_TYPE, &type);
+				for (size_t s = 0; s < 3; s++) if (stage_types[s] == static_cast<GLenum>(type)) result.failed_stage = stage_names[s];
+				result.log = getShaderLog(build.shader_ids[i]);
+				break;
+			}
+		}
+		if (result.failed_stage == "PROGRAM") result.log = getProgramLog(build.program);
+		release(build);
+	}
+	else
+	{
+		for (GLuint shader : build.shader_ids)
+		{
+			glDetachShader(build.program, shader);
+			glDeleteShader(shader);
+		}
+		build.shader_ids.clear();
+
+		ShaderBinaryCache * binary_cache = ShaderManager::getInstance().getBinaryCache();
+		if (binary_cache != nullptr && !build.binary_key.empty() && build.stage == Stage::COMPILING)
+		{
+			binary_cache->storeProgram(build.binary_key, build.program);
+		}
+
+		Shader * shader = build.target;
+		if (shader == nullptr)
+		{
+			result.shader = std::shared_ptr<Shader>(new Shader());
+			shader = result.shader.get();
+		}
+		shader->setDebugName(result.debug_name);
+		shader->build_request = build.request;
+		shader->adoptProgram(build.program);
+		result.status = ShaderBuildStatus::SUCCEEDED;
+	}
+
+	build.stage = Stage::FINISHED;
+	build.sources.clear();
+	this->finished_count++;
+}
+
+void ShaderBatch::release(Build & build)
+{
+	for (GLuint shader : build.shader_ids)
+	{
+		glDeleteShader(shader);
+	}
+	build.shader_ids.clear();
+	if (build.program != 0) glDeleteProgram(build.program);
+	build.program = 0;
+}
+
+bool ShaderBatch::poll()
+{
+	const bool parallel = GLCapabilities::getInstance().parallel_shader_compile;
+	for (size_t i = 0; i < this->builds.size(); i++)
+	{
+		if (this->builds[i].stage == Stage::FINISHED) continue;
+		if (parallel)
+		{
+			if (isComplete(this->builds[i])) finish(i);
+		}
+		else
+		{
+			// without completion queries every status query blocks, so keep the stall per poll short
+			finish(i);
+			break;
+		}
+	}
+	return isFinished();
+}
+
+void ShaderBatch::wait()
+{
+	for (size_t i = 0; i < this->builds.size(); i++)
+	{
+		// a rejected binary restarts the build from source, so finish until the build is done
+		while (this->builds[i].stage != Stage::FINISHED) finish(i);
+	}
+}
+
+bool ShaderBatch::isFinished()
+{
+	return this->finished_count == this->builds.size();
+}
+
+size_t ShaderBatch::getFinishedCount()
+{
+	return this->finished_count;
+}
+
+const std::vector<ShaderBuildResult>& ShaderBatch::getResults()
+{
+	return this->results;
+}
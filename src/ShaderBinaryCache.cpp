@@ -0,0 +1,121 @@
+#include <GLRF/ShaderBinaryCache.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+#include <cstring>
+
+using namespace GLRF;
+
+const char ShaderBinaryCache::magic[8] = { 'G', 'L', 'R', 'F', 'B', 'I', 'N', '1' };
+
+namespace {
+	const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+	const uint64_t FNV_PRIME = 1099511628211ull;
+
+	uint64_t hashFNV1a(const std::string& data, uint64_t hash)
+	{
+		for (unsigned char c : data)
+		{
+			hash ^= c;
+			hash *= FNV_PRIME;
+		}
+		return hash;
+	}
+}
+
+ShaderBinaryCache::ShaderBinaryCache(fs::path directory)
+{
+	this->directory = directory;
+	std::error_code error;
+	fs::create_directories(directory, error);
+	if (error)
+	{
+		std::cout << "The shader cache directory '" << directory.generic_string() << "' cannot be created." << std::endl;
+	}
+}
+
+ShaderBinaryCache::~ShaderBinaryCache()
+{
+
+}
+
+std::string ShaderBinaryCache::createKey(const std::vector<std::string>& sources, const std::string& driver)
+{
+	// two differently seeded hashes, so that collisions are practically impossible
+	uint64_t hash_a = hashFNV1a(driver, FNV_OFFSET_BASIS);
+	uint64_t hash_b = hashFNV1a(driver, FNV_OFFSET_BASIS ^ FNV_PRIME);
+	for (const std::string& source : sources)
+	{
+		std::string length = std::to_string(source.size()) + ":";
+		hash_a = hashFNV1a(source, hashFNV1a(length, hash_a));
+		hash_b = hashFNV1a(source, hashFNV1a(length, hash_b));
+	}
+
+	std::stringstream key;
+	key << std::hex << std::setfill('0') << std::setw(16) << hash_a << std::setw(16) << hash_b;
+	return key.str();
+}
+
+fs::path ShaderBinaryCache::getPath(const std::string& key)
+{
+	return this->directory / (key + ".bin");
+}
+
+bool ShaderBinaryCache::load(const std::string& key, GLenum * format, std::vector<unsigned char> * binary)
+{
+	std::ifstream file(getPath(key), std::ios::binary);
+	if (!file.is_open()) return false;
+
+	char file_magic[sizeof(magic)];
+	uint32_t file_format = 0;
+	uint64_t size = 0;
+	file.read(file_magic, sizeof(file_magic));
+	file.read(reinterpret_cast<char *>(&file_format), sizeof(file_format));
+	file.read(reinterpret_cast<char *>(&size), sizeof(size));
+	if (!file || std::memcmp(file_magic, magic, sizeof(magic)) != 0) return false;
+
+	binary->resize(static_cast<size_t>(size));
+	file.read(reinterpret_cast<char *>(binary->data()), static_cast<std::streamsize>(size));
+	if (!file) return false;
+
+	*format = static_cast<GLenum>(file_format);
+	return true;
+}
+
+void ShaderBinaryCache::store(const std::string& key, GLenum format, const std::vector<unsigned char>& binary)
+{
+	// write into a temporary file first, so that an interrupted write never leaves a broken binary behind
+	fs::path path = getPath(key);
+	fs::path tmp_path = path;
+	tmp_path += ".tmp";
+	{
+		std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) return;
+
+		uint32_t file_format = static_cast<uint32_t>(format);
+		uint64_t size = static_cast<uint64_t>(binary.size());
+		file.write(magic, sizeof(magic));
+		file.write(reinterpret_cast<const char *>(&file_format), sizeof(file_format));
+		file.write(reinterpret_cast<const char *>(&size), sizeof(size));
+		file.write(reinterpret_cast<const char *>(binary.data()), static_cast<std::streamsize>(binary.size()));
+		if (!file) return;
+	}
+
+	std::error_code error;
+	fs::rename(tmp_path, path, error);
+	if (error) fs::remove(tmp_path, error);
+}
+
+void ShaderBinaryCache::storeProgram(const std::string& key, GLuint program)
+{
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0) return;
+
+	GLenum format;
+	std::vector<unsigned char> binary(static_cast<size_t>(length));
+	glGetProgramBinary(program, length, NULL, &format, binary.data());
+	store(key, format, binary);
+}
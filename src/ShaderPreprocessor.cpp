@@ -0,0 +1,81 @@
+#include <GLRF/ShaderPreprocessor.hpp>
+
+using namespace GLRF;
+
+ShaderPreprocessor::ShaderPreprocessor(std::string shader_lib)
+{
+	this->shader_lib = shader_lib;
+}
+
+std::string ShaderPreprocessor::process(const std::string& source, const std::vector<std::string>& defines)
+{
+	this->included_files.clear();
+	std::istringstream input(source);
+	std::ostringstream output;
+	if (source.find("#version") == std::string::npos && !defines.empty())
+	{
+		// sources without a version directive receive the defines at the very beginning
+		for (const std::string& define : defines) output << "#define " << define << "\n";
+		output << "#line 1 0\n";
+		processLines(input, output, 0, nullptr);
+	}
+	else
+	{
+		processLines(input, output, 0, &defines);
+	}
+	return output.str();
+}
+
+bool ShaderPreprocessor::parseInclude(const std::string& line, std::string * path)
+{
+	size_t start = line.find_first_not_of(" \t");
+	if (start == std::string::npos || line.compare(start, 8, "#include") != 0) return false;
+
+	size_t open = line.find_first_of("\"<", start + 8);
+	if (open == std::string::npos) return false;
+	char closing = (line[open] == '"') ? '"' : '>';
+	size_t close = line.find(closing, open + 1);
+	if (close == std::string::npos) return false;
+
+	*path = line.substr(open + 1, close - open - 1);
+	return true;
+}
+
+void ShaderPreprocessor::processLines(std::istream& input, std::ostringstream& output, int source_number, const std::vector<std::string> * defines)
+{
+	bool defines_pending = defines != nullptr && !defines->empty();
+	std::string line;
+	int line_number = 0;
+	while (std::getline(input, line))
+	{
+		line_number++;
+
+		std::string include_path;
+		if (parseInclude(line, &include_path))
+		{
+			std::string full_path = this->shader_lib + include_path;
+			if (this->included_files.insert(full_path).second)
+			{
+				std::ifstream file(full_path);
+				if (!file.is_open())
+				{
+					throw std::runtime_error("cannot read included shader file '" + full_path + "'");
+				}
+				int included_number = static_cast<int>(this->included_files.size());
+				output << "#line 1 " << included_number << "\n";
+				processLines(file, output, included_number, nullptr);
+				output << "#line " << line_number + 1 << " " << source_number << "\n";
+			}
+			continue;
+		}
+
+		output << line << "\n";
+
+		if (defines_pending && line.find("#version") != std::string::npos)
+		{
+			for (const std::string& define : *defines) output << "#define " << define << "\n";
+			output << "#line " << line_number + 1 << " " << source_number << "\n";
+			defines_pending = false;
+		}
+	}
+}
@@ -0,0 +1,297 @@
+#include <GLRF/SpatialHashGrid.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace GLRF;
+
+SpatialHashGrid::SpatialHashGrid(float cell_size, size_t bucket_count)
+{
+	this->cell_size = cell_size;
+	this->inverse_cell_size = 1.f / cell_size;
+	size_t count = 1;
+	while (count < bucket_count) count *= 2;
+	this->buckets.resize(count);
+}
+
+SpatialHashGrid::~SpatialHashGrid()
+{
+
+}
+
+glm::ivec3 SpatialHashGrid::getCell(const glm::vec3 & position) const
+{
+	glm::vec3 cell = glm::floor(position * this->inverse_cell_size);
+	return glm::ivec3(static_cast<int>(cell.x), static_cast<int>(cell.y), static_cast<int>(cell.z));
+}
+
+int32_t SpatialHashGrid::getBucket(const glm::ivec3 & cell) const
+{
+	// the primes of Teschner et al., the number of buckets is a power of two
+	uint32_t hash = (static_cast<uint32_t>(cell.x) * 73856093u)
+		^ (static_cast<uint32_t>(cell.y) * 19349663u)
+		^ (static_cast<uint32_t>(cell.z) * 83492791u);
+	return static_cast<int32_t>(hash & static_cast<uint32_t>(this->buckets.size() - 1));
+}
+
+bool SpatialHashGrid::fitsCell(const BoundingBox & box) const
+{
+	glm::vec3 extent = box.getExtent();
+	float limit = 0.5f * this->cell_size;
+	return extent.x <= limit && extent.y <= limit && extent.z <= limit;
+}
+
+void SpatialHashGrid::link(int32_t proxy)
+{
+	Proxy & entry = this->proxies[proxy];
+	if (fitsCell(entry.box))
+	{
+		entry.cell = getCell(entry.box.getCenter());
+		entry.bucket = getBucket(entry.cell);
+		std::vector<int32_t> & bucket = this->buckets[entry.bucket];
+		entry.slot = static_cast<uint32_t>(bucket.size());
+		bucket.push_back(proxy);
+	}
+	else
+	{
+		entry.bucket = NULL_PROXY;
+		entry.slot = static_cast<uint32_t>(this->large.size());
+		this->large.push_back(proxy);
+	}
+}
+
+void SpatialHashGrid::unlink(int32_t proxy)
+{
+	const Proxy & entry = this->proxies[proxy];
+	std::vector<int32_t> & list = entry.bucket == NULL_PROXY ? this->large : this->buckets[entry.bucket];
+	int32_t last = list.back();
+	list[entry.slot] = last;
+	this->proxies[last].slot = entry.slot;
+	list.pop_back();
+}
+
+void SpatialHashGrid::rehash(size_t bucket_count)
+{
+	for (std::vector<int32_t> & bucket : this->buckets) bucket.clear();
+	this->buckets.resize(bucket_count);
+	for (int32_t proxy = 0; proxy < static_cast<int32_t>(this->proxies.size()); proxy++)
+	{
+		Proxy & entry = this->proxies[proxy];
+		if (!entry.allocated || entry.bucket == NULL_PROXY) continue;
+		entry.bucket = getBucket(entry.cell);
+		std::vector<int32_t> & bucket = this->buckets[entry.bucket];
+		entry.slot = static_cast<uint32_t>(bucket.size());
+		bucket.push_back(proxy);
+	}
+}
+
+int32_t SpatialHashGrid::insert(const BoundingBox & box)
+{
+	int32_t proxy;
+	if (this->free_list != NULL_PROXY)
+	{
+		proxy = this->free_list;
+		this->free_list = this->proxies[proxy].next;
+	}
+	else
+	{
+		proxy = static_cast<int32_t>(this->proxies.size());
+		this->proxies.emplace_back();
+	}
+	this->proxies[proxy] = Proxy();
+	this->proxies[proxy].box = box;
+	this->proxies[proxy].allocated = true;
+	link(proxy);
+	this->proxy_count++;
+
+	// keeps the average number of boxes per bucket constant
+	if (this->proxy_count > 2 * this->buckets.size()) rehash(2 * this->buckets.size());
+	return proxy;
+}
+
+void SpatialHashGrid::remove(int32_t proxy)
+{
+	unlink(proxy);
+	Proxy & entry = this->proxies[proxy];
+	entry.allocated = false;
+	entry.next = this->free_list;
+	this->free_list = proxy;
+	this->proxy_count--;
+}
+
+bool SpatialHashGrid::update(int32_t proxy, const BoundingBox & box)
+{
+	Proxy & entry = this->proxies[proxy];
+	bool fits = fitsCell(box);
+	if (fits == (entry.bucket != NULL_PROXY) && (!fits || getCell(box.getCenter()) == entry.cell))
+	{
+		entry.box = box;
+		return false;
+	}
+	unlink(proxy);
+	entry.box = box;
+	link(proxy);
+	return true;
+}
+
+void SpatialHashGrid::clear()
+{
+	this->proxies.clear();
+	for (std::vector<int32_t> & bucket : this->buckets) bucket.clear();
+	this->large.clear();
+	this->free_list = NULL_PROXY;
+	this->proxy_count = 0;
+}
+
+const BoundingBox & SpatialHashGrid::getBox(int32_t proxy) const
+{
+	return this->proxies[proxy].box;
+}
+
+size_t SpatialHashGrid::getProxyCount() const
+{
+	return this->proxy_count;
+}
+
+size_t SpatialHashGrid::getProxyCapacity() const
+{
+	return this->proxies.size();
+}
+
+size_t SpatialHashGrid::getBucketCount() const
+{
+	return this->buckets.size();
+}
+
+size_t SpatialHashGrid::getLargeCount() const
+{
+	return this->large.size();
+}
+
+float SpatialHashGrid::getCellSize() const
+{
+	return this->cell_size;
+}
+
+template <typename Test>
+void SpatialHashGrid::query(const BoundingBox & range, bool bounded, const Test & test, std::vector<int32_t> & proxies) const
+{
+	for (int32_t proxy : this->large)
+	{
+		if (test(this->proxies[proxy].box)) proxies.push_back(proxy);
+	}
+
+	if (bounded)
+	{
+		// the boxes of a cell reach half a cell into its neighbours
+		glm::vec3 loose = glm::vec3(0.5f * this->cell_size);
+		glm::vec3 first = glm::floor((range.min - loose) * this->inverse_cell_size);
+		glm::vec3 last = glm::floor((range.max + loose) * this->inverse_cell_size);
+		double cell_count = (static_cast<double>(last.x) - first.x + 1.0)
+			* (static_cast<double>(last.y) - first.y + 1.0)
+			* (static_cast<double>(last.z) - first.z + 1.0);
+		if (cell_count <= static_cast<double>(this->buckets.size()))
+		{
+			glm::ivec3 first_cell = glm::ivec3(static_cast<int>(first.x), static_cast<int>(first.y), static_cast<int>(first.z));
+			glm::ivec3 last_cell = glm::ivec3(static_cast<int>(last.x), static_cast<int>(last.y), static_cast<int>(last.z));
+			glm::ivec3 cell;
+			for (cell.z = first_cell.z; cell.z <= last_cell.z; cell.z++)
+			{
+				for (cell.y = first_cell.y; cell.y <= last_cell.y; cell.y++)
+				{
+					for (cell.x = first_cell.x; cell.x <= last_cell.x; cell.x++)
+					{
+						const std::vector<int32_t> & bucket = this->buckets[getBucket(cell)];
+						if (bucket.empty()) continue;
+						BoundingBox cell_box;
+						cell_box.min = glm::vec3(cell) * this->cell_size - loose;
+						cell_box.max = glm::vec3(cell + glm::ivec3(1)) * this->cell_size + loose;
+						if (!test(cell_box)) continue;
+						// other cells can share the bucket
+						for (int32_t proxy : bucket)
+						{
+							const Proxy & entry = this->proxies[proxy];
+							if (entry.cell == cell && test(entry.box)) proxies.push_back(proxy);
+						}
+					}
+				}
+			}
+			return;
+		}
+	}
+
+	for (const std::vector<int32_t> & bucket : this->buckets)
+	{
+		for (int32_t proxy : bucket)
+		{
+			if (test(this->proxies[proxy].box)) proxies.push_back(proxy);
+		}
+	}
+}
+
+void SpatialHashGrid::query(const Frustum & frustum, std::vector<int32_t> & proxies) const
+{
+	BoundingBox range;
+	bool bounded = frustum.getBounds(&range);
+	query(range, bounded, [&frustum](const BoundingBox & box) { return frustum.intersects(box); }, proxies);
+}
+
+void SpatialHashGrid::query(const BoundingSphere & sphere, std::vector<int32_t> & proxies) const
+{
+	BoundingBox range;
+	range.min = sphere.center - glm::vec3(sphere.radius);
+	range.max = sphere.center + glm::vec3(sphere.radius);
+	float radius2 = sphere.radius * sphere.radius;
+	query(range, std::isfinite(sphere.radius), [&sphere, radius2](const BoundingBox & box) {
+		glm::vec3 offset = glm::clamp(sphere.center, box.min, box.max) - sphere.center;
+		return glm::dot(offset, offset) <= radius2;
+	}, proxies);
+}
+
+void SpatialHashGrid::query(const BoundingBox & box, std::vector<int32_t> & proxies) const
+{
+	query(box, true, [&box](const BoundingBox & other) {
+		return box.min.x <= other.max.x && box.min.y <= other.max.y && box.min.z <= other.max.z
+			&& other.min.x <= box.max.x && other.min.y <= box.max.y && other.min.z <= box.max.z;
+	}, proxies);
+}
+
+void SpatialHashGrid::raycast(const glm::vec3 & origin, const glm::vec3 & direction, float max_distance,
+	std::vector<int32_t> & proxies) const
+{
+	glm::vec3 end = origin + direction * max_distance;
+	BoundingBox range;
+	range.min = glm::min(origin, end);
+	range.max = glm::max(origin, end);
+	bool bounded = std::isfinite(range.min.x) && std::isfinite(range.min.y) && std::isfinite(range.min.z)
+		&& std::isfinite(range.max.x) && std::isfinite(range.max.y) && std::isfinite(range.max.z);
+
+	// slab test, divisions by zero produce infinities that compare correctly
+	glm::vec3 inverse_direction = 1.f / direction;
+	query(range, bounded, [&origin, &inverse_direction, max_distance](const BoundingBox & box) {
+		glm::vec3 t1 = (box.min - origin) * inverse_direction;
+		glm::vec3 t2 = (box.max - origin) * inverse_direction;
+		glm::vec3 t_near = glm::min(t1, t2);
+		glm::vec3 t_far = glm::max(t1, t2);
+		float enter = std::max(std::max(t_near.x, t_near.y), std::max(t_near.z, 0.f));
+		float exit = std::min(std::min(t_far.x, t_far.y), std::min(t_far.z, max_distance));
+		return enter <= exit;
+	}, proxies);
+}
+
+bool SpatialHashGrid::validate() const
+{
+	size_t count = 0;
+	for (int32_t proxy = 0; proxy < static_cast<int32_t>(this->proxies.size()); proxy++)
+	{
+		const Proxy & entry = this->proxies[proxy];
+		if (!entry.allocated) continue;
+		count++;
+		if (fitsCell(entry.box) != (entry.bucket != NULL_PROXY)) return false;
+		const std::vector<int32_t> & list = entry.bucket == NULL_PROXY ? this->large : this->buckets[entry.bucket];
+		if (entry.slot >= list.size() || list[entry.slot] != proxy) return false;
+		if (entry.bucket == NULL_PROXY) continue;
+		if (entry.cell != getCell(entry.box.getCenter()) || entry.bucket != getBucket(entry.cell)) return false;
+	}
+	return count == this->proxy_count;
+}
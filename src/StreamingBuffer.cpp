@@ -0,0 +1,114 @@
+#include <GLRF/StreamingBuffer.hpp>
+
+using namespace GLRF;
+
+StreamingBuffer::StreamingBuffer()
+{
+
+}
+
+StreamingBuffer::~StreamingBuffer()
+{
+
+}
+
+bool StreamingBuffer::isAvailable()
+{
+	return GLCapabilities::getInstance().buffer_storage;
+}
+
+void StreamingBuffer::create()
+{
+	const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	GLsizeiptr size = this->region_size * REGION_COUNT;
+	if (GLCapabilities::getInstance().direct_state_access)
+	{
+		glCreateBuffers(1, &(this->ID));
+		glNamedBufferStorage(this->ID, size, NULL, flags);
+		this->mapped = static_cast<unsigned char *>(glMapNamedBufferRange(this->ID, 0, size, flags));
+	}
+	else
+	{
+		glGenBuffers(1, &(this->ID));
+		GLStateCache::getInstance().bindBuffer(GL_COPY_WRITE_BUFFER, this->ID);
+		glBufferStorage(GL_COPY_WRITE_BUFFER, size, NULL, flags);
+		this->mapped = static_cast<unsigned char *>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags));
+	}
+
+	// the fences of the previous buffer do not guard the new one
+	for (GLsync & fence : this->fences)
+	{
+		if (fence) glDeleteSync(fence);
+		fence = 0;
+	}
+}
+
+void StreamingBuffer::beginFrame()
+{
+	this->frame++;
+	this->region_index = (this->region_index + 1) % REGION_COUNT;
+	this->cursor = 0;
+
+	GLStateCache & state = GLStateCache::getInstance();
+	for (GLuint buffer : this->retired_buffers)
+	{
+		glDeleteBuffers(1, &buffer);
+		state.deletedBuffer(buffer);
+	}
+	this->retired_buffers.clear();
+
+	GLsync & fence = this->fences[this->region_index];
+	if (!fence) return;
+
+	GLenum result = glClientWaitSync(fence, 0, 0);
+	if (result == GL_TIMEOUT_EXPIRED)
+	{
+		this->stall_count++;
+		do {
+			result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+		} while (result == GL_TIMEOUT_EXPIRED);
+	}
+	glDeleteSync(fence);
+	fence = 0;
+}
+
+void StreamingBuffer::endFrame()
+{
+	if (this->ID == 0 || this->cursor == 0) return;
+	GLsync & fence = this->fences[this->region_index];
+	if (fence) glDeleteSync(fence);
+	fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+StreamingAllocation StreamingBuffer::allocate(GLsizeiptr size, GLsizeiptr alignment)
+{
+	GLsizeiptr offset = ((this->cursor + alignment - 1) / alignment) * alignment;
+	if (this->ID == 0 || offset + size > this->region_size)
+	{
+		if (this->ID != 0)
+		{
+			this->retired_buffers.push_back(this->ID);
+			this->region_size *= 2;
+		}
+		while (this->region_size < size) this->region_size *= 2;
+		create();
+		offset = 0;
+	}
+	this->cursor = offset + size;
+
+	StreamingAllocation allocation;
+	allocation.buffer = this->ID;
+	allocation.offset = this->region_size * this->region_index + offset;
+	allocation.data = this->mapped + allocation.offset;
+	return allocation;
+}
+
+uint64_t StreamingBuffer::getFrame()
+{
+	return this->frame;
+}
+
+uint64_t StreamingBuffer::getStallCount()
+{
+	return this->stall_count;
+}
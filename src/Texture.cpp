@@ -20,15 +20,28 @@ Texture::Texture() {
 void Texture::create(std::string library, std::string relativePath) {
 	this->library = library;
 	this->relativePath = relativePath;
+	createObject();
+
+	load();
+}
+
+void Texture::createObject() {
+	if (GLCapabilities::getInstance().direct_state_access) {
+		glCreateTextures(GL_TEXTURE_2D, 1, &(this->ID));
+		glTextureParameteri(this->ID, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTextureParameteri(this->ID, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTextureParameteri(this->ID, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTextureParameteri(this->ID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		return;
+	}
+
 	glGenTextures(1, &(this->ID));
-	glBindTexture(GL_TEXTURE_2D, this->ID);
+	GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D, this->ID);
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-	load();
 }
 
 void Texture::load() {
@@ -36,7 +49,22 @@ void Texture::load() {
 	const char * fullPath = (fullPath_string).data();
 	this->data = stbi_load(fullPath, &(this->width), &(this->height), &(this->nrChannels), STBI_rgb_alpha);
 
-	if (data) {
+	if (data && GLCapabilities::getInstance().direct_state_access) {
+		if (this->storageAllocated) {
+			// immutable storage cannot be specified again, so the texture is replaced
+			glDeleteTextures(1, &(this->ID));
+			GLStateCache::getInstance().deletedTexture(this->ID);
+			createObject();
+		}
+		GLsizei levels = 1;
+		while ((std::max(this->width, this->height) >> levels) > 0) levels++;
+		glTextureStorage2D(this->ID, levels, GL_RGBA8, this->width, this->height);
+		glTextureSubImage2D(this->ID, 0, 0, 0, this->width, this->height, GL_RGBA, GL_UNSIGNED_BYTE, this->data);
+		glGenerateTextureMipmap(this->ID);
+		this->storageAllocated = true;
+		this->successfullyLoaded = true;
+	} else if (data) {
+		GLStateCache::getInstance().bindTexture(GL_TEXTURE_2D, this->ID);
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, this->width, this->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, this->data);
 		glGenerateMipmap(GL_TEXTURE_2D);
 		this->successfullyLoaded = true;
@@ -49,10 +77,13 @@ void Texture::load() {
 }
 
 void Texture::bind(GLenum textureUnit) {
-	glActiveTexture(textureUnit);
-	glBindTexture(GL_TEXTURE_2D, this->ID);
+	GLStateCache::getInstance().bindTexture(textureUnit, GL_TEXTURE_2D, this->ID);
 }
 
 bool Texture::isSuccessfullyLoaded() {
 	return this->successfullyLoaded;
 }
+
+GLuint Texture::getID() {
+	return this->ID;
+}
@@ -0,0 +1,57 @@
+#include <GLRF/UniformBuffer.hpp>
+
+using namespace GLRF;
+
+UniformBuffer::UniformBuffer(GLsizeiptr size, GLenum usage)
+{
+	this->size = size;
+	this->direct_state_access = GLCapabilities::getInstance().direct_state_access;
+	if (this->direct_state_access)
+	{
+		// the usage hint has no equivalent for immutable storage
+		glCreateBuffers(1, &(this->ID));
+		glNamedBufferStorage(this->ID, size, NULL, GL_DYNAMIC_STORAGE_BIT);
+		return;
+	}
+
+	glGenBuffers(1, &(this->ID));
+	GLStateCache::getInstance().bindBuffer(GL_UNIFORM_BUFFER, this->ID);
+	glBufferData(GL_UNIFORM_BUFFER, size, NULL, usage);
+}
+
+UniformBuffer::~UniformBuffer()
+{
+	glDeleteBuffers(1, &(this->ID));
+	GLStateCache::getInstance().deletedBuffer(this->ID);
+}
+
+void UniformBuffer::upload(const void * data, GLsizeiptr size, GLintptr offset)
+{
+	if (this->direct_state_access)
+	{
+		glNamedBufferSubData(this->ID, offset, size, data);
+		return;
+	}
+	GLStateCache::getInstance().bindBuffer(GL_UNIFORM_BUFFER, this->ID);
+	glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+}
+
+void UniformBuffer::bindBase(GLuint binding)
+{
+	GLStateCache::getInstance().bindBufferBase(GL_UNIFORM_BUFFER, binding, this->ID);
+}
+
+void UniformBuffer::bindRange(GLuint binding, GLintptr offset, GLsizeiptr size)
+{
+	GLStateCache::getInstance().bindBufferRange(GL_UNIFORM_BUFFER, binding, this->ID, offset, size);
+}
+
+GLuint UniformBuffer::getID()
+{
+	return this->ID;
+}
+
+GLsizeiptr UniformBuffer::getSize()
+{
+	return this->size;
+}
@@ -0,0 +1,42 @@
+#include <GLRF/UniformRegistry.hpp>
+
+using namespace GLRF;
+
+UniformRegistry::UniformRegistry()
+{
+
+}
+
+UniformRegistry::~UniformRegistry()
+{
+
+}
+
+UniformId UniformRegistry::intern(const std::string& name)
+{
+	auto it = this->ids.find(name);
+	if (it != this->ids.end()) return it->second;
+
+	UniformId id = static_cast<UniformId>(this->names.size());
+	this->names.push_back(name);
+	this->ids.insert_or_assign(name, id);
+	return id;
+}
+
+bool UniformRegistry::find(const std::string& name, UniformId * id) const
+{
+	auto it = this->ids.find(name);
+	if (it == this->ids.end()) return false;
+	*id = it->second;
+	return true;
+}
+
+const std::string& UniformRegistry::getName(UniformId id) const
+{
+	return this->names.at(id);
+}
+
+size_t UniformRegistry::size() const
+{
+	return this->names.size();
+}
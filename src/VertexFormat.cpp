@@ -1,4 +1,5 @@
 #include <GLRF/VertexFormat.hpp>
+#include <GLRF/InstanceBuffer.hpp>
 
 using namespace GLRF;
 
@@ -24,4 +25,72 @@ void VertexFormat::registerFormat()
 	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(VertexFormat), (void*)(6 * sizeof(GLfloat)));
 	glEnableVertexAttribArray(3);
 	glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(VertexFormat), (void*)(8 * sizeof(GLfloat)));
+}
+
+void VertexFormat::registerFormat(GLuint vertex_array, GLuint binding_index)
+{
+	glEnableVertexArrayAttrib(vertex_array, 0);
+	glVertexArrayAttribFormat(vertex_array, 0, 3, GL_FLOAT, GL_FALSE, 0);
+	glVertexArrayAttribBinding(vertex_array, 0, binding_index);
+	glEnableVertexArrayAttrib(vertex_array, 1);
+	glVertexArrayAttribFormat(vertex_array, 1, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat));
+	glVertexArrayAttribBinding(vertex_array, 1, binding_index);
+	glEnableVertexArrayAttrib(vertex_array, 2);
+	glVertexArrayAttribFormat(vertex_array, 2, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat));
+	glVertexArrayAttribBinding(vertex_array, 2, binding_index);
+	glEnableVertexArrayAttrib(vertex_array, 3);
+	glVertexArrayAttribFormat(vertex_array, 3, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat));
+	glVertexArrayAttribBinding(vertex_array, 3, binding_index);
+}
+
+void VertexFormat::registerSeparateFormat(GLuint binding_index)
+{
+	glEnableVertexAttribArray(0);
+	glVertexAttribFormat(0, 3, GL_FLOAT, GL_FALSE, 0);
+	glVertexAttribBinding(0, binding_index);
+	glEnableVertexAttribArray(1);
+	glVertexAttribFormat(1, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat));
+	glVertexAttribBinding(1, binding_index);
+	glEnableVertexAttribArray(2);
+	glVertexAttribFormat(2, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat));
+	glVertexAttribBinding(2, binding_index);
+	glEnableVertexAttribArray(3);
+	glVertexAttribFormat(3, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat));
+	glVertexAttribBinding(3, binding_index);
+}
+
+void VertexFormat::registerInstanceFormat()
+{
+	// a mat4 occupies four locations and a mat3 three, each column is read from a vec4 of the instance
+	for (GLuint column = 0; column < 7; column++)
+	{
+		GLuint location = INSTANCE_ATTRIBUTE_LOCATION + column;
+		glEnableVertexAttribArray(location);
+		glVertexAttribPointer(location, column < 4 ? 4 : 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(column * 4 * sizeof(GLfloat)));
+		glVertexAttribDivisor(location, 1);
+	}
+}
+
+void VertexFormat::registerInstanceFormat(GLuint vertex_array, GLuint binding_index)
+{
+	for (GLuint column = 0; column < 7; column++)
+	{
+		GLuint location = INSTANCE_ATTRIBUTE_LOCATION + column;
+		glEnableVertexArrayAttrib(vertex_array, location);
+		glVertexArrayAttribFormat(vertex_array, location, column < 4 ? 4 : 3, GL_FLOAT, GL_FALSE, column * 4 * sizeof(GLfloat));
+		glVertexArrayAttribBinding(vertex_array, location, binding_index);
+	}
+	glVertexArrayBindingDivisor(vertex_array, binding_index, 1);
+}
+
+void VertexFormat::registerSeparateInstanceFormat(GLuint binding_index)
+{
+	for (GLuint column = 0; column < 7; column++)
+	{
+		GLuint location = INSTANCE_ATTRIBUTE_LOCATION + column;
+		glEnableVertexAttribArray(location);
+		glVertexAttribFormat(location, column < 4 ? 4 : 3, GL_FLOAT, GL_FALSE, column * 4 * sizeof(GLfloat));
+		glVertexAttribBinding(location, binding_index);
+	}
+	glVertexBindingDivisor(binding_index, 1);
 }
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include <GLRF/WorkerPool.hpp>
+
+using namespace GLRF;
+
+WorkerPool::WorkerPool()
+{
+	// the calling thread is one of the threads of a job
+	this->thread_count = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->stopping = true;
+	}
+	this->job_available.notify_all();
+	for (std::thread & thread : this->threads) thread.join();
+}
+
+size_t WorkerPool::getThreadCount()
+{
+	return this->thread_count;
+}
+
+void WorkerPool::parallelFor(size_t count, size_t min_range_size, const std::function<void(size_t, size_t, size_t)> & job)
+{
+	if (count == 0) return;
+	size_t range_count = std::min(this->thread_count, (count + std::max<size_t>(min_range_size, 1) - 1) / std::max<size_t>(min_range_size, 1));
+	if (range_count <= 1)
+	{
+		job(0, count, 0);
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(this->mutex);
+	while (this->threads.size() + 1 < this->thread_count)
+	{
+		this->threads.emplace_back(&WorkerPool::run, this);
+	}
+	this->job = &job;
+	this->count = count;
+	this->range_count = range_count;
+	this->next_range = 0;
+	this->pending_ranges = range_count;
+	this->exception = nullptr;
+	lock.unlock();
+	this->job_available.notify_all();
+
+	lock.lock();
+	while (this->next_range < this->range_count)
+	{
+		size_t range_index = this->next_range++;
+		lock.unlock();
+		runRange(range_index);
+		lock.lock();
+		this->pending_ranges--;
+	}
+	this->job_finished.wait(lock, [this] { return this->pending_ranges == 0; });
+	this->job = nullptr;
+	this->range_count = 0;
+	this->next_range = 0;
+
+	std::exception_ptr exception = this->exception;
+	this->exception = nullptr;
+	lock.unlock();
+	if (exception) std::rethrow_exception(exception);
+}
+
+void WorkerPool::run()
+{
+	std::unique_lock<std::mutex> lock(this->mutex);
+	while (true)
+	{
+		this->job_available.wait(lock, [this] { return this->stopping || this->next_range < this->range_count; });
+		if (this->stopping) return;
+
+		// the job stays valid while a range is pending, as parallelFor waits for all of them
+		size_t range_index = this->next_range++;
+		lock.unlock();
+		runRange(range_index);
+		lock.lock();
+		if (--this->pending_ranges == 0) this->job_finished.notify_all();
+	}
+}
+
+void WorkerPool::runRange(size_t range_index)
+{
+	size_t begin = this->count * range_index / this->range_count;
+	size_t end = this->count * (range_index + 1) / this->range_count;
+	try
+	{
+		(*this->job)(begin, end, range_index);
+	}
+	catch (...)
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		if (!this->exception) this->exception = std::current_exception();
+	}
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include <iostream>
+#include <vector>
+#include <chrono>
+
+#include <GLRF/BoundingVolumeHierarchy.hpp>
+
+#include "SpatialIndexTests.hpp"
+
+using namespace GLRF;
+using namespace SpatialIndexTests;
+
+INSTANTIATE_TYPED_TEST_SUITE_P(BoundingVolumeHierarchy, SpatialIndexTest, ::testing::Types<BoundingVolumeHierarchy>);
+
+TEST (BoundingVolumeHierarchy, BuiltQueriesMatchLinearTests) {
+    std::vector<BoundingBox> boxes = createBoxes(2000, 50.f, 2.f, 2);
+    BoundingVolumeHierarchy hierarchy;
+    std::vector<int32_t> proxies;
+    hierarchy.build(boxes, &proxies);
+    ASSERT_TRUE(hierarchy.validate());
+    ASSERT_EQ(hierarchy.getProxyCount(), boxes.size());
+    expectQueriesMatchLinear(hierarchy, proxies);
+}
+
+TEST (BoundingVolumeHierarchy, SmallMovementsKeepTree) {
+    std::vector<BoundingBox> boxes = createBoxes(1000, 50.f, 2.f, 3);
+    BoundingVolumeHierarchy hierarchy(0.5f);
+    std::vector<int32_t> proxies;
+    hierarchy.build(boxes, &proxies);
+
+    // small movements stay inside of the enlarged boxes
+    BoundingBox moved = boxes[0];
+    moved.min += glm::vec3(0.25f);
+    moved.max += glm::vec3(0.25f);
+    ASSERT_FALSE(hierarchy.update(proxies[0], moved));
+    moved.min += glm::vec3(5.f);
+    moved.max += glm::vec3(5.f);
+    ASSERT_TRUE(hierarchy.update(proxies[0], moved));
+    ASSERT_TRUE(hierarchy.validate());
+}
+
+// opt-in, run with --gtest_also_run_disabled_tests
+TEST (BoundingVolumeHierarchy, DISABLED_FrustumCullingBenchmark) {
+    Frustum frustum = createFrustum(200.f);
+    for (size_t count : { 1000, 10000, 100000 }) {
+        // the density of the nodes stays constant, so the visible part of the world stays the same
+        float world_size = 50.f * std::cbrt(count / 1000.f);
+        std::vector<BoundingBox> boxes = createBoxes(count, world_size, 2.f, static_cast<unsigned int>(count));
+        BoundingVolumeHierarchy hierarchy(0.f);
+        std::vector<int32_t> proxies;
+        hierarchy.build(boxes, &proxies);
+
+        const int repetitions = 20;
+        std::vector<int32_t> visible;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repetitions; r++) {
+            visible.clear();
+            hierarchy.query(frustum, visible);
+        }
+        auto hierarchy_time = std::chrono::steady_clock::now() - start;
+
+        size_t linear_count = 0;
+        start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repetitions; r++) {
+            linear_count = 0;
+            for (const BoundingBox & box : boxes) linear_count += frustum.intersects(box) ? 1 : 0;
+        }
+        auto linear_time = std::chrono::steady_clock::now() - start;
+
+        ASSERT_EQ(visible.size(), linear_count);
+        std::cout << count << " nodes (" << linear_count << " visible, height " << hierarchy.getHeight() << "): hierarchy "
+            << std::chrono::duration<double, std::micro>(hierarchy_time).count() / repetitions << " us, linear "
+            << std::chrono::duration<double, std::micro>(linear_time).count() / repetitions << " us" << std::endl;
+    }
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+#include <iostream>
+#include <vector>
+#include <random>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <GLRF/Bounds.hpp>
+#include <GLRF/Frustum.hpp>
+#include <GLRF/VertexFormat.hpp>
+
+using namespace GLRF;
+
+namespace {
+    std::vector<VertexFormat> createVertices(size_t count, unsigned int seed) {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> distribution(-10.f, 10.f);
+        std::vector<VertexFormat> vertices;
+        for (size_t i = 0; i < count; i++) {
+            glm::vec3 position(distribution(random), distribution(random), distribution(random));
+            vertices.push_back(VertexFormat(position, glm::vec3(0.f, 1.f, 0.f), glm::vec2(0.f), glm::vec3(1.f, 0.f, 0.f)));
+        }
+        return vertices;
+    }
+}
+
+TEST (Bounds, EnclosesAllVertices) {
+    for (size_t count : { 1, 3, 4, 7, 103 }) {
+        std::vector<VertexFormat> vertices = createVertices(count, static_cast<unsigned int>(count));
+        Bounds bounds = computeBounds(vertices);
+
+        glm::vec3 min = vertices[0].position;
+        glm::vec3 max = vertices[0].position;
+        for (const VertexFormat & vertex : vertices) {
+            min = glm::min(min, vertex.position);
+            max = glm::max(max, vertex.position);
+        }
+        ASSERT_EQ(bounds.box.min, min);
+        ASSERT_EQ(bounds.box.max, max);
+
+        float max_distance = 0.f;
+        for (const VertexFormat & vertex : vertices) {
+            max_distance = std::max(max_distance, glm::length(vertex.position - bounds.sphere.center));
+        }
+        ASSERT_NEAR(bounds.sphere.radius, max_distance, 1e-4f);
+    }
+}
+
+TEST (Bounds, EmptyVerticesHaveEmptyBounds) {
+    Bounds bounds = computeBounds(std::vector<VertexFormat>());
+    ASSERT_EQ(bounds.box.min, glm::vec3(0.f));
+    ASSERT_EQ(bounds.box.max, glm::vec3(0.f));
+    ASSERT_EQ(bounds.sphere.radius, 0.f);
+}
+
+TEST (Bounds, GrowEnclosesAllPositions) {
+    std::vector<VertexFormat> vertices = createVertices(50, 7);
+    std::vector<VertexFormat> added = createVertices(20, 8);
+    for (VertexFormat & vertex : added) vertex.position *= 2.f;
+    Bounds bounds = computeBounds(vertices);
+    growBounds(&bounds, &added[0].position, added.size(), sizeof(VertexFormat));
+
+    vertices.insert(vertices.end(), added.begin(), added.end());
+    for (const VertexFormat & vertex : vertices) {
+        for (int axis = 0; axis < 3; axis++) {
+            ASSERT_LE(bounds.box.min[axis], vertex.position[axis]);
+            ASSERT_GE(bounds.box.max[axis], vertex.position[axis]);
+        }
+        ASSERT_LE(glm::length(vertex.position - bounds.sphere.center), bounds.sphere.radius + 1e-4f);
+    }
+}
+
+TEST (Bounds, GrowKeepsEnclosingBounds) {
+    std::vector<VertexFormat> vertices = createVertices(50, 9);
+    Bounds bounds = computeBounds(vertices);
+    Bounds grown = bounds;
+    growBounds(&grown, &vertices[10].position, 30, sizeof(VertexFormat));
+    ASSERT_EQ(grown.box.min, bounds.box.min);
+    ASSERT_EQ(grown.box.max, bounds.box.max);
+    ASSERT_EQ(grown.sphere.center, bounds.sphere.center);
+    ASSERT_EQ(grown.sphere.radius, bounds.sphere.radius);
+}
+
+TEST (Bounds, TransformEnclosesTransformedCorners) {
+    BoundingBox box;
+    box.min = glm::vec3(-1.f, -2.f, -3.f);
+    box.max = glm::vec3(2.f, 1.f, 0.5f);
+    glm::mat4 matrix = glm::translate(glm::mat4(1.f), glm::vec3(5.f, 0.f, -2.f))
+        * glm::rotate(glm::mat4(1.f), 0.7f, glm::normalize(glm::vec3(1.f, 2.f, 0.5f)))
+        * glm::scale(glm::mat4(1.f), glm::vec3(2.f, 1.f, 3.f));
+
+    BoundingBox world_box = box.transform(matrix);
+    BoundingSphere sphere;
+    sphere.center = box.getCenter();
+    sphere.radius = glm::length(box.getExtent());
+    BoundingSphere world_sphere = sphere.transform(matrix);
+    for (int i = 0; i < 8; i++) {
+        glm::vec3 corner((i & 1) ? box.max.x : box.min.x, (i & 2) ? box.max.y : box.min.y, (i & 4) ? box.max.z : box.min.z);
+        glm::vec3 world_corner = glm::vec3(matrix * glm::vec4(corner, 1.f));
+        for (int axis = 0; axis < 3; axis++) {
+            ASSERT_LE(world_box.min[axis], world_corner[axis] + 1e-4f);
+            ASSERT_GE(world_box.max[axis], world_corner[axis] - 1e-4f);
+        }
+        ASSERT_LE(glm::length(world_corner - world_sphere.center), world_sphere.radius + 1e-4f);
+    }
+}
+
+TEST (Frustum, CullsOutsideBounds) {
+    glm::mat4 projection = glm::perspective(glm::radians(60.f), 1.f, 0.1f, 100.f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+    Frustum frustum(projection * view);
+
+    BoundingSphere sphere;
+    sphere.radius = 1.f;
+    sphere.center = glm::vec3(0.f, 0.f, -10.f);
+    ASSERT_TRUE(frustum.intersects(sphere));
+    sphere.center = glm::vec3(0.f, 0.f, 10.f);
+    ASSERT_FALSE(frustum.intersects(sphere));
+    sphere.center = glm::vec3(0.f, 0.f, -200.f);
+    ASSERT_FALSE(frustum.intersects(sphere));
+    sphere.center = glm::vec3(50.f, 0.f, -10.f);
+    ASSERT_FALSE(frustum.intersects(sphere));
+
+    BoundingBox box;
+    box.min = glm::vec3(-1.f, -1.f, -11.f);
+    box.max = glm::vec3(1.f, 1.f, -9.f);
+    ASSERT_TRUE(frustum.intersects(box));
+    box.min = glm::vec3(-1.f, -1.f, 9.f);
+    box.max = glm::vec3(1.f, 1.f, 11.f);
+    ASSERT_FALSE(frustum.intersects(box));
+}
+
+TEST (Frustum, BoundsEncloseCorners) {
+    glm::mat4 projection = glm::perspective(glm::radians(60.f), 1.f, 0.1f, 100.f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+    Frustum frustum(projection * view);
+
+    BoundingBox box;
+    ASSERT_TRUE(frustum.getBounds(&box));
+    float half_size = 100.f * std::tan(glm::radians(30.f));
+    ASSERT_NEAR(box.min.x, -half_size, 1e-2f);
+    ASSERT_NEAR(box.max.x, half_size, 1e-2f);
+    ASSERT_NEAR(box.min.y, -half_size, 1e-2f);
+    ASSERT_NEAR(box.max.y, half_size, 1e-2f);
+    ASSERT_NEAR(box.min.z, -100.f, 1e-2f);
+    ASSERT_NEAR(box.max.z, -0.1f, 1e-3f);
+
+    // the default frustum contains everything and has no corners
+    ASSERT_FALSE(Frustum().getBounds(&box));
+}
+
+TEST (Frustum, BatchedTestMatchesSingleTests) {
+    glm::mat4 projection = glm::perspective(glm::radians(45.f), 16.f / 9.f, 0.1f, 50.f);
+    glm::mat4 view = glm::lookAt(glm::vec3(3.f, 2.f, 5.f), glm::vec3(0.f), glm::vec3(0.f, 1.f, 0.f));
+    Frustum frustum(projection * view);
+
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> position(-60.f, 60.f);
+    std::uniform_real_distribution<float> radius(0.f, 5.f);
+    std::vector<glm::vec4> spheres;
+    for (int i = 0; i < 1001; i++) {
+        spheres.push_back(glm::vec4(position(random), position(random), position(random), radius(random)));
+    }
+
+    std::vector<uint8_t> visible(spheres.size());
+    frustum.intersects(spheres.data(), spheres.size(), visible.data());
+    size_t visible_count = 0;
+    for (size_t i = 0; i < spheres.size(); i++) {
+        BoundingSphere sphere;
+        sphere.center = glm::vec3(spheres[i]);
+        sphere.radius = spheres[i].w;
+        ASSERT_EQ(visible[i] != 0, frustum.intersects(sphere));
+        visible_count += visible[i];
+    }
+    ASSERT_GT(visible_count, 0u);
+    ASSERT_LT(visible_count, spheres.size());
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
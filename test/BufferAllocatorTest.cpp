@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include <iostream>
+#include <random>
+#include <algorithm>
+
+#include <GLRF/BufferAllocator.hpp>
+
+using namespace GLRF;
+
+namespace {
+    bool overlaps(BufferAllocator & allocator, BufferAllocator::Handle a, BufferAllocator::Handle b) {
+        uint64_t a_begin = allocator.getOffset(a), a_end = a_begin + allocator.getSize(a);
+        uint64_t b_begin = allocator.getOffset(b), b_end = b_begin + allocator.getSize(b);
+        return a_begin < b_end && b_begin < a_end;
+    }
+}
+
+TEST (BufferAllocator, AllocatesDisjointRanges) {
+    BufferAllocator allocator(1000);
+    BufferAllocator::Handle a = allocator.allocate(100);
+    BufferAllocator::Handle b = allocator.allocate(3);
+    BufferAllocator::Handle c = allocator.allocate(500);
+    ASSERT_NE(a, BufferAllocator::INVALID_HANDLE);
+    ASSERT_NE(b, BufferAllocator::INVALID_HANDLE);
+    ASSERT_NE(c, BufferAllocator::INVALID_HANDLE);
+    ASSERT_EQ(allocator.getSize(a), 100u);
+    ASSERT_EQ(allocator.getSize(b), 3u);
+    ASSERT_FALSE(overlaps(allocator, a, b));
+    ASSERT_FALSE(overlaps(allocator, a, c));
+    ASSERT_FALSE(overlaps(allocator, b, c));
+    ASSERT_LE(allocator.getOffset(c) + 500, 1000u);
+
+    BufferAllocatorStatistics statistics = allocator.getStatistics();
+    ASSERT_EQ(statistics.used, 603u);
+    ASSERT_EQ(statistics.free, 397u);
+    ASSERT_EQ(statistics.allocation_count, 3u);
+}
+
+TEST (BufferAllocator, FailsWithoutSpace) {
+    BufferAllocator allocator(100);
+    ASSERT_EQ(allocator.allocate(101), BufferAllocator::INVALID_HANDLE);
+    ASSERT_EQ(allocator.allocate(0), BufferAllocator::INVALID_HANDLE);
+    BufferAllocator::Handle all = allocator.allocate(100);
+    ASSERT_NE(all, BufferAllocator::INVALID_HANDLE);
+    ASSERT_EQ(allocator.allocate(1), BufferAllocator::INVALID_HANDLE);
+    allocator.free(all);
+    ASSERT_NE(allocator.allocate(100), BufferAllocator::INVALID_HANDLE);
+}
+
+TEST (BufferAllocator, MergesFreedNeighbours) {
+    BufferAllocator allocator(300);
+    BufferAllocator::Handle a = allocator.allocate(100);
+    BufferAllocator::Handle b = allocator.allocate(100);
+    BufferAllocator::Handle c = allocator.allocate(100);
+    allocator.free(a);
+    allocator.free(c);
+    BufferAllocatorStatistics statistics = allocator.getStatistics();
+    ASSERT_EQ(statistics.free_block_count, 2u);
+    ASSERT_EQ(statistics.largest_free_block, 100u);
+    ASSERT_FLOAT_EQ(statistics.fragmentation, 0.5f);
+    ASSERT_EQ(allocator.allocate(150), BufferAllocator::INVALID_HANDLE);
+
+    allocator.free(b);
+    statistics = allocator.getStatistics();
+    ASSERT_EQ(statistics.free_block_count, 1u);
+    ASSERT_EQ(statistics.largest_free_block, 300u);
+    ASSERT_FLOAT_EQ(statistics.fragmentation, 0.f);
+    ASSERT_NE(allocator.allocate(300), BufferAllocator::INVALID_HANDLE);
+}
+
+TEST (BufferAllocator, CompactKeepsHandles) {
+    BufferAllocator allocator(1000);
+    std::vector<BufferAllocator::Handle> handles;
+    for (int i = 0; i < 10; i++) handles.push_back(allocator.allocate(50 + i));
+    for (int i = 0; i < 10; i += 2) allocator.free(handles[i]);
+
+    std::vector<uint64_t> sizes;
+    for (int i = 1; i < 10; i += 2) sizes.push_back(allocator.getSize(handles[i]));
+
+    std::vector<BufferAllocator::Move> moves = allocator.compact();
+    ASSERT_FALSE(moves.empty());
+    for (const BufferAllocator::Move & move : moves) ASSERT_LT(move.to, move.from);
+
+    uint64_t expected_offset = 0;
+    for (int i = 1, s = 0; i < 10; i += 2, s++) {
+        ASSERT_EQ(allocator.getOffset(handles[i]), expected_offset);
+        ASSERT_EQ(allocator.getSize(handles[i]), sizes[s]);
+        expected_offset += sizes[s];
+    }
+
+    BufferAllocatorStatistics statistics = allocator.getStatistics();
+    ASSERT_EQ(statistics.free_block_count, 1u);
+    ASSERT_EQ(statistics.largest_free_block, 1000u - expected_offset);
+    ASSERT_NE(allocator.allocate(1000 - expected_offset), BufferAllocator::INVALID_HANDLE);
+}
+
+TEST (BufferAllocator, RandomAllocationsStayConsistent) {
+    std::mt19937 random(7);
+    BufferAllocator allocator(1 << 20);
+    std::vector<BufferAllocator::Handle> live;
+    uint64_t used = 0;
+    for (int step = 0; step < 5000; step++) {
+        if (live.empty() || random() % 3 != 0) {
+            uint64_t size = 1 + random() % 2000;
+            BufferAllocator::Handle handle = allocator.allocate(size);
+            if (handle == BufferAllocator::INVALID_HANDLE) continue;
+            used += size;
+            live.push_back(handle);
+        } else {
+            size_t index = random() % live.size();
+            used -= allocator.getSize(live[index]);
+            allocator.free(live[index]);
+            live.erase(live.begin() + index);
+        }
+        if (step % 1000 == 999) allocator.compact();
+    }
+
+    BufferAllocatorStatistics statistics = allocator.getStatistics();
+    ASSERT_EQ(statistics.used, used);
+    ASSERT_EQ(statistics.used + statistics.free, statistics.capacity);
+    ASSERT_EQ(statistics.allocation_count, live.size());
+
+    std::sort(live.begin(), live.end(), [&](BufferAllocator::Handle a, BufferAllocator::Handle b) {
+        return allocator.getOffset(a) < allocator.getOffset(b);
+    });
+    for (size_t i = 1; i < live.size(); i++) ASSERT_FALSE(overlaps(allocator, live[i - 1], live[i]));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
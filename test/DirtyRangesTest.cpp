@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include <iostream>
+
+#include <GLRF/DirtyRanges.hpp>
+
+using namespace GLRF;
+
+TEST (DirtyRanges, KeepsDisjointRangesSorted) {
+    DirtyRanges ranges;
+    ranges.mark(50, 10);
+    ranges.mark(0, 5);
+    ranges.mark(20, 3);
+    ranges.mark(7, 0);
+
+    const std::vector<DirtyRanges::Range> & result = ranges.getRanges();
+    ASSERT_EQ(result.size(), 3u);
+    ASSERT_EQ(result[0].first, 0u);
+    ASSERT_EQ(result[1].first, 20u);
+    ASSERT_EQ(result[2].first, 50u);
+    ASSERT_EQ(ranges.getEnd(), 60u);
+    ASSERT_EQ(ranges.getCount(), 18u);
+}
+
+TEST (DirtyRanges, CoalescesOverlappingAndAdjacentRanges) {
+    DirtyRanges ranges;
+    ranges.mark(10, 5);
+    ranges.mark(15, 5);
+    ASSERT_EQ(ranges.getRanges().size(), 1u);
+    ASSERT_EQ(ranges.getRanges()[0].first, 10u);
+    ASSERT_EQ(ranges.getRanges()[0].count, 10u);
+
+    ranges.mark(30, 5);
+    ranges.mark(40, 5);
+    ranges.mark(8, 35);
+    ASSERT_EQ(ranges.getRanges().size(), 1u);
+    ASSERT_EQ(ranges.getRanges()[0].first, 8u);
+    ASSERT_EQ(ranges.getRanges()[0].count, 37u);
+
+    ranges.clear();
+    ASSERT_TRUE(ranges.empty());
+    ASSERT_EQ(ranges.getEnd(), 0u);
+}
+
+TEST (DirtyRanges, MergesRangesWithinMergeDistance) {
+    DirtyRanges ranges(4);
+    ranges.mark(0, 2);
+    ranges.mark(6, 2);
+    ranges.mark(20, 1);
+    ASSERT_EQ(ranges.getRanges().size(), 2u);
+    ASSERT_EQ(ranges.getRanges()[0].first, 0u);
+    ASSERT_EQ(ranges.getRanges()[0].count, 8u);
+    ASSERT_EQ(ranges.getRanges()[1].first, 20u);
+}
+
+TEST (DirtyRanges, MatchesBruteForce) {
+    DirtyRanges ranges;
+    std::vector<bool> expected(200, false);
+    unsigned int seed = 7;
+    for (int i = 0; i < 300; i++) {
+        seed = seed * 1103515245u + 12345u;
+        size_t first = (seed >> 8) % 190;
+        size_t count = (seed >> 20) % 8;
+        ranges.mark(first, count);
+        for (size_t j = first; j < first + count; j++) expected[j] = true;
+    }
+
+    std::vector<bool> actual(200, false);
+    size_t previous_end = 0;
+    for (const DirtyRanges::Range & range : ranges.getRanges()) {
+        ASSERT_GT(range.count, 0u);
+        if (range.first != 0) {
+            ASSERT_GT(range.first, previous_end);
+        }
+        for (size_t j = range.first; j < range.first + range.count; j++) actual[j] = true;
+        previous_end = range.first + range.count;
+    }
+    ASSERT_EQ(actual, expected);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
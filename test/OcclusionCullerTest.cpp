@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <iostream>
+#include <vector>
+#include <random>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <GLRF/OcclusionCuller.hpp>
+
+using namespace GLRF;
+
+namespace {
+    // a square wall of two triangles in the plane z = 0
+    const std::vector<glm::vec3> WALL_POSITIONS = {
+        glm::vec3(-1.f, -1.f, 0.f), glm::vec3(1.f, -1.f, 0.f), glm::vec3(1.f, 1.f, 0.f), glm::vec3(-1.f, 1.f, 0.f)
+    };
+    const std::vector<GLuint> WALL_INDICES = { 0, 1, 2, 0, 2, 3 };
+
+    OccluderGeometry createWall() {
+        OccluderGeometry geometry;
+        geometry.positions = WALL_POSITIONS.data();
+        geometry.vertex_count = WALL_POSITIONS.size();
+        geometry.indices = WALL_INDICES.data();
+        geometry.index_count = WALL_INDICES.size();
+        return geometry;
+    }
+
+    glm::mat4 createViewProjection() {
+        glm::mat4 projection = glm::perspective(glm::radians(60.f), 16.f / 9.f, 0.1f, 100.f);
+        glm::mat4 view = glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+        return projection * view;
+    }
+
+    glm::mat4 wallModel(float x, float z, float half_size) {
+        return glm::scale(glm::translate(glm::mat4(1.f), glm::vec3(x, 0.f, z)), glm::vec3(half_size));
+    }
+
+    BoundingBox createBox(glm::vec3 center, float half_size) {
+        BoundingBox box;
+        box.min = center - glm::vec3(half_size);
+        box.max = center + glm::vec3(half_size);
+        return box;
+    }
+}
+
+TEST (OcclusionCuller, WallHidesBoxesBehindIt) {
+    OcclusionCuller culler;
+    culler.beginFrame(createViewProjection());
+    culler.addOccluder(createWall(), wallModel(0.f, -10.f, 5.f));
+    culler.rasterize();
+    ASSERT_EQ(culler.getStatistics().occluder_count, 1u);
+    ASSERT_EQ(culler.getStatistics().triangle_count, 2u);
+
+    // the depth of the wall is stored in the center and nothing beside it
+    float center_depth = culler.getDepth(culler.getWidth() / 2, culler.getHeight() / 2);
+    ASSERT_LT(center_depth, 1.f);
+    ASSERT_EQ(culler.getDepth(0, culler.getHeight() / 2), 1.f);
+
+    ASSERT_FALSE(culler.isVisible(createBox(glm::vec3(0.f, 0.f, -20.f), 1.f)));
+    ASSERT_FALSE(culler.isVisible(createBox(glm::vec3(2.f, -2.f, -30.f), 2.f)));
+    ASSERT_TRUE(culler.isVisible(createBox(glm::vec3(0.f, 0.f, -5.f), 1.f)));
+    ASSERT_TRUE(culler.isVisible(createBox(glm::vec3(12.f, 0.f, -20.f), 1.f)));
+    // boxes that intersect the wall or reach past its edge are visible
+    ASSERT_TRUE(culler.isVisible(createBox(glm::vec3(0.f, 0.f, -10.f), 1.f)));
+    ASSERT_TRUE(culler.isVisible(createBox(glm::vec3(8.f, 0.f, -20.f), 1.5f)));
+    // as are boxes that cross the near plane
+    ASSERT_TRUE(culler.isVisible(createBox(glm::vec3(0.f, 0.f, 0.f), 1.f)));
+}
+
+TEST (OcclusionCuller, ClippedOccludersStayConservative) {
+    // the wall is larger than the screen and reaches behind the camera
+    OcclusionCuller culler(128, 72);
+    culler.beginFrame(createViewProjection());
+    culler.addOccluder(createWall(), glm::rotate(glm::translate(glm::mat4(1.f), glm::vec3(0.f, 0.f, -10.f)),
+        glm::radians(80.f), glm::vec3(0.f, 1.f, 0.f)) * glm::scale(glm::mat4(1.f), glm::vec3(50.f)));
+    culler.rasterize();
+    ASSERT_GT(culler.getStatistics().triangle_count, 2u);
+
+    // the wall is almost parallel to the view direction, so a box behind it at the left is hidden, in front of it not
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> coordinate(-40.f, -5.f);
+    glm::vec3 normal = glm::vec3(glm::rotate(glm::mat4(1.f), glm::radians(80.f), glm::vec3(0.f, 1.f, 0.f)) * glm::vec4(0.f, 0.f, 1.f, 0.f));
+    for (int i = 0; i < 200; i++) {
+        glm::vec3 center(coordinate(random) * 0.5f, coordinate(random) * 0.1f, coordinate(random));
+        BoundingBox box = createBox(center, 0.5f);
+        // boxes on the side of the camera must never be hidden
+        glm::vec3 camera_side = glm::vec3(0.f) - glm::vec3(0.f, 0.f, -10.f);
+        float side = glm::dot(center - glm::vec3(0.f, 0.f, -10.f), normal) * glm::dot(camera_side, normal);
+        if (side > 1.f) {
+            ASSERT_TRUE(culler.isVisible(box));
+        }
+    }
+}
+
+TEST (OcclusionCuller, BatchedTestMatchesSingleTests) {
+    OcclusionCuller culler;
+    culler.beginFrame(createViewProjection());
+    for (int i = -3; i <= 3; i++) culler.addOccluder(createWall(), wallModel(i * 6.f, -15.f - std::abs(i) * 2.f, 2.5f));
+    culler.rasterize();
+
+    std::mt19937 random(2);
+    std::uniform_real_distribution<float> x(-30.f, 30.f), y(-5.f, 5.f), z(-60.f, -2.f), size(0.1f, 2.f);
+    std::vector<BoundingBox> boxes;
+    for (int i = 0; i < 2000; i++) boxes.push_back(createBox(glm::vec3(x(random), y(random), z(random)), size(random)));
+    std::vector<uint8_t> visible(boxes.size());
+    culler.testVisibility(boxes.data(), boxes.size(), visible.data());
+
+    size_t culled = 0;
+    for (size_t i = 0; i < boxes.size(); i++) {
+        ASSERT_EQ(visible[i] != 0, culler.isVisible(boxes[i]));
+        culled += visible[i] ? 0 : 1;
+    }
+    const OcclusionCuller::Statistics & statistics = culler.getStatistics();
+    ASSERT_EQ(statistics.tested_count, boxes.size());
+    ASSERT_EQ(statistics.culled_count, culled);
+    ASSERT_GT(culled, 0u);
+
+    // a new frame starts without occluders
+    culler.beginFrame(createViewProjection());
+    culler.rasterize();
+    for (const BoundingBox & box : boxes) ASSERT_TRUE(culler.isVisible(box));
+}
+
+// opt-in, run with --gtest_also_run_disabled_tests
+TEST (OcclusionCuller, DISABLED_CullingBenchmark) {
+    OcclusionCuller culler;
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> x(-30.f, 30.f), y(-5.f, 5.f), z(-60.f, -2.f), size(0.1f, 2.f);
+    std::vector<BoundingBox> boxes;
+    for (int i = 0; i < 100000; i++) boxes.push_back(createBox(glm::vec3(x(random), y(random), z(random)), size(random)));
+    std::vector<uint8_t> visible(boxes.size());
+
+    for (int frame = 0; frame < 10; frame++) {
+        culler.beginFrame(createViewProjection());
+        for (int i = -3; i <= 3; i++) culler.addOccluder(createWall(), wallModel(i * 6.f, -15.f - std::abs(i) * 2.f, 2.5f));
+        culler.rasterize();
+        culler.testVisibility(boxes.data(), boxes.size(), visible.data());
+        const OcclusionCuller::Statistics & statistics = culler.getStatistics();
+        std::cout << statistics.occluder_count << " occluders, " << statistics.culled_count << " of " << statistics.tested_count
+            << " boxes culled: rasterize " << statistics.rasterize_milliseconds << " ms, test " << statistics.test_milliseconds
+            << " ms" << std::endl;
+    }
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
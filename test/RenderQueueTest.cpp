@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include <iostream>
+#include <algorithm>
+#include <random>
+
+#include <GLRF/RenderQueue.hpp>
+
+using namespace GLRF;
+
+TEST (RenderQueue, FramebufferDominates) {
+    uint64_t first = RenderQueue::createKey(0, true, 1023, 4095, 4095, 1000.f);
+    uint64_t second = RenderQueue::createKey(1, false, 0, 0, 0, 0.f);
+    ASSERT_LT(first, second);
+}
+
+TEST (RenderQueue, OpaqueBeforeTranslucent) {
+    uint64_t opaque = RenderQueue::createKey(0, false, 1023, 4095, 4095, 1000.f);
+    uint64_t translucent = RenderQueue::createKey(0, true, 0, 0, 0, 0.f);
+    ASSERT_LT(opaque, translucent);
+}
+
+TEST (RenderQueue, OpaqueGroupedByStateThenFrontToBack) {
+    ASSERT_LT(RenderQueue::createKey(0, false, 1, 9, 9, 100.f), RenderQueue::createKey(0, false, 2, 0, 0, 1.f));
+    ASSERT_LT(RenderQueue::createKey(0, false, 1, 1, 9, 100.f), RenderQueue::createKey(0, false, 1, 2, 0, 1.f));
+    ASSERT_LT(RenderQueue::createKey(0, false, 1, 1, 1, 1.f), RenderQueue::createKey(0, false, 1, 1, 1, 2.f));
+    ASSERT_LT(RenderQueue::createKey(0, false, 1, 1, 1, 0.f), RenderQueue::createKey(0, false, 1, 1, 1, 0.001f));
+}
+
+TEST (RenderQueue, TranslucentBackToFront) {
+    ASSERT_LT(RenderQueue::createKey(0, true, 9, 9, 9, 10.f), RenderQueue::createKey(0, true, 1, 1, 1, 5.f));
+    ASSERT_LT(RenderQueue::createKey(0, true, 1, 1, 1, 5.f), RenderQueue::createKey(0, true, 2, 1, 1, 5.f));
+}
+
+TEST (RenderQueue, SortMatchesStableSort) {
+    std::mt19937_64 random(42);
+    RenderQueue queue;
+    std::vector<RenderQueueItem> expected;
+    for (uint32_t i = 0; i < 10000; i++) {
+        // few distinct keys to check the stability
+        uint64_t key = random() % 64;
+        key = (key << 56) | (key * 0x9E3779B97F4A7Cull >> 8);
+        queue.push(key, i);
+        expected.push_back({ key, i });
+    }
+    std::stable_sort(expected.begin(), expected.end(),
+        [](const RenderQueueItem & a, const RenderQueueItem & b) { return a.key < b.key; });
+
+    queue.sort();
+    const std::vector<RenderQueueItem> & items = queue.getItems();
+    ASSERT_EQ(items.size(), expected.size());
+    for (size_t i = 0; i < items.size(); i++) {
+        ASSERT_EQ(items[i].key, expected[i].key);
+        ASSERT_EQ(items[i].index, expected[i].index);
+    }
+
+    queue.clear();
+    ASSERT_EQ(queue.size(), 0u);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
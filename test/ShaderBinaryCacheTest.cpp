@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include <iostream>
+#include <fstream>
+
+#include <GLRF/ShaderBinaryCache.hpp>
+
+using namespace GLRF;
+
+namespace {
+    fs::path createCacheDirectory(const std::string& name) {
+        fs::path directory = fs::temp_directory_path() / name;
+        fs::remove_all(directory);
+        return directory;
+    }
+}
+
+TEST (ShaderBinaryCache, KeyDependsOnSourcesAndDriver) {
+    std::vector<std::string> sources = { "vertex", "", "fragment" };
+    std::string key = ShaderBinaryCache::createKey(sources, "driver");
+    ASSERT_TRUE(key == ShaderBinaryCache::createKey(sources, "driver"));
+    ASSERT_TRUE(key != ShaderBinaryCache::createKey(sources, "updated driver"));
+    ASSERT_TRUE(key != ShaderBinaryCache::createKey({ "vertex", "", "fragment2" }, "driver"));
+    // moving text between stages must change the key
+    ASSERT_TRUE(key != ShaderBinaryCache::createKey({ "vertexfragment", "", "" }, "driver"));
+}
+
+TEST (ShaderBinaryCache, StoreAndLoad) {
+    fs::path directory = createCacheDirectory("glrf_test_shader_cache_store");
+    ShaderBinaryCache cache(directory);
+    ASSERT_TRUE(fs::is_directory(directory));
+
+    std::vector<unsigned char> binary = { 1, 2, 3, 4, 5 };
+    cache.store("program", 42, binary);
+
+    GLenum format = 0;
+    std::vector<unsigned char> loaded;
+    ASSERT_TRUE(cache.load("program", &format, &loaded));
+    ASSERT_TRUE(format == 42);
+    ASSERT_TRUE(loaded == binary);
+    ASSERT_FALSE(cache.load("missing", &format, &loaded));
+
+    fs::remove_all(directory);
+}
+
+TEST (ShaderBinaryCache, RejectsInvalidFiles) {
+    fs::path directory = createCacheDirectory("glrf_test_shader_cache_invalid");
+    ShaderBinaryCache cache(directory);
+
+    std::ofstream(directory / "garbage.bin") << "not a binary";
+    cache.store("truncated", 1, std::vector<unsigned char>(64, 7));
+    fs::resize_file(directory / "truncated.bin", 32);
+
+    GLenum format = 0;
+    std::vector<unsigned char> loaded;
+    ASSERT_FALSE(cache.load("garbage", &format, &loaded));
+    ASSERT_FALSE(cache.load("truncated", &format, &loaded));
+
+    fs::remove_all(directory);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
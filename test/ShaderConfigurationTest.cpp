@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <iostream>
+
+#include <GLRF/Shader.hpp>
+
+using namespace GLRF;
+
+TEST (UniformRegistry, Interning) {
+    UniformRegistry & registry = UniformRegistry::getInstance();
+    UniformId model = registry.intern("model");
+    UniformId view = registry.intern("view");
+    ASSERT_TRUE(model != view);
+    ASSERT_TRUE(registry.intern("model") == model);
+    ASSERT_TRUE(registry.getName(view) == "view");
+    ASSERT_TRUE(registry.size() > view);
+}
+
+TEST (ShaderConfiguration, SetAndGet) {
+    ShaderConfiguration configuration;
+    configuration.setFloat("roughness", 0.5f);
+    configuration.setVec3("camera_position", glm::vec3(1, 2, 3));
+    configuration.setMat4("model", glm::mat4(2.f));
+    configuration.setBool("useDirectionalLight", true);
+
+    ASSERT_TRUE(configuration.getFloat("roughness") == 0.5f);
+    ASSERT_TRUE(configuration.getVec3("camera_position") == glm::vec3(1, 2, 3));
+    ASSERT_TRUE(configuration.getMat4("model") == glm::mat4(2.f));
+    ASSERT_TRUE(configuration.getBool("useDirectionalLight"));
+
+    configuration.setFloat(UniformRegistry::getInstance().intern("roughness"), 0.25f);
+    ASSERT_TRUE(configuration.getFloat("roughness") == 0.25f);
+}
+
+TEST (ShaderConfiguration, Defaults) {
+    ShaderConfiguration configuration;
+    ASSERT_TRUE(configuration.getMat4("projection") == glm::mat4(1.f));
+    ASSERT_TRUE(configuration.getVec2("missing") == glm::vec2(0.f));
+    ASSERT_TRUE(configuration.getMaterial("material") == nullptr);
+
+    // values of another type are not visible
+    configuration.setInt("count", 3);
+    ASSERT_TRUE(configuration.getFloat("count") == 0.f);
+}
+
+TEST (ShaderConfiguration, TypeMismatch) {
+    ShaderConfiguration configuration;
+    configuration.setInt("count", 3);
+    ASSERT_THROW(configuration.setFloat("count", 1.f), std::invalid_argument);
+}
+
+TEST (ShaderConfiguration, Versions) {
+    ShaderConfiguration configuration;
+    UniformId roughness = UniformRegistry::getInstance().intern("roughness");
+    UniformId metallic = UniformRegistry::getInstance().intern("metallic");
+    ASSERT_EQ(configuration.getVersion(roughness), 0u);
+
+    configuration.setFloat(roughness, 0.5f);
+    uint64_t version = configuration.getVersion(roughness);
+    ASSERT_NE(version, 0u);
+
+    // an identical value keeps the version, a different value bumps it
+    configuration.setFloat(roughness, 0.5f);
+    ASSERT_EQ(configuration.getVersion(roughness), version);
+    configuration.setFloat(roughness, 0.25f);
+    ASSERT_GT(configuration.getVersion(roughness), version);
+
+    // a new entry gets a fresh version, even in another configuration
+    configuration.setFloat(metallic, 0.5f);
+    ASSERT_GT(configuration.getVersion(metallic), configuration.getVersion(roughness));
+    ShaderConfiguration other;
+    other.setFloat(roughness, 0.25f);
+    ASSERT_NE(other.getVersion(roughness), configuration.getVersion(roughness));
+}
+
+TEST (ShaderConfiguration, GettersDoNotIntern) {
+    ShaderConfiguration configuration;
+    UniformRegistry & registry = UniformRegistry::getInstance();
+    size_t size = registry.size();
+    ASSERT_TRUE(configuration.getFloat("misspelled_roughnes") == 0.f);
+    ASSERT_TRUE(configuration.getMaterial("misspelled_material") == nullptr);
+    ASSERT_EQ(registry.size(), size);
+
+    UniformId id;
+    ASSERT_FALSE(registry.find("misspelled_roughnes", &id));
+    configuration.setVec2("offset", glm::vec2(1.f, 2.f));
+    ASSERT_TRUE(registry.find("offset", &id));
+    ASSERT_TRUE(configuration.getVec2(id) == glm::vec2(1.f, 2.f));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
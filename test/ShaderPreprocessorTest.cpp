@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+
+#include <GLRF/ShaderPreprocessor.hpp>
+
+using namespace GLRF;
+
+namespace fs = std::filesystem;
+
+namespace {
+    std::string createShaderLib(const std::string& name) {
+        fs::path directory = fs::temp_directory_path() / name;
+        fs::remove_all(directory);
+        fs::create_directories(directory);
+        return directory.string() + "/";
+    }
+}
+
+TEST (ShaderPreprocessor, InjectsDefinesAfterVersion) {
+    ShaderPreprocessor preprocessor("");
+    std::string result = preprocessor.process("#version 330 core\nvoid main() {}\n", { "GLRF_ALBEDO_TEXTURE", "COUNT 4" });
+
+    std::string expected = "#version 330 core\n"
+        "#define GLRF_ALBEDO_TEXTURE\n"
+        "#define COUNT 4\n"
+        "#line 2 0\n"
+        "void main() {}\n";
+    ASSERT_EQ(result, expected);
+}
+
+TEST (ShaderPreprocessor, InjectsDefinesWithoutVersion) {
+    ShaderPreprocessor preprocessor("");
+    std::string result = preprocessor.process("void main() {}\n", { "A" });
+    ASSERT_EQ(result, "#define A\n#line 1 0\nvoid main() {}\n");
+}
+
+TEST (ShaderPreprocessor, KeepsSourceWithoutDefines) {
+    ShaderPreprocessor preprocessor("");
+    std::string source = "#version 330 core\n// comment\nvoid main() {}\n";
+    ASSERT_EQ(preprocessor.process(source, {}), source);
+}
+
+TEST (ShaderPreprocessor, ResolvesIncludesOnce) {
+    std::string lib = createShaderLib("glrf_test_shader_preprocessor_include");
+    std::ofstream(lib + "common.glsl") << "#include \"common.glsl\"\nfloat common_value() { return 1.0; }\n";
+    std::ofstream(lib + "light.glsl") << "#include <common.glsl>\nvec3 light() { return vec3(common_value()); }\n";
+
+    ShaderPreprocessor preprocessor(lib);
+    std::string result = preprocessor.process(
+        "#version 330 core\n#include \"common.glsl\"\n#include \"light.glsl\"\nvoid main() {}\n", {});
+
+    std::string expected = "#version 330 core\n"
+        "#line 1 1\n"
+        "float common_value() { return 1.0; }\n"
+        "#line 3 0\n"
+        "#line 1 2\n"
+        "vec3 light() { return vec3(common_value()); }\n"
+        "#line 4 0\n"
+        "void main() {}\n";
+    ASSERT_EQ(result, expected);
+
+    // every call resolves the includes again
+    ASSERT_EQ(preprocessor.process("#include \"common.glsl\"\n", {}), "#line 1 1\nfloat common_value() { return 1.0; }\n#line 2 0\n");
+
+    fs::remove_all(lib);
+}
+
+TEST (ShaderPreprocessor, ThrowsOnMissingInclude) {
+    std::string lib = createShaderLib("glrf_test_shader_preprocessor_missing");
+    ShaderPreprocessor preprocessor(lib);
+    ASSERT_THROW(preprocessor.process("#include \"missing.glsl\"\n", {}), std::runtime_error);
+    fs::remove_all(lib);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include <iostream>
+#include <vector>
+#include <chrono>
+
+#include <GLRF/SpatialHashGrid.hpp>
+#include <GLRF/BoundingVolumeHierarchy.hpp>
+
+#include "SpatialIndexTests.hpp"
+
+using namespace GLRF;
+using namespace SpatialIndexTests;
+
+INSTANTIATE_TYPED_TEST_SUITE_P(SpatialHashGrid, SpatialIndexTest, ::testing::Types<SpatialHashGrid>);
+
+TEST (SpatialHashGrid, LargeBoxesAndRehashing) {
+    // some boxes are larger than half a cell and are kept outside of the cells
+    std::vector<BoundingBox> boxes = createBoxes(5000, 50.f, 6.f, 1);
+    SpatialHashGrid grid(4.f, 16);
+    std::vector<int32_t> proxies;
+    for (const BoundingBox & box : boxes) proxies.push_back(grid.insert(box));
+    ASSERT_TRUE(grid.validate());
+    ASSERT_EQ(grid.getProxyCount(), boxes.size());
+    ASSERT_GT(grid.getLargeCount(), 0u);
+    ASSERT_GT(grid.getBucketCount(), 16u);
+    expectQueriesMatchLinear(grid, proxies);
+}
+
+TEST (SpatialHashGrid, UpdatesInsideOfCell) {
+    SpatialHashGrid grid(4.f);
+
+    // a box that stays in its cell only changes its stored box
+    BoundingBox small;
+    small.min = glm::vec3(0.5f);
+    small.max = glm::vec3(1.f);
+    int32_t proxy = grid.insert(small);
+    small.min += glm::vec3(0.25f);
+    small.max += glm::vec3(0.25f);
+    ASSERT_FALSE(grid.update(proxy, small));
+    ASSERT_EQ(grid.getBox(proxy).min, small.min);
+    small.min += glm::vec3(4.f);
+    small.max += glm::vec3(4.f);
+    ASSERT_TRUE(grid.update(proxy, small));
+    ASSERT_TRUE(grid.validate());
+
+    // growing beyond the size of a cell moves the box into the large list
+    small.max = small.min + glm::vec3(6.f);
+    ASSERT_TRUE(grid.update(proxy, small));
+    ASSERT_EQ(grid.getLargeCount(), 1u);
+    ASSERT_TRUE(grid.validate());
+}
+
+// opt-in, run with --gtest_also_run_disabled_tests
+TEST (SpatialHashGrid, DISABLED_MovingNodesBenchmark) {
+    Frustum frustum = createFrustum(60.f);
+    for (size_t count : { 1000, 10000, 50000 }) {
+        float world_size = 50.f * std::cbrt(count / 1000.f);
+        std::vector<BoundingBox> boxes = createBoxes(count, world_size, 2.f, static_cast<unsigned int>(count));
+        SpatialHashGrid grid(4.f);
+        BoundingVolumeHierarchy hierarchy;
+        std::vector<int32_t> grid_proxies, hierarchy_proxies;
+        for (const BoundingBox & box : boxes) {
+            grid_proxies.push_back(grid.insert(box));
+            hierarchy_proxies.push_back(hierarchy.insert(box));
+        }
+
+        // every node moves every frame, further than the margin of the hierarchy
+        const int frames = 3;
+        std::vector<int32_t> grid_visible, hierarchy_visible;
+        std::chrono::steady_clock::duration grid_time(0), hierarchy_time(0);
+        for (int frame = 1; frame <= frames; frame++) {
+            glm::vec3 translation = glm::vec3(0.3f, -0.2f, 0.25f) * static_cast<float>(frame % 2 ? 1 : -1);
+            for (BoundingBox & box : boxes) {
+                box.min += translation;
+                box.max += translation;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < count; i++) grid.update(grid_proxies[i], boxes[i]);
+            grid_visible.clear();
+            grid.query(frustum, grid_visible);
+            grid_time += std::chrono::steady_clock::now() - start;
+
+            start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < count; i++) hierarchy.update(hierarchy_proxies[i], boxes[i]);
+            hierarchy_visible.clear();
+            hierarchy.query(frustum, hierarchy_visible);
+            hierarchy_time += std::chrono::steady_clock::now() - start;
+        }
+
+        size_t linear_count = 0;
+        for (const BoundingBox & box : boxes) linear_count += frustum.intersects(box) ? 1 : 0;
+        ASSERT_EQ(grid_visible.size(), linear_count);
+        ASSERT_GE(hierarchy_visible.size(), linear_count);
+        std::cout << count << " moving nodes (" << linear_count << " visible): grid "
+            << std::chrono::duration<double, std::micro>(grid_time).count() / frames << " us, hierarchy "
+            << std::chrono::duration<double, std::micro>(hierarchy_time).count() / frames << " us per frame" << std::endl;
+    }
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
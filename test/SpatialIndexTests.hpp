@@ -0,0 +1,167 @@
+#pragma once
+#include <gtest/gtest.h>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <GLRF/SpatialIndex.hpp>
+
+/**
+ * Tests that every SpatialIndex has to pass, instantiate them for an index with
+ * INSTANTIATE_TYPED_TEST_SUITE_P(Name, SpatialIndexTest, ::testing::Types<Index>).
+ */
+namespace SpatialIndexTests {
+    using namespace GLRF;
+
+    inline std::vector<BoundingBox> createBoxes(size_t count, float world_size, float max_size, unsigned int seed) {
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<float> position(-world_size, world_size);
+        std::uniform_real_distribution<float> size(0.1f, max_size);
+        std::vector<BoundingBox> boxes(count);
+        for (BoundingBox & box : boxes) {
+            box.min = glm::vec3(position(random), position(random), position(random));
+            box.max = box.min + glm::vec3(size(random), size(random), size(random));
+        }
+        return boxes;
+    }
+
+    inline bool overlaps(const BoundingBox & a, const BoundingBox & b) {
+        return a.min.x <= b.max.x && a.min.y <= b.max.y && a.min.z <= b.max.z
+            && b.min.x <= a.max.x && b.min.y <= a.max.y && b.min.z <= a.max.z;
+    }
+
+    inline Frustum createFrustum(float far_plane) {
+        glm::mat4 projection = glm::perspective(glm::radians(60.f), 16.f / 9.f, 0.1f, far_plane);
+        glm::mat4 view = glm::lookAt(glm::vec3(10.f, 5.f, 20.f), glm::vec3(0.f), glm::vec3(0.f, 1.f, 0.f));
+        return Frustum(projection * view);
+    }
+
+    inline std::vector<int32_t> sorted(std::vector<int32_t> proxies) {
+        std::sort(proxies.begin(), proxies.end());
+        return proxies;
+    }
+
+    // the linear reference tests the stored boxes, which the index may have enlarged
+    inline void expectQueriesMatchLinear(const SpatialIndex & index, const std::vector<int32_t> & proxies) {
+        BoundingSphere sphere;
+        sphere.center = glm::vec3(3.f, -2.f, 1.f);
+        sphere.radius = 15.f;
+        BoundingBox query_box;
+        query_box.min = glm::vec3(-20.f, -5.f, -10.f);
+        query_box.max = glm::vec3(5.f, 30.f, 0.f);
+        glm::vec3 origin(-60.f, 1.f, 2.f);
+        glm::vec3 direction = glm::normalize(glm::vec3(1.f, 0.1f, -0.05f));
+
+        // a closed near frustum, a far one and the default one without bounds
+        std::vector<Frustum> frustums = { createFrustum(30.f), createFrustum(2000.f), Frustum() };
+        for (const Frustum & frustum : frustums) {
+            std::vector<int32_t> expected, result;
+            for (int32_t proxy : proxies) {
+                if (frustum.intersects(index.getBox(proxy))) expected.push_back(proxy);
+            }
+            index.query(frustum, result);
+            ASSERT_EQ(sorted(result), sorted(expected));
+        }
+
+        std::vector<int32_t> sphere_expected, box_expected, ray_expected;
+        for (int32_t proxy : proxies) {
+            const BoundingBox & box = index.getBox(proxy);
+            glm::vec3 offset = glm::clamp(sphere.center, box.min, box.max) - sphere.center;
+            if (glm::dot(offset, offset) <= sphere.radius * sphere.radius) sphere_expected.push_back(proxy);
+            if (overlaps(box, query_box)) box_expected.push_back(proxy);
+
+            glm::vec3 t1 = (box.min - origin) / direction;
+            glm::vec3 t2 = (box.max - origin) / direction;
+            glm::vec3 t_near = glm::min(t1, t2);
+            glm::vec3 t_far = glm::max(t1, t2);
+            float enter = std::max(std::max(t_near.x, t_near.y), std::max(t_near.z, 0.f));
+            float exit = std::min(std::min(t_far.x, t_far.y), std::min(t_far.z, 200.f));
+            if (enter <= exit) ray_expected.push_back(proxy);
+        }
+
+        std::vector<int32_t> result;
+        index.query(sphere, result);
+        ASSERT_EQ(sorted(result), sorted(sphere_expected));
+        result.clear();
+        index.query(query_box, result);
+        ASSERT_EQ(sorted(result), sorted(box_expected));
+        result.clear();
+        index.raycast(origin, direction, 200.f, result);
+        ASSERT_EQ(sorted(result), sorted(ray_expected));
+    }
+}
+
+template <typename Index>
+class SpatialIndexTest : public ::testing::Test {
+protected:
+    Index index;
+};
+
+TYPED_TEST_SUITE_P(SpatialIndexTest);
+
+TYPED_TEST_P(SpatialIndexTest, InsertedQueriesMatchLinearTests) {
+    using namespace SpatialIndexTests;
+    SpatialIndex & index = this->index;
+    std::vector<BoundingBox> boxes = createBoxes(3000, 50.f, 6.f, 1);
+    std::vector<int32_t> proxies;
+    for (const BoundingBox & box : boxes) proxies.push_back(index.insert(box));
+    ASSERT_TRUE(index.validate());
+    ASSERT_EQ(index.getProxyCount(), boxes.size());
+    ASSERT_GE(index.getProxyCapacity(), boxes.size());
+    expectQueriesMatchLinear(index, proxies);
+}
+
+TYPED_TEST_P(SpatialIndexTest, UpdatesAndRemovalsKeepIndexValid) {
+    using namespace SpatialIndexTests;
+    SpatialIndex & index = this->index;
+    std::vector<BoundingBox> boxes = createBoxes(2000, 50.f, 4.f, 2);
+    std::vector<int32_t> proxies;
+    for (const BoundingBox & box : boxes) proxies.push_back(index.insert(box));
+
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> offset(-10.f, 10.f);
+    std::uniform_real_distribution<float> scale(0.5f, 2.f);
+    for (size_t i = 0; i < proxies.size(); i += 2) {
+        glm::vec3 translation(offset(random), offset(random), offset(random));
+        BoundingBox box = boxes[i];
+        box.min += translation;
+        box.max = box.min + (boxes[i].max - boxes[i].min) * scale(random);
+        index.update(proxies[i], box);
+    }
+    ASSERT_TRUE(index.validate());
+
+    std::vector<int32_t> remaining;
+    for (size_t i = 0; i < proxies.size(); i++) {
+        if (i % 3 == 0) index.remove(proxies[i]);
+        else remaining.push_back(proxies[i]);
+    }
+    ASSERT_TRUE(index.validate());
+    ASSERT_EQ(index.getProxyCount(), remaining.size());
+    expectQueriesMatchLinear(index, remaining);
+
+    for (int32_t proxy : remaining) index.remove(proxy);
+    ASSERT_TRUE(index.validate());
+    ASSERT_EQ(index.getProxyCount(), 0u);
+}
+
+TYPED_TEST_P(SpatialIndexTest, ClearRemovesAllProxies) {
+    using namespace SpatialIndexTests;
+    SpatialIndex & index = this->index;
+    for (const BoundingBox & box : createBoxes(500, 50.f, 4.f, 4)) index.insert(box);
+    index.clear();
+    ASSERT_TRUE(index.validate());
+    ASSERT_EQ(index.getProxyCount(), 0u);
+    std::vector<int32_t> result;
+    index.query(Frustum(), result);
+    ASSERT_TRUE(result.empty());
+
+    std::vector<int32_t> proxies;
+    for (const BoundingBox & box : createBoxes(500, 50.f, 4.f, 5)) proxies.push_back(index.insert(box));
+    ASSERT_TRUE(index.validate());
+    expectQueriesMatchLinear(index, proxies);
+}
+
+REGISTER_TYPED_TEST_SUITE_P(SpatialIndexTest,
+    InsertedQueriesMatchLinearTests, UpdatesAndRemovalsKeepIndexValid, ClearRemovesAllProxies);
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include <iostream>
+#include <vector>
+#include <stdexcept>
+
+#include <GLRF/WorkerPool.hpp>
+
+using namespace GLRF;
+
+TEST (WorkerPool, ProcessesEveryIndexOnce) {
+    WorkerPool & pool = WorkerPool::getInstance();
+    std::vector<int> visits(10000, 0);
+    pool.parallelFor(visits.size(), 16, [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; i++) visits[i]++;
+    });
+    for (size_t i = 0; i < visits.size(); i++) {
+        ASSERT_EQ(visits[i], 1);
+    }
+}
+
+TEST (WorkerPool, RangesAreOrderedByIndex) {
+    WorkerPool & pool = WorkerPool::getInstance();
+    std::vector<std::pair<size_t, size_t>> ranges(pool.getThreadCount(), { 0, 0 });
+    for (int repetition = 0; repetition < 100; repetition++) {
+        std::fill(ranges.begin(), ranges.end(), std::pair<size_t, size_t>(0, 0));
+        pool.parallelFor(1000, 1, [&](size_t begin, size_t end, size_t range_index) {
+            ASSERT_LT(range_index, ranges.size());
+            ranges[range_index] = { begin, end };
+        });
+        size_t expected_begin = 0;
+        for (auto & range : ranges) {
+            if (range.first == range.second) continue;
+            ASSERT_EQ(range.first, expected_begin);
+            expected_begin = range.second;
+        }
+        ASSERT_EQ(expected_begin, 1000u);
+    }
+}
+
+TEST (WorkerPool, SmallJobsRunAsSingleRange) {
+    WorkerPool & pool = WorkerPool::getInstance();
+    size_t calls = 0;
+    pool.parallelFor(100, 256, [&](size_t begin, size_t end, size_t range_index) {
+        ASSERT_EQ(begin, 0u);
+        ASSERT_EQ(end, 100u);
+        ASSERT_EQ(range_index, 0u);
+        calls++;
+    });
+    ASSERT_EQ(calls, 1u);
+}
+
+TEST (WorkerPool, RethrowsExceptionOfRange) {
+    WorkerPool & pool = WorkerPool::getInstance();
+    ASSERT_THROW(pool.parallelFor(1000, 1, [&](size_t begin, size_t, size_t) {
+        if (begin == 0) throw std::runtime_error("range failed");
+    }), std::runtime_error);
+
+    // the pool can still be used afterwards
+    size_t sum = 0;
+    std::vector<size_t> sums(pool.getThreadCount(), 0);
+    pool.parallelFor(1000, 1, [&](size_t begin, size_t end, size_t range_index) {
+        for (size_t i = begin; i < end; i++) sums[range_index] += i;
+    });
+    for (size_t s : sums) sum += s;
+    ASSERT_EQ(sum, 999u * 1000u / 2u);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}